@@ -1,2 +1,3 @@
 include(FindTBB)
 find_package(TBB)
+find_package(Threads)
@@ -0,0 +1,209 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_BALANCER_HH
+#define DUNE_GRID_MULTISCALE_BALANCER_HH
+
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <dune/common/timer.hh>
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/multiscale/default.hh>
+#include <dune/grid/multiscale/factory/default.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/balance.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+//! what LoadBalancer::rebalance() did
+struct BalanceReport
+{
+  BalanceReport()
+    : measuredImbalance(1)
+    , expectedImbalance(1)
+    , achievedImbalance(-1)
+    , cutBefore(0)
+    , cutAfter(0)
+    , moves(0)
+  {
+  }
+
+  //! the imbalance of the measured costs of the decomposition before the rebalance
+  double measuredImbalance;
+  //! the imbalance the new decomposition should have, if the costs per element stay the same
+  double expectedImbalance;
+  //! the measured imbalance of the new decomposition, filled in by the next rebalance() (-1 until then)
+  double achievedImbalance;
+  double cutBefore;
+  double cutAfter;
+  //! the number of elements which changed their subdomain
+  size_t moves;
+}; // struct BalanceReport
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Rebalances a multiscale grid by the measured cost of each subdomain instead of its number of elements.
+ *
+ *          Record the time spent on each subdomain (e.g. assembly and local solves) with record() or time(), then call
+ *          rebalance(): the cost of each subdomain is distributed over its elements (in proportion to the given element
+ *          weights, e.g. the number of local DoFs, else evenly) and boundary elements are moved from expensive to
+ *          cheaper neighboring subdomains by Partitioner::rebalance_partition(). Each rebalance moves at most
+ *          maxMoveFraction of all elements, so the decomposition changes incrementally and follows changing costs
+ *          over several rebalances without reshuffling most of the local data.
+ *
+ *          The multiscale grid is then recreated from the new labeling on the same grid (with the boundary id of the
+ *          old one), ms_grid() returns the new one. The number of subdomains stays the same.
+ *  \note   The new multiscale grid is built from scratch: all local, boundary and coupling grid parts are recreated,
+ *          not only those of the subdomains which changed. A rebalance thus costs as much as creating the multiscale
+ *          grid, and data attached to the old one (e.g. colorings or geometry caches) has to be recomputed.
+ */
+template <class GridImp>
+class LoadBalancer
+{
+public:
+  typedef GridImp GridType;
+  typedef Default<GridType> MsGridType;
+
+  /**
+   *  \param  elementWeights  static cost of each element relative to the others, in the order of the walk over the
+   *                          global grid part (all 1 if empty)
+   */
+  LoadBalancer(const std::shared_ptr<const MsGridType> msGrid, const double imbalance = 0.05,
+               const double maxMoveFraction = 0.05, const size_t numOversamplingLayers = 0,
+               const std::vector<double> elementWeights = std::vector<double>())
+    : msGrid_(msGrid)
+    , imbalance_(imbalance)
+    , maxMoveFraction_(maxMoveFraction)
+    , numOversamplingLayers_(numOversamplingLayers)
+    , graph_(Partitioner::dual_graph(msGrid->globalGridPart(), elementWeights))
+    , costs_(msGrid->size(), 0.0)
+  {
+    const auto globalGridPart = msGrid_->globalGridPart();
+    labels_.reserve(graph_.size());
+    const auto itEnd = globalGridPart.template end<0>();
+    for (auto it = globalGridPart.template begin<0>(); it != itEnd; ++it)
+      labels_.push_back(msGrid_->subdomainOf(*it));
+  }
+
+  const std::shared_ptr<const MsGridType>& ms_grid() const { return msGrid_; }
+
+  //! adds seconds to the cost of subdomain, may be called concurrently
+  void record(const size_t subdomain, const double seconds)
+  {
+    if (subdomain >= costs_.size())
+      DUNE_THROW(Dune::RangeError, "there are only " << costs_.size() << " subdomains (" << subdomain << " given)!");
+    std::lock_guard<std::mutex> lock(mutex_);
+    costs_[subdomain] += seconds;
+  }
+
+  //! calls functor() and records the time it took for subdomain
+  template <class FunctorType>
+  void time(const size_t subdomain, const FunctorType& functor)
+  {
+    Timer timer;
+    functor();
+    record(subdomain, timer.elapsed());
+  }
+
+  //! a copy of the costs recorded since the last rebalance(), may be called concurrently to record()
+  std::vector<double> costs() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return costs_;
+  }
+
+  const std::vector<BalanceReport>& reports() const { return reports_; }
+
+  /**
+   *  \brief  Computes a new decomposition from the recorded costs and recreates the whole multiscale grid (if any
+   *          element moved). The recorded costs are reset.
+   */
+  BalanceReport rebalance()
+  {
+    std::vector<double> costs;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      costs.swap(costs_);
+      costs_.assign(costs.size(), 0.0);
+    }
+    const size_t numParts  = costs.size();
+    const double totalCost = std::accumulate(costs.begin(), costs.end(), 0.0);
+    if (!(totalCost > 0))
+      DUNE_THROW(Dune::InvalidStateException, "no costs were recorded since the last rebalance!");
+    BalanceReport report;
+    report.measuredImbalance = *std::max_element(costs.begin(), costs.end()) * double(numParts) / totalCost;
+    if (!reports_.empty())
+      reports_.back().achievedImbalance = report.measuredImbalance;
+    // the cost of each subdomain per static weight, subdomains without a recorded cost get the average
+    const std::vector<double> staticWeights = Partitioner::part_weights(graph_, labels_, numParts);
+    double measuredWeight = 0;
+    for (size_t ss = 0; ss < numParts; ++ss)
+      if (costs[ss] > 0)
+        measuredWeight += staticWeights[ss];
+    std::vector<double> rates(numParts, totalCost / measuredWeight);
+    for (size_t ss = 0; ss < numParts; ++ss)
+      if (costs[ss] > 0 && staticWeights[ss] > 0)
+        rates[ss] = costs[ss] / staticWeights[ss];
+    Partitioner::Graph weighted = graph_;
+    for (size_t ee = 0; ee < weighted.size(); ++ee)
+      weighted.vertexWeights[ee] *= rates[labels_[ee]];
+    const size_t maxMoves = size_t(std::ceil(maxMoveFraction_ * double(graph_.size())));
+    const auto statistics = Partitioner::rebalance_partition(weighted, labels_, numParts, imbalance_, maxMoves);
+    report.expectedImbalance = statistics.imbalanceAfter;
+    report.cutBefore         = statistics.cutBefore;
+    report.cutAfter          = statistics.cutAfter;
+    report.moves             = statistics.moves;
+    if (statistics.moves > 0)
+      apply();
+    reports_.push_back(report);
+    return report;
+  } // ... rebalance(...)
+
+private:
+  void apply()
+  {
+    Factory::Default<GridType> factory(msGrid_->grid(), msGrid_->boundaryId());
+    factory.prepare();
+    factory.add(labels_);
+    // a disconnected subdomain of the original decomposition stays disconnected
+    factory.finalize(numOversamplingLayers_, Factory::NeighborRecursionLevel<GridType>::compute(), false);
+    msGrid_ = factory.createMsGrid();
+  } // ... apply(...)
+
+  std::shared_ptr<const MsGridType> msGrid_;
+  const double imbalance_;
+  const double maxMoveFraction_;
+  const size_t numOversamplingLayers_;
+  const Partitioner::Graph graph_;
+  std::vector<size_t> labels_;
+  mutable std::mutex mutex_;
+  std::vector<double> costs_;
+  std::vector<BalanceReport> reports_;
+}; // class LoadBalancer
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class LoadBalancer
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_BALANCER_HH
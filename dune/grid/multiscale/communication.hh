@@ -0,0 +1,508 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_COMMUNICATION_HH
+#define DUNE_GRID_MULTISCALE_COMMUNICATION_HH
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/gridenums.hh>
+
+#include <dune/grid/multiscale/parallel.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace internal {
+
+//! write only message buffer, appends to a vector
+template <class DataType>
+class AppendingMessageBuffer
+{
+public:
+  explicit AppendingMessageBuffer(std::vector<DataType>& data)
+    : data_(data)
+  {
+  }
+
+  void write(const DataType& value) { data_.push_back(value); }
+
+private:
+  std::vector<DataType>& data_;
+}; // class AppendingMessageBuffer
+
+//! read only message buffer on a contiguous range
+template <class DataType>
+class ReadingMessageBuffer
+{
+public:
+  explicit ReadingMessageBuffer(const DataType* data)
+    : data_(data)
+  {
+  }
+
+  void read(DataType& value) { value = *data_++; }
+
+private:
+  const DataType* data_;
+}; // class ReadingMessageBuffer
+
+} // namespace internal
+
+/**
+ *  \brief  In-process communication between the (oversampled) local grid parts of a multiscale grid.
+ *
+ *          All local grid parts live in the same address space, so data of shared entities is copied directly between
+ *          the data handles of the subdomains (one per subdomain), in parallel across the subdomains. An entity of a
+ *          local grid part is considered interior/border, if it is contained in the local grid part without
+ *          oversampling, and overlap otherwise. The DUNE interfaces are mapped as follows:
+ *          - InteriorBorder_InteriorBorder_Interface: from interior/border to interior/border
+ *          - InteriorBorder_All_Interface: from interior/border to all
+ *          - Overlap_OverlapFront_Interface: from overlap to overlap
+ *          - Overlap_All_Interface: from overlap to all
+ *          - All_All_Interface: from all to all
+ *          BackwardCommunication reverses the direction. As in DUNE, scatter() is called once per sending subdomain.
+ *
+ *          Either all subdomains are communicated at once, with one data handle per subdomain, or each subdomain calls
+ *          communicate(subdomain, handle, ...) from its own thread (which is what communicate() of a local grid part
+ *          does), then the calls meet at a CheckedBarrier. Misuse of the latter (a subdomain not calling it, calling it
+ *          twice or with a data handle which differs in contains()) makes all calls throw instead of blocking forever.
+ *
+ *          The lists of shared entities are computed upon the first communication for a given codim and interface and
+ *          are reused afterwards.
+ */
+template <class LocalGridPartImp>
+class Communication
+{
+public:
+  typedef LocalGridPartImp LocalGridPartType;
+  typedef typename LocalGridPartType::GlobalGridPartType GlobalGridPartType;
+  typedef typename LocalGridPartType::IndexType IndexType;
+  typedef std::vector<std::shared_ptr<const LocalGridPartType>> LocalGridPartsType;
+
+  static const int dimension = LocalGridPartType::GridType::dimension;
+
+private:
+  //! all we need to know about the shared entities of one codim for one interface and direction
+  struct Plan
+  {
+    //! sends[s][ii] is true, if the entity with local index ii in subdomain s has to be gathered
+    std::vector<std::vector<char>> sends;
+    //! incoming[t][incomingOffsets[t][ii] .. incomingOffsets[t][ii + 1]] are the (subdomain, local index) pairs the
+    //! entity with local index ii in subdomain t receives data from
+    std::vector<std::vector<size_t>> incomingOffsets;
+    std::vector<std::vector<std::pair<size_t, IndexType>>> incoming;
+  }; // struct Plan
+
+  struct Occurrence
+  {
+    size_t geometryTypeIndex;
+    IndexType globalIndex;
+    size_t subdomain;
+    IndexType localIndex;
+    bool interior;
+
+    bool operator<(const Occurrence& other) const
+    {
+      return std::tie(geometryTypeIndex, globalIndex, subdomain)
+             < std::tie(other.geometryTypeIndex, other.globalIndex, other.subdomain);
+    }
+  }; // struct Occurrence
+
+  struct PlanSlot
+  {
+    std::once_flag built;
+    std::shared_ptr<const Plan> plan;
+  };
+
+  //! the gathered data of one subdomain, the data of the entity with local index ii is buffer[begins[ii] .. ends[ii]]
+  template <class DataType>
+  struct Exchange
+  {
+    std::vector<DataType> buffer;
+    std::vector<size_t> begins;
+    std::vector<size_t> ends;
+  };
+
+public:
+  /**
+   * \param localGridParts        the local grid parts without oversampling (defining interior/border)
+   * \param communicatedGridParts the grid parts to communicate on (usually the oversampled ones)
+   * \param timeout               how long a collective communicate(subdomain, ...) waits for the other subdomains
+   */
+  Communication(const std::shared_ptr<const LocalGridPartsType> localGridParts,
+                const std::shared_ptr<const LocalGridPartsType> communicatedGridParts,
+                const std::chrono::milliseconds timeout = std::chrono::seconds(60))
+    : localGridParts_(localGridParts)
+    , communicatedGridParts_(communicatedGridParts)
+    , barrier_(communicatedGridParts_->size(), timeout)
+    , published_(communicatedGridParts_->size())
+  {
+    assert(localGridParts_->size() == communicatedGridParts_->size());
+  }
+
+  size_t size() const { return communicatedGridParts_->size(); }
+
+  /**
+   *  \brief  Communicates the data of all shared entities.
+   *  \param  handles one data handle (see Dune::CommDataHandleIF) per subdomain
+   */
+  template <class DataHandleType>
+  void communicate(std::vector<DataHandleType>& handles, const InterfaceType iftype, const CommunicationDirection dir,
+                   const size_t num_threads = 0) const
+  {
+    if (handles.size() != size())
+      DUNE_THROW(Dune::InvalidStateException,
+                 "Given " << handles.size() << " data handles for " << size() << " subdomains!");
+    if (size() == 0)
+      return;
+    Codim<0, DataHandleType>::communicate(*this, handles, iftype, dir, num_threads);
+  } // ... communicate(...)
+
+  /**
+   *  \brief  Communicates the data of the shared entities of one subdomain, collectively with all other subdomains.
+   *
+   *          Has to be called for each subdomain with the same interface and direction and with data handles which
+   *          agree in contains(), each from its own thread: the calls meet at a barrier once the data of all subdomains
+   *          is gathered and once more after it is scattered. If not all subdomains arrive there within the timeout
+   *          (e.g. since they are called one after the other from one thread), or if they disagree, all calls throw a
+   *          Dune::InvalidStateException. If there is only one subdomain, nothing is collective.
+   *  \param  handle the data handle (see Dune::CommDataHandleIF) of subdomain
+   */
+  template <class DataHandleType>
+  void communicate(const size_t subdomain, DataHandleType& handle, const InterfaceType iftype,
+                   const CommunicationDirection dir) const
+  {
+    if (subdomain >= size())
+      DUNE_THROW(Dune::RangeError, "there are only " << size() << " subdomains (" << subdomain << " given)!");
+    Codim<0, DataHandleType>::communicate(*this, subdomain, handle, iftype, dir);
+  } // ... communicate(...)
+
+private:
+  template <int codim, class DataHandleType, bool end = (codim > dimension)>
+  struct Codim
+  {
+    static void communicate(const Communication& communication, std::vector<DataHandleType>& handles,
+                            const InterfaceType iftype, const CommunicationDirection dir, const size_t num_threads)
+    {
+      if (handles[0].contains(dimension, codim))
+        communication.template communicateCodim<codim>(handles, iftype, dir, num_threads);
+      Codim<codim + 1, DataHandleType>::communicate(communication, handles, iftype, dir, num_threads);
+    }
+
+    //! all subdomains meet for each codim, so that they can tell if their handles disagree in contains()
+    static void communicate(const Communication& communication, const size_t subdomain, DataHandleType& handle,
+                            const InterfaceType iftype, const CommunicationDirection dir)
+    {
+      communication.template communicateCodim<codim>(
+          subdomain, handle, iftype, dir, handle.contains(dimension, codim));
+      Codim<codim + 1, DataHandleType>::communicate(communication, subdomain, handle, iftype, dir);
+    }
+  };
+
+  template <int codim, class DataHandleType>
+  struct Codim<codim, DataHandleType, true>
+  {
+    static void communicate(const Communication& /*communication*/, std::vector<DataHandleType>& /*handles*/,
+                            const InterfaceType /*iftype*/, const CommunicationDirection /*dir*/,
+                            const size_t /*num_threads*/)
+    {
+    }
+
+    static void communicate(const Communication& /*communication*/, const size_t /*subdomain*/,
+                            DataHandleType& /*handle*/, const InterfaceType /*iftype*/,
+                            const CommunicationDirection /*dir*/)
+    {
+    }
+  };
+
+  static void participation(const InterfaceType iftype, const CommunicationDirection dir, bool& sendInterior,
+                            bool& sendOverlap, bool& receiveInterior, bool& receiveOverlap)
+  {
+    switch (iftype) {
+      case InteriorBorder_InteriorBorder_Interface:
+        sendInterior    = true;
+        sendOverlap     = false;
+        receiveInterior = true;
+        receiveOverlap  = false;
+        break;
+      case InteriorBorder_All_Interface:
+        sendInterior    = true;
+        sendOverlap     = false;
+        receiveInterior = true;
+        receiveOverlap  = true;
+        break;
+      case Overlap_OverlapFront_Interface:
+        sendInterior    = false;
+        sendOverlap     = true;
+        receiveInterior = false;
+        receiveOverlap  = true;
+        break;
+      case Overlap_All_Interface:
+        sendInterior    = false;
+        sendOverlap     = true;
+        receiveInterior = true;
+        receiveOverlap  = true;
+        break;
+      case All_All_Interface:
+        sendInterior    = true;
+        sendOverlap     = true;
+        receiveInterior = true;
+        receiveOverlap  = true;
+        break;
+      default:
+        DUNE_THROW(Dune::NotImplemented, "Unknown interface " << iftype << "!");
+    }
+    if (dir == BackwardCommunication) {
+      std::swap(sendInterior, receiveInterior);
+      std::swap(sendOverlap, receiveOverlap);
+    }
+  } // ... participation(...)
+
+  template <int codim>
+  const Plan& planFor(const InterfaceType iftype, const CommunicationDirection dir) const
+  {
+    const int key = (codim * 5 + int(iftype)) * 2 + int(dir);
+    std::shared_ptr<PlanSlot> slot;
+    {
+      std::lock_guard<std::mutex> lock(plansMutex_);
+      std::shared_ptr<PlanSlot>& entry = plans_[key];
+      if (!entry)
+        entry = std::make_shared<PlanSlot>();
+      slot = entry;
+    }
+    // the plan is built without holding the lock, only callers asking for the same plan wait for it
+    std::call_once(slot->built, [&]() { slot->plan = buildPlan<codim>(iftype, dir); });
+    return *slot->plan;
+  } // ... planFor(...)
+
+  template <int codim>
+  std::shared_ptr<const Plan> buildPlan(const InterfaceType iftype, const CommunicationDirection dir) const
+  {
+    bool sendInterior, sendOverlap, receiveInterior, receiveOverlap;
+    participation(iftype, dir, sendInterior, sendOverlap, receiveInterior, receiveOverlap);
+    const size_t numSubdomains = size();
+    // collect all entities of all subdomains
+    std::vector<Occurrence> occurrences;
+    for (size_t subdomain = 0; subdomain < numSubdomains; ++subdomain) {
+      const LocalGridPartType& gridPart      = *(*communicatedGridParts_)[subdomain];
+      const LocalGridPartType& localGridPart = *(*localGridParts_)[subdomain];
+      const auto& globalIndexSet             = gridPart.globalGridPart().indexSet();
+      const auto itEnd = gridPart.template end<codim>();
+      for (auto it = gridPart.template begin<codim>(); it != itEnd; ++it) {
+        const auto& entity = *it;
+        Occurrence occurrence;
+        occurrence.geometryTypeIndex = GlobalGeometryTypeIndex::index(entity.type());
+        occurrence.globalIndex       = globalIndexSet.index(entity);
+        occurrence.subdomain         = subdomain;
+        occurrence.localIndex        = gridPart.indexSet().index(entity);
+        occurrence.interior          = localGridPart.indexSet().contains(entity);
+        occurrences.push_back(occurrence);
+      }
+    }
+    std::sort(occurrences.begin(), occurrences.end());
+    // compute the senders and receivers of each shared entity
+    std::shared_ptr<Plan> plan = std::make_shared<Plan>();
+    plan->sends.resize(numSubdomains);
+    plan->incomingOffsets.resize(numSubdomains);
+    plan->incoming.resize(numSubdomains);
+    std::vector<std::vector<std::vector<std::pair<size_t, IndexType>>>> incoming(numSubdomains);
+    for (size_t subdomain = 0; subdomain < numSubdomains; ++subdomain) {
+      const size_t numEntities = (*communicatedGridParts_)[subdomain]->indexSet().size(codim);
+      plan->sends[subdomain].assign(numEntities, false);
+      incoming[subdomain].resize(numEntities);
+    }
+    for (size_t first = 0; first < occurrences.size();) {
+      size_t last = first + 1;
+      while (last < occurrences.size() && occurrences[last].geometryTypeIndex == occurrences[first].geometryTypeIndex
+             && occurrences[last].globalIndex == occurrences[first].globalIndex)
+        ++last;
+      for (size_t ss = first; ss < last; ++ss) {
+        const Occurrence& sender = occurrences[ss];
+        if (!(sender.interior ? sendInterior : sendOverlap))
+          continue;
+        for (size_t rr = first; rr < last; ++rr) {
+          const Occurrence& receiver = occurrences[rr];
+          if (rr == ss || !(receiver.interior ? receiveInterior : receiveOverlap))
+            continue;
+          plan->sends[sender.subdomain][sender.localIndex] = true;
+          incoming[receiver.subdomain][receiver.localIndex].push_back(
+              std::make_pair(sender.subdomain, sender.localIndex));
+        }
+      }
+      first = last;
+    }
+    // and store them compressed
+    for (size_t subdomain = 0; subdomain < numSubdomains; ++subdomain) {
+      std::vector<size_t>& offsets = plan->incomingOffsets[subdomain];
+      offsets.assign(incoming[subdomain].size() + 1, 0);
+      for (size_t ii = 0; ii < incoming[subdomain].size(); ++ii) {
+        offsets[ii + 1] = offsets[ii] + incoming[subdomain][ii].size();
+        plan->incoming[subdomain].insert(
+            plan->incoming[subdomain].end(), incoming[subdomain][ii].begin(), incoming[subdomain][ii].end());
+      }
+    }
+    return plan;
+  } // ... buildPlan(...)
+
+  template <int codim, class DataHandleType>
+  void gather(const size_t subdomain, const Plan& plan, const DataHandleType& handle,
+              Exchange<typename DataHandleType::DataType>& exchange) const
+  {
+    const LocalGridPartType& gridPart = *(*communicatedGridParts_)[subdomain];
+    const std::vector<char>& sends    = plan.sends[subdomain];
+    internal::AppendingMessageBuffer<typename DataHandleType::DataType> messageBuffer(exchange.buffer);
+    exchange.begins.assign(sends.size(), 0);
+    exchange.ends.assign(sends.size(), 0);
+    const auto itEnd = gridPart.template end<codim>();
+    for (auto it = gridPart.template begin<codim>(); it != itEnd; ++it) {
+      const auto& entity = *it;
+      const IndexType localIndex = gridPart.indexSet().index(entity);
+      if (sends[localIndex]) {
+        exchange.begins[localIndex] = exchange.buffer.size();
+        handle.gather(messageBuffer, entity);
+        exchange.ends[localIndex] = exchange.buffer.size();
+      }
+    }
+  } // ... gather(...)
+
+  //! \param exchanges the gathered data of each subdomain
+  template <int codim, class DataHandleType>
+  void scatter(const size_t subdomain, const Plan& plan, DataHandleType& handle,
+               const std::vector<const Exchange<typename DataHandleType::DataType>*>& exchanges) const
+  {
+    typedef typename DataHandleType::DataType DataType;
+    const LocalGridPartType& gridPart  = *(*communicatedGridParts_)[subdomain];
+    const std::vector<size_t>& offsets = plan.incomingOffsets[subdomain];
+    const auto& incoming               = plan.incoming[subdomain];
+    const auto itEnd = gridPart.template end<codim>();
+    for (auto it = gridPart.template begin<codim>(); it != itEnd; ++it) {
+      const auto& entity = *it;
+      const IndexType localIndex = gridPart.indexSet().index(entity);
+      for (size_t ii = offsets[localIndex]; ii < offsets[localIndex + 1]; ++ii) {
+        const size_t sender = incoming[ii].first;
+        if (!exchanges[sender])
+          DUNE_THROW(Dune::InvalidStateException, "subdomain " << sender << " failed to gather its data!");
+        const Exchange<DataType>& exchange = *exchanges[sender];
+        const IndexType senderIndex        = incoming[ii].second;
+        const size_t begin                 = exchange.begins[senderIndex];
+        const size_t count                 = exchange.ends[senderIndex] - begin;
+        internal::ReadingMessageBuffer<DataType> messageBuffer(exchange.buffer.data() + begin);
+        handle.scatter(messageBuffer, entity, count);
+      }
+    }
+  } // ... scatter(...)
+
+  template <int codim, class DataHandleType>
+  void communicateCodim(std::vector<DataHandleType>& handles, const InterfaceType iftype,
+                        const CommunicationDirection dir, const size_t num_threads) const
+  {
+    typedef Exchange<typename DataHandleType::DataType> ExchangeType;
+    const Plan& plan = this->template planFor<codim>(iftype, dir);
+    const size_t numSubdomains = size();
+    // gather the data of all sending entities
+    std::vector<ExchangeType> exchanges(numSubdomains);
+    parallel_for(0,
+                 numSubdomains,
+                 [&](const size_t subdomain) {
+                   this->template gather<codim>(subdomain, plan, handles[subdomain], exchanges[subdomain]);
+                 },
+                 num_threads);
+    // and scatter it to the receiving entities, each handle is only touched by one thread
+    std::vector<const ExchangeType*> pointers(numSubdomains);
+    for (size_t subdomain = 0; subdomain < numSubdomains; ++subdomain)
+      pointers[subdomain] = &exchanges[subdomain];
+    parallel_for(0,
+                 numSubdomains,
+                 [&](const size_t subdomain) {
+                   this->template scatter<codim>(subdomain, plan, handles[subdomain], pointers);
+                 },
+                 num_threads);
+  } // ... communicateCodim(...)
+
+  template <int codim, class DataHandleType>
+  void communicateCodim(const size_t subdomain, DataHandleType& handle, const InterfaceType iftype,
+                        const CommunicationDirection dir, const bool participates) const
+  {
+    typedef Exchange<typename DataHandleType::DataType> ExchangeType;
+    if (size() == 1) {
+      if (participates) {
+        const Plan& plan = this->template planFor<codim>(iftype, dir);
+        ExchangeType exchange;
+        this->template gather<codim>(subdomain, plan, handle, exchange);
+        this->template scatter<codim>(subdomain, plan, handle, std::vector<const ExchangeType*>(1, &exchange));
+      }
+      return;
+    }
+    // each subdomain publishes its gathered data and reaches the barriers even if it fails, so that the others do not
+    // wait for it
+    const long key = ((long(codim) * 5 + long(iftype)) * 2 + long(dir)) * 2 + (participates ? 1 : 0);
+    const Plan* plan = nullptr;
+    std::shared_ptr<ExchangeType> exchange;
+    std::exception_ptr exception;
+    if (participates) {
+      try {
+        plan     = &this->template planFor<codim>(iftype, dir);
+        exchange = std::make_shared<ExchangeType>();
+        this->template gather<codim>(subdomain, *plan, handle, *exchange);
+      } catch (...) {
+        exception = std::current_exception();
+        exchange.reset();
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(publishedMutex_);
+      published_[subdomain] = exchange;
+    }
+    // throws in all subdomains if they disagree in the key, i.e. in participates
+    barrier_.arrive(subdomain, key);
+    if (!participates)
+      return;
+    if (!exception) {
+      try {
+        std::vector<std::shared_ptr<const void>> published;
+        {
+          std::lock_guard<std::mutex> lock(publishedMutex_);
+          published = published_;
+        }
+        std::vector<const ExchangeType*> exchanges(size());
+        for (size_t ss = 0; ss < size(); ++ss)
+          exchanges[ss] = static_cast<const ExchangeType*>(published[ss].get());
+        this->template scatter<codim>(subdomain, *plan, handle, exchanges);
+      } catch (...) {
+        exception = std::current_exception();
+      }
+    }
+    barrier_.arrive(subdomain, key);
+    if (exception)
+      std::rethrow_exception(exception);
+  } // ... communicateCodim(...)
+
+  const std::shared_ptr<const LocalGridPartsType> localGridParts_;
+  const std::shared_ptr<const LocalGridPartsType> communicatedGridParts_;
+  mutable std::mutex plansMutex_;
+  mutable std::map<int, std::shared_ptr<PlanSlot>> plans_;
+  mutable CheckedBarrier barrier_;
+  //! the Exchange of each subdomain during a collective communicate(subdomain, ...)
+  mutable std::mutex publishedMutex_;
+  mutable std::vector<std::shared_ptr<const void>> published_;
+}; // class Communication
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_COMMUNICATION_HH
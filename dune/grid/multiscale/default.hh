@@ -9,7 +9,10 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <mutex>
 #include <memory>
+#include <typeinfo>
+#include <typeindex>
 
 #include <dune/common/exceptions.hh>
 
@@ -22,7 +25,12 @@
 #include <dune/stuff/common/color.hh>
 #include <dune/stuff/common/type_utils.hh>
 
+#include <dune/grid/part/storage.hh>
 #include <dune/grid/part/local/indexbased.hh>
+#include <dune/grid/multiscale/facetable.hh>
+#include <dune/grid/multiscale/communication.hh>
+#include <dune/grid/multiscale/sparsity.hh>
+#include <dune/grid/multiscale/parallel.hh>
 
 namespace Dune {
 namespace grid {
@@ -80,8 +88,101 @@ public:
 
   typedef std::set<size_t> NeighborSetType;
 
-  //! map type which maps from an entity index (of the global grid parts index set) to a subdomain
-  typedef std::map<IndexType, size_t> EntityToSubdomainMapType;
+  //! map type which maps from an entity index (of the global grid parts index set) to a subdomain, see Part::Storage
+  typedef std::map<typename Part::Storage::Index<IndexType>::type, Part::Storage::SubdomainType>
+      EntityToSubdomainMapType;
+
+  typedef FaceTable<GlobalGridPartType> FaceTableType;
+
+  typedef Communication<LocalGridPartType> CommunicationType;
+
+  class CouplingHandle;
+
+  /**
+   *  \brief Lightweight handle to one subdomain of a multiscale grid.
+   *
+   *         Consists of a pointer to the multiscale grid and the subdomain index only (and is thus trivially copyable),
+   *         all grid parts are returned by reference without touching any reference count. Handles are only valid as
+   *         long as the multiscale grid they were obtained from exists.
+   */
+  class SubdomainHandle
+  {
+  public:
+    //! creates an invalid handle (see valid()), which may only be assigned to or copied
+    SubdomainHandle()
+      : msGrid_(nullptr)
+      , subdomain_(0)
+    {
+    }
+
+    SubdomainHandle(const ThisType& msGrid, const size_t subdomain)
+      : msGrid_(&msGrid)
+      , subdomain_(subdomain)
+    {
+      assert(subdomain_ < msGrid_->size());
+    }
+
+    //! false, if this handle was default constructed
+    bool valid() const { return msGrid_ != nullptr; }
+
+    size_t index() const { return subdomain_; }
+
+    const LocalGridPartType& localGridPart(const bool oversampling = false) const
+    {
+      return msGrid_->localGridPartReference(subdomain_, oversampling);
+    }
+
+    bool boundary() const { return msGrid_->boundary(subdomain_); }
+
+    const BoundaryGridPartType& boundaryGridPart() const { return msGrid_->boundaryGridPartReference(subdomain_); }
+
+    const NeighborSetType& neighbors() const { return msGrid_->neighborsOf(subdomain_); }
+
+    CouplingHandle coupling(const size_t neighbor) const { return CouplingHandle(*msGrid_, subdomain_, neighbor); }
+
+  private:
+    const ThisType* msGrid_;
+    size_t subdomain_;
+  }; // class SubdomainHandle
+
+  //! lightweight handle to the coupling of two subdomains, see SubdomainHandle
+  class CouplingHandle
+  {
+  public:
+    //! creates an invalid handle (see valid()), which may only be assigned to or copied
+    CouplingHandle()
+      : msGrid_(nullptr)
+      , subdomain_(0)
+      , neighbor_(0)
+    {
+    }
+
+    CouplingHandle(const ThisType& msGrid, const size_t subdomain, const size_t neighbor)
+      : msGrid_(&msGrid)
+      , subdomain_(subdomain)
+      , neighbor_(neighbor)
+    {
+      assert(subdomain_ < msGrid_->size());
+      assert(neighbor_ < msGrid_->size());
+    }
+
+    //! false, if this handle was default constructed
+    bool valid() const { return msGrid_ != nullptr; }
+
+    SubdomainHandle inside() const { return SubdomainHandle(*msGrid_, subdomain_); }
+
+    SubdomainHandle outside() const { return SubdomainHandle(*msGrid_, neighbor_); }
+
+    const CouplingGridPartType& couplingGridPart() const
+    {
+      return msGrid_->couplingGridPartReference(subdomain_, neighbor_);
+    }
+
+  private:
+    const ThisType* msGrid_;
+    size_t subdomain_;
+    size_t neighbor_;
+  }; // class CouplingHandle
 
   static const std::string id() { return "grid.multiscale.default"; }
 
@@ -91,7 +192,9 @@ public:
           const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>> localGridParts,
           const std::shared_ptr<const std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>> boundaryGridParts,
           const std::shared_ptr<const std::vector<std::map<size_t, std::shared_ptr<const CouplingGridPartType>>>>
-              couplingGridPartsMaps)
+              couplingGridPartsMaps,
+          const std::shared_ptr<const FaceTableType> faceTable = std::shared_ptr<const FaceTableType>(),
+          const int boundaryId = 7)
     : grid_(grid)
     , globalGridPart_(globalGridPart)
     , size_(size)
@@ -101,6 +204,11 @@ public:
     , boundaryGridParts_(boundaryGridParts)
     , couplingGridPartsMaps_(couplingGridPartsMaps)
     , oversampling_(false)
+    , faceTable_(faceTable)
+    , boundaryId_(boundaryId)
+    , communication_(std::make_shared<CommunicationType>(localGridParts_, localGridParts_))
+    , communicatingGridParts_(communicating(localGridParts_, communication_))
+    , attachments_(std::make_shared<Attachments>())
     , localGridViews_(new std::vector<std::shared_ptr<const LocalGridViewType>>(size_))
     , boundaryGridViews_(new std::map<size_t, std::shared_ptr<const BoundaryGridViewType>>())
     , couplingGridViewsMaps_(new std::vector<std::map<size_t, std::shared_ptr<const CouplingGridViewType>>>(
@@ -133,7 +241,9 @@ public:
           const std::shared_ptr<const std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>> boundaryGridParts,
           const std::shared_ptr<const std::vector<std::map<size_t, std::shared_ptr<const CouplingGridPartType>>>>
               couplingGridPartsMaps,
-          const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>> oversampledLocalGridParts)
+          const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>> oversampledLocalGridParts,
+          const std::shared_ptr<const FaceTableType> faceTable = std::shared_ptr<const FaceTableType>(),
+          const int boundaryId = 7)
     : grid_(grid)
     , globalGridPart_(globalGridPart)
     , size_(size)
@@ -144,6 +254,11 @@ public:
     , couplingGridPartsMaps_(couplingGridPartsMaps)
     , oversampling_(true)
     , oversampledLocalGridParts_(oversampledLocalGridParts)
+    , faceTable_(faceTable)
+    , boundaryId_(boundaryId)
+    , communication_(std::make_shared<CommunicationType>(localGridParts_, oversampledLocalGridParts_))
+    , communicatingGridParts_(communicating(oversampledLocalGridParts_, communication_))
+    , attachments_(std::make_shared<Attachments>())
     , localGridViews_(new std::vector<std::shared_ptr<const LocalGridViewType>>(size_))
     , boundaryGridViews_(new std::map<size_t, std::shared_ptr<const BoundaryGridViewType>>())
     , couplingGridViewsMaps_(new std::vector<std::map<size_t, std::shared_ptr<const CouplingGridViewType>>>(
@@ -181,24 +296,24 @@ public:
 
   size_t size() const { return size_; }
 
+  //! \sa SubdomainHandle
+  SubdomainHandle subdomain(const size_t subdomain) const { return SubdomainHandle(*this, subdomain); }
+
+  //! \sa CouplingHandle
+  CouplingHandle coupling(const size_t subdomain, const size_t neighbor) const
+  {
+    return CouplingHandle(*this, subdomain, neighbor);
+  }
+
   bool oversampling() const { return oversampling_; }
 
+  //! the boundary id of those intersections of the local grid parts which lie on subdomain interfaces
+  int boundaryId() const { return boundaryId_; }
+
   LocalGridPartType localGridPart(const size_t subdomain, const bool oversampling = false) const
   {
-    assert(subdomain < size_);
-    if (!oversampling) {
-      const std::vector<std::shared_ptr<const LocalGridPartType>>& localGridParts = *localGridParts_;
-      return *(localGridParts[subdomain]);
-    } else {
-      if (!oversampling_)
-        DUNE_THROW(Dune::InvalidStateException,
-                   "\n" << Dune::Stuff::Common::colorStringRed("ERROR:")
-                        << " oversampled local gridpart requested from a grid without oversampling!");
-      const std::vector<std::shared_ptr<const LocalGridPartType>>& oversampledLocalGridParts =
-          *oversampledLocalGridParts_;
-      return *(oversampledLocalGridParts[subdomain]);
-    }
-  } // ... localGridPart(...)
+    return localGridPartReference(subdomain, oversampling);
+  }
 
   LocalGridViewType localGridView(const size_t subdomain) const
   {
@@ -215,16 +330,7 @@ public:
     return (boundaryGridParts.find(subdomain) != boundaryGridParts.end());
   }
 
-  BoundaryGridPartType boundaryGridPart(const size_t subdomain) const
-  {
-    assert(subdomain < size_);
-    const std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>& boundaryGridParts = *boundaryGridParts_;
-    typename std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>::const_iterator result =
-        boundaryGridParts.find(subdomain);
-    assert(result != boundaryGridParts.end()
-           && "Only call boundaryGridPart(subdomain), if boundary(subdomain) is true!");
-    return *(result->second);
-  }
+  BoundaryGridPartType boundaryGridPart(const size_t subdomain) const { return boundaryGridPartReference(subdomain); }
 
   BoundaryGridViewType boundaryGridView(const size_t subdomain) const
   {
@@ -240,23 +346,8 @@ public:
 
   CouplingGridPartType couplingGridPart(const size_t subdomain, const size_t neighbor) const
   {
-    assert(subdomain < size_);
-    assert(neighbor < size_);
-    const std::vector<std::map<size_t, std::shared_ptr<const CouplingGridPartType>>>& couplingGridPartsMaps =
-        *couplingGridPartsMaps_;
-    const std::map<size_t, std::shared_ptr<const CouplingGridPartType>>& couplingGridPartsMap =
-        couplingGridPartsMaps[subdomain];
-    const typename std::map<size_t, std::shared_ptr<const CouplingGridPartType>>::const_iterator result =
-        couplingGridPartsMap.find(neighbor);
-    if (result == couplingGridPartsMap.end()) {
-      std::stringstream msg;
-      msg << "Error in " << id() << ": subdomain " << neighbor << " is not a neighbor of subdomain " << subdomain
-          << "!";
-      DUNE_THROW(Dune::InvalidStateException, msg.str());
-    }
-    return *(result->second);
-  } // const std::shared_ptr< const CouplingGridPartType > couplingGridPart(const size_t subdomain, const size_t
-  // neighbor) const
+    return couplingGridPartReference(subdomain, neighbor);
+  }
 
   CouplingGridViewType couplingGridView(const size_t subdomain, const size_t neighbor) const
   {
@@ -304,7 +395,194 @@ public:
     return subdomainOf(globalGridPart_->indexSet().index(entity));
   } // size_t subdomainOf(const EntityType& entity) const
 
+  /**
+   *  \brief Exchanges data of shared entities between the local grid parts (the oversampled ones, if oversampling() is
+   *         true), in parallel and without MPI, see Communication for the meaning of the interfaces. Alternatively, the
+   *         local grid parts communicate collectively, one thread per subdomain (see LocalGridPartType::communicate()).
+   *  \param handles one data handle (see Dune::CommDataHandleIF) per subdomain
+   */
+  template <class DataHandleType>
+  void communicate(std::vector<DataHandleType>& handles, const InterfaceType iftype, const CommunicationDirection dir,
+                   const size_t num_threads = 0) const
+  {
+    communication_->communicate(handles, iftype, dir, num_threads);
+  }
+
+  /**
+   *  \brief Computes the sparsity patterns of all local operators (see local_sparsity_pattern()), in parallel across
+   *         the subdomains.
+   */
+  std::vector<SparsityPattern> localSparsityPatterns(const DofLayout& layout, const bool oversampling = false,
+                                                     const size_t num_threads = 0) const
+  {
+    std::vector<SparsityPattern> patterns(size_);
+    parallel_for(0,
+                 size_,
+                 [&](const size_t subdomain) {
+                   patterns[subdomain] =
+                       local_sparsity_pattern(localGridPartReference(subdomain, oversampling), layout);
+                 },
+                 num_threads);
+    return patterns;
+  } // ... localSparsityPatterns(...)
+
+  /**
+   *  \brief Computes the sparsity patterns of all coupling operators (see coupling_sparsity_pattern()), in parallel
+   *         across the subdomains. The pattern of the coupling of subdomain ss with neighbor nn is result[ss][nn].
+   */
+  std::vector<std::map<size_t, SparsityPattern>> couplingSparsityPatterns(const DofLayout& layout,
+                                                                          const size_t num_threads = 0) const
+  {
+    std::vector<std::map<size_t, SparsityPattern>> patterns(size_);
+    parallel_for(0,
+                 size_,
+                 [&](const size_t subdomain) {
+                   for (const size_t neighbor : neighborsOf(subdomain))
+                     patterns[subdomain][neighbor] =
+                         coupling_sparsity_pattern(couplingGridPartReference(subdomain, neighbor), layout);
+                 },
+                 num_threads);
+    return patterns;
+  } // ... couplingSparsityPatterns(...)
+
+  /**
+   *  \brief Computes the sparsity patterns of all boundary operators (see boundary_sparsity_pattern()), in parallel
+   *         across the subdomains. Only subdomains with boundary(subdomain) have an entry. Uses the face table if there
+   *         is one, the boundary grid parts otherwise.
+   */
+  std::map<size_t, SparsityPattern> boundarySparsityPatterns(const DofLayout& layout,
+                                                             const size_t num_threads = 0) const
+  {
+    std::map<size_t, SparsityPattern> patterns;
+    std::vector<SparsityPattern*> targets(size_, nullptr);
+    for (size_t subdomain = 0; subdomain < size_; ++subdomain)
+      if (boundary(subdomain))
+        targets[subdomain] = &patterns[subdomain];
+    parallel_for(0,
+                 size_,
+                 [&](const size_t subdomain) {
+                   if (!targets[subdomain])
+                     return;
+                   if (faceTable_)
+                     *targets[subdomain] =
+                         boundary_sparsity_pattern(localGridPartReference(subdomain, false), *faceTable_, layout);
+                   else
+                     *targets[subdomain] = boundary_sparsity_pattern(boundaryGridPartReference(subdomain), layout);
+                 },
+                 num_threads);
+    return patterns;
+  } // ... boundarySparsityPatterns(...)
+
+  bool hasFaceTable() const { return faceTable_ != nullptr; }
+
+  //! classification of all faces of the global grid part, see FaceTable
+  const FaceTableType& faceTable() const
+  {
+    if (!faceTable_)
+      DUNE_THROW(Dune::InvalidStateException,
+                 "\n" << Dune::Stuff::Common::colorStringRed("ERROR:")
+                      << " face table requested from a grid which was created without one!");
+    return *faceTable_;
+  }
+
+  /**
+   *  \brief Returns the object of type T attached to this multiscale grid, which is created by builder() (returning a
+   *         std::shared_ptr< T >) upon the first call (thread safe) and shared by all copies of this grid.
+   *
+   *         Used to keep data derived from the whole decomposition (as the element data of Partitioner::quality())
+   *         next to the grid, instead of recomputing it on each call.
+   */
+  template <class T, class BuilderType>
+  const T& attached(const BuilderType& builder) const
+  {
+    std::shared_ptr<AttachedSlot> slot;
+    {
+      std::lock_guard<std::mutex> lock(attachments_->mutex);
+      std::shared_ptr<AttachedSlot>& entry = attachments_->slots[std::type_index(typeid(T))];
+      if (!entry)
+        entry = std::make_shared<AttachedSlot>();
+      slot = entry;
+    }
+    std::call_once(slot->built, [&]() {
+      const std::shared_ptr<const T> object = builder();
+      slot->object = object;
+    });
+    return *static_cast<const T*>(slot->object.get());
+  } // ... attached(...)
+
 private:
+  struct AttachedSlot
+  {
+    std::once_flag built;
+    std::shared_ptr<const void> object;
+  };
+
+  struct Attachments
+  {
+    std::mutex mutex;
+    std::map<std::type_index, std::shared_ptr<AttachedSlot>> slots;
+  };
+
+  //! copies of gridParts which can communicate (see LocalGridPartType::communicate()), sharing all their data
+  static std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>>
+  communicating(const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>>& gridParts,
+                const std::shared_ptr<const CommunicationType>& communication)
+  {
+    auto result = std::make_shared<std::vector<std::shared_ptr<const LocalGridPartType>>>(gridParts->size());
+    for (size_t subdomain = 0; subdomain < gridParts->size(); ++subdomain)
+      (*result)[subdomain] =
+          std::make_shared<const LocalGridPartType>(*(*gridParts)[subdomain], subdomain, communication);
+    return result;
+  } // ... communicating(...)
+
+  const LocalGridPartType& localGridPartReference(const size_t subdomain, const bool oversampling) const
+  {
+    assert(subdomain < size_);
+    if (!oversampling) {
+      // without oversampling the local grid parts are the ones which communicate
+      const std::vector<std::shared_ptr<const LocalGridPartType>>& localGridParts =
+          oversampling_ ? *localGridParts_ : *communicatingGridParts_;
+      return *(localGridParts[subdomain]);
+    } else {
+      if (!oversampling_)
+        DUNE_THROW(Dune::InvalidStateException,
+                   "\n" << Dune::Stuff::Common::colorStringRed("ERROR:")
+                        << " oversampled local gridpart requested from a grid without oversampling!");
+      const std::vector<std::shared_ptr<const LocalGridPartType>>& oversampledLocalGridParts = *communicatingGridParts_;
+      return *(oversampledLocalGridParts[subdomain]);
+    }
+  } // ... localGridPartReference(...)
+
+  const BoundaryGridPartType& boundaryGridPartReference(const size_t subdomain) const
+  {
+    assert(subdomain < size_);
+    const std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>& boundaryGridParts = *boundaryGridParts_;
+    typename std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>::const_iterator result =
+        boundaryGridParts.find(subdomain);
+    assert(result != boundaryGridParts.end()
+           && "Only call boundaryGridPart(subdomain), if boundary(subdomain) is true!");
+    return *(result->second);
+  } // ... boundaryGridPartReference(...)
+
+  const CouplingGridPartType& couplingGridPartReference(const size_t subdomain, const size_t neighbor) const
+  {
+    assert(subdomain < size_);
+    assert(neighbor < size_);
+    const std::vector<std::map<size_t, std::shared_ptr<const CouplingGridPartType>>>& couplingGridPartsMaps =
+        *couplingGridPartsMaps_;
+    const std::map<size_t, std::shared_ptr<const CouplingGridPartType>>& couplingGridPartsMap =
+        couplingGridPartsMaps[subdomain];
+    const typename std::map<size_t, std::shared_ptr<const CouplingGridPartType>>::const_iterator result =
+        couplingGridPartsMap.find(neighbor);
+    if (result == couplingGridPartsMap.end()) {
+      std::stringstream msg;
+      msg << "Error in " << id() << ": subdomain " << neighbor << " is not a neighbor of subdomain " << subdomain
+          << "!";
+      DUNE_THROW(Dune::InvalidStateException, msg.str());
+    }
+    return *(result->second);
+  } // ... couplingGridPartReference(...)
+
   void createGridViews()
   {
     // create global grid view
@@ -379,6 +657,12 @@ private:
       couplingGridPartsMaps_;
   bool oversampling_;
   const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>> oversampledLocalGridParts_;
+  const std::shared_ptr<const FaceTableType> faceTable_;
+  const int boundaryId_;
+  const std::shared_ptr<const CommunicationType> communication_;
+  //! the communicated grid parts (the oversampled ones if oversampling_, else the local ones) with communication_
+  const std::shared_ptr<const std::vector<std::shared_ptr<const LocalGridPartType>>> communicatingGridParts_;
+  const std::shared_ptr<Attachments> attachments_;
   std::shared_ptr<std::vector<std::shared_ptr<const LocalGridViewType>>> localGridViews_;
   std::shared_ptr<std::map<size_t, std::shared_ptr<const BoundaryGridViewType>>> boundaryGridViews_;
   std::shared_ptr<std::vector<std::map<size_t, std::shared_ptr<const CouplingGridViewType>>>> couplingGridViewsMaps_;
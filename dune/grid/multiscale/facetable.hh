@@ -0,0 +1,164 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_FACETABLE_HH
+#define DUNE_GRID_MULTISCALE_FACETABLE_HH
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cassert>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/part/storage.hh>
+#include <dune/grid/part/indexset/local.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+/**
+ *  \brief  Classifies each face of each element of the global grid part with respect to the subdomains of a multiscale
+ *          grid.
+ *
+ *          The table is indexed by (element, face), where element is given by element(entity) and face is the local
+ *          index of the intersection in the element (intersection.indexInInside()). Each face is either
+ *          - interior: the neighbor lies in the same subdomain,
+ *          - coupling: the neighbor lies in subdomain neighbor(element, face),
+ *          - boundary: the face lies on the domain boundary with boundaryId(element, face),
+ *          - mixed: a nonconforming face with several intersections of different kind (use the intersections then),
+ *          - none: the element has no such face.
+ *
+ *          Together with subdomain(element) this allows to assemble all local, coupling and boundary terms in a single
+ *          traversal of the global grid part.
+ */
+template <class GlobalGridPartImp>
+class FaceTable
+{
+public:
+  typedef GlobalGridPartImp GlobalGridPartType;
+  typedef typename GlobalGridPartType::GridType GridType;
+  typedef typename GridType::template Codim<0>::Entity EntityType;
+
+  static const unsigned int dimension = GridType::dimension;
+
+  static const size_t maxFaces = IndexSet::Local::MaxSubEntities<dimension, 1>::value;
+
+  enum Kind : unsigned char
+  {
+    none = 0,
+    interior,
+    coupling,
+    boundary,
+    mixed
+  };
+
+  explicit FaceTable(const std::shared_ptr<const GlobalGridPartType> globalGridPart)
+    : globalGridPart_(globalGridPart)
+    , offsets_(GlobalGeometryTypeIndex::size(dimension), std::numeric_limits<size_t>::max())
+    , size_(0)
+  {
+    const auto& geometryTypes = globalGridPart_->indexSet().geomTypes(0);
+    for (const auto& geometryType : geometryTypes) {
+      offsets_[GlobalGeometryTypeIndex::index(geometryType)] = size_;
+      size_ += globalGridPart_->indexSet().size(geometryType);
+    }
+    subdomains_.assign(size_, 0);
+    kinds_.assign(size_ * maxFaces, none);
+    values_.assign(size_ * maxFaces, 0);
+  } // FaceTable(...)
+
+  //! the number of elements
+  size_t size() const { return size_; }
+
+  //! the row of the table corresponding to the given entity of the global grid part
+  size_t element(const EntityType& entity) const
+  {
+    const size_t offset = offsets_[GlobalGeometryTypeIndex::index(entity.type())];
+    assert(offset != std::numeric_limits<size_t>::max());
+    return offset + globalGridPart_->indexSet().index(entity);
+  }
+
+  //! the row of the table corresponding to the element of the given geometry type and global index
+  size_t element(const GeometryType& geometryType, const size_t index) const
+  {
+    const size_t offset = offsets_[GlobalGeometryTypeIndex::index(geometryType)];
+    assert(offset != std::numeric_limits<size_t>::max());
+    return offset + index;
+  }
+
+  size_t subdomain(const size_t element) const
+  {
+    assert(element < size_);
+    return subdomains_[element];
+  }
+
+  Kind kind(const size_t element, const size_t face) const
+  {
+    assert(element < size_);
+    assert(face < maxFaces);
+    return static_cast<Kind>(kinds_[element * maxFaces + face]);
+  }
+
+  //! the kinds of all faces of the given element (maxFaces consecutive entries)
+  const unsigned char* kinds(const size_t element) const
+  {
+    assert(element < size_);
+    return &kinds_[element * maxFaces];
+  }
+
+  //! the subdomain on the other side of a coupling face
+  size_t neighbor(const size_t element, const size_t face) const
+  {
+    assert(kind(element, face) == coupling);
+    return values_[element * maxFaces + face];
+  }
+
+  //! the boundary id of a boundary face
+  int boundaryId(const size_t element, const size_t face) const
+  {
+    assert(kind(element, face) == boundary);
+    return static_cast<int>(values_[element * maxFaces + face]);
+  }
+
+  //! used by the factory to fill the table
+  void setSubdomain(const size_t element, const size_t subdomain)
+  {
+    assert(element < size_);
+    subdomains_[element] = Part::Storage::store<Part::Storage::SubdomainType>(subdomain);
+  }
+
+  //! used by the factory to fill the table, marks the face as mixed, if it was already set to something different
+  void set(const size_t element, const size_t face, const Kind kind, const size_t value = 0)
+  {
+    assert(element < size_);
+    assert(face < maxFaces);
+    // boundary ids are stored as their bit pattern, see boundaryId()
+    const Part::Storage::SubdomainType storedValue = static_cast<Part::Storage::SubdomainType>(value);
+    unsigned char& existingKind                    = kinds_[element * maxFaces + face];
+    Part::Storage::SubdomainType& existingValue    = values_[element * maxFaces + face];
+    if (existingKind == none) {
+      existingKind  = kind;
+      existingValue = storedValue;
+    } else if (existingKind != kind || existingValue != storedValue)
+      existingKind = mixed;
+  } // ... set(...)
+
+private:
+  const std::shared_ptr<const GlobalGridPartType> globalGridPart_;
+  std::vector<size_t> offsets_;
+  size_t size_;
+  std::vector<Part::Storage::SubdomainType> subdomains_;
+  std::vector<unsigned char> kinds_;
+  std::vector<Part::Storage::SubdomainType> values_;
+}; // class FaceTable
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_FACETABLE_HH
@@ -9,6 +9,9 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <limits>
+#include <utility>
+#include <algorithm>
 
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -17,6 +20,7 @@
 #include <dune/common/fvector.hh>
 
 #include <dune/geometry/type.hh>
+#include <dune/geometry/typeindex.hh>
 
 #include <dune/stuff/common/disable_warnings.hh>
 # include <dune/grid/sgrid.hh>
@@ -28,6 +32,8 @@
 
 #include <dune/grid/part/local/indexbased.hh>
 #include <dune/grid/multiscale/default.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/refinement.hh>
 
 #include <dune/stuff/common/logging.hh>
 #include <dune/stuff/common/type_utils.hh>
@@ -133,12 +139,17 @@ private:
 
   typedef typename MsGridType::CouplingGridPartType CouplingGridPartType;
 
+  typedef typename MsGridType::FaceTableType FaceTableType;
+
   typedef typename GlobalGridPartType::IndexSetType::IndexType IndexType;
 
+  //! the type indices are stored as, see Part::Storage
+  typedef typename Part::Storage::Index<IndexType>::type StoredIndexType;
+
   typedef Dune::GeometryType GeometryType;
 
   // i.e. maps a local to a globl index
-  typedef std::map<IndexType, IndexType> IndexMapType;
+  typedef std::map<StoredIndexType, StoredIndexType> IndexMapType;
 
   // i.e. maps a GeometryType to a map of local and global indices
   typedef std::map<GeometryType, IndexMapType> GeometryMapType;
@@ -147,7 +158,7 @@ private:
   typedef std::map<size_t, std::shared_ptr<GeometryMapType>> SubdomainMapType;
 
   // map type which maps from an entity index (of the global grid parts index set) to a subdomain
-  typedef std::map<IndexType, size_t> EntityToSubdomainMapType;
+  typedef typename MsGridType::EntityToSubdomainMapType EntityToSubdomainMapType;
 
   typedef Dune::FieldVector<size_t, dim + 1> CodimSizesType;
 
@@ -176,6 +187,22 @@ private:
     } // static void subEntities()
   };  // struct Add
 
+  //! calls sink(geometryType, globalIndex, codim) for all codim c to d subentities of entity, used by add(subdomains)
+  template <int c, int d>
+  struct Collect
+  {
+    template <class SinkType>
+    static void subEntities(const ThisType& factory, const EntityType& entity, SinkType& sink)
+    {
+      typedef typename EntityType::template Codim<c>::EntityPointer CodimCentityPtrType;
+      for (int i = 0; i < entity.template count<c>(); ++i) {
+        const CodimCentityPtrType codimCentityPtr = entity.template subEntity<c>(i);
+        sink(codimCentityPtr->type(), factory.globalGridPart_->indexSet().index(*codimCentityPtr), c);
+      }
+      Collect<c + 1, d>::subEntities(factory, entity, sink);
+    } // static void subEntities()
+  };  // struct Collect
+
 public:
   Default(const GridType& grid, const int boundaryId = 7)
     : grid_(Dune::stackobject_to_shared_ptr(grid))
@@ -184,11 +211,18 @@ public:
     , finalized_(false)
     , size_(0)
     , oversampled_(false)
+    , ascendingLocalIndices_(false)
   {
   }
 
   Default(const std::shared_ptr<const GridType> grid, const int boundaryId = 7)
-    : grid_(grid), boundaryId_(boundaryId), prepared_(false), finalized_(false), size_(0), oversampled_(false)
+    : grid_(grid)
+    , boundaryId_(boundaryId)
+    , prepared_(false)
+    , finalized_(false)
+    , size_(0)
+    , oversampled_(false)
+    , ascendingLocalIndices_(false)
   {
   }
 
@@ -201,6 +235,17 @@ public:
     } // if (!prepared_)
   }   // void prepare()
 
+  //! like prepare(), but uses the given global grid part (which has to belong to the grid of this factory), e.g. to
+  //! share one global grid part between several multiscale grids
+  void prepare(const std::shared_ptr<const GlobalGridPartType> globalGridPart)
+  {
+    if (!prepared_) {
+      globalGridPart_       = globalGridPart;
+      entityToSubdomainMap_ = std::shared_ptr<EntityToSubdomainMapType>(new EntityToSubdomainMapType());
+      prepared_             = true;
+    } // if (!prepared_)
+  }   // void prepare(...)
+
   const std::shared_ptr<const GlobalGridPartType> globalGridPart() const
   {
     assert(prepared_ && "Please call prepare() before calling globalGridPart()!");
@@ -220,7 +265,9 @@ public:
     // add subdomain to this entity index
     typename EntityToSubdomainMapType::iterator indexIt = entityToSubdomainMap_->find(globalIndex);
     if (indexIt == entityToSubdomainMap_->end()) {
-      entityToSubdomainMap_->insert(std::pair<IndexType, size_t>(globalIndex, subdomain));
+      entityToSubdomainMap_->insert(
+          std::make_pair(Part::Storage::store<typename EntityToSubdomainMapType::key_type>(globalIndex),
+                         Part::Storage::store<typename EntityToSubdomainMapType::mapped_type>(subdomain)));
     } else {
       if (indexIt->second != subdomain) {
         std::stringstream msg;
@@ -248,6 +295,173 @@ public:
     Add<1, dim>::subEntities(*this, entity, geometryMap, localCodimSizes/*, prefix, out*/);
   } // void add()
 
+  /**
+   *  \brief Adds all elements of the global grid part at once, subdomains[ii] being the subdomain of the ii'th element
+   *         of the walk from globalGridPart()->begin< 0 >() to end< 0 >().
+   *
+   *         The result is the same as calling add(entity, subdomains[ii]) during this walk (including the local
+   *         numbering), but the index maps are built from sorted arrays instead of one map lookup per subentity. If
+   *         entities have already been added one by one, this falls back to add(entity, subdomain).
+   *  \param ascendingLocalIndices if true, the local indices of each codim are given in ascending order of the global
+   *         ones (per GeometryType) instead of in the order of the walk. For tensor product subdomains of Cartesian
+   *         grids the local index sets can then compute their lookups, see Part::IndexSet::Local::IndexLookup.
+   */
+  void add(const std::vector<size_t>& subdomains, const bool ascendingLocalIndices = false)
+  {
+    assert(prepared_ && "Please call prepare() before calling add()!");
+    assert(!finalized_ && "Do not call add() after calling finalized()!");
+    ascendingLocalIndices_ = ascendingLocalIndices;
+    const auto& indexSet = globalGridPart_->indexSet();
+    if (subdomains.size() != size_t(indexSet.size(0)))
+      DUNE_THROW(Dune::InvalidStateException,
+                 "Error in " << id() << ": subdomains has size " << subdomains.size() << ", there are "
+                             << indexSet.size(0)
+                             << " elements!");
+    const auto entityItEnd = globalGridPart_->template end<0>();
+    if (!entityToSubdomainMap_->empty()) {
+      size_t ii = 0;
+      for (auto entityIt = globalGridPart_->template begin<0>(); entityIt != entityItEnd; ++entityIt, ++ii)
+        add(*entityIt, subdomains[ii]);
+      return;
+    }
+    const size_t numSubdomains =
+        subdomains.empty() ? 0 : *std::max_element(subdomains.begin(), subdomains.end()) + 1;
+    // walk the grid once and record for each subdomain and codim the subentities in the order of their occurrence
+    // (as pairs of geometry type index and global index), skipping repetitions where this is cheap
+    typedef std::pair<size_t, IndexType> OccurrenceType;
+    std::vector<std::vector<std::vector<OccurrenceType>>> occurrences(numSubdomains);
+    std::vector<GeometryType> geometryTypes(GlobalGeometryTypeIndex::size(dim));
+    std::vector<std::vector<size_t>> lastSeenBy(GlobalGeometryTypeIndex::size(dim));
+    std::vector<std::pair<StoredIndexType, typename EntityToSubdomainMapType::mapped_type>> entitySubdomains;
+    entitySubdomains.reserve(subdomains.size());
+    size_t subdomain = 0;
+    const auto sink  = [&](const GeometryType& geometryType, const IndexType& globalIndex, const unsigned int codim) {
+      const size_t geometryTypeIndex  = GlobalGeometryTypeIndex::index(geometryType);
+      std::vector<size_t>& lastSeen = lastSeenBy[geometryTypeIndex];
+      if (lastSeen.empty()) {
+        lastSeen.assign(indexSet.size(geometryType), std::numeric_limits<size_t>::max());
+        geometryTypes[geometryTypeIndex] = geometryType;
+      }
+      if (lastSeen[globalIndex] == subdomain)
+        return;
+      lastSeen[globalIndex] = subdomain;
+      occurrences[subdomain][codim].push_back(OccurrenceType(geometryTypeIndex, globalIndex));
+    };
+    size_t ii = 0;
+    for (auto entityIt = globalGridPart_->template begin<0>(); entityIt != entityItEnd; ++entityIt, ++ii) {
+      const EntityType& entity = *entityIt;
+      subdomain                = subdomains[ii];
+      if (occurrences[subdomain].empty())
+        occurrences[subdomain].resize(dim + 1);
+      const IndexType globalIndex = indexSet.index(entity);
+      entitySubdomains.push_back(
+          std::make_pair(Part::Storage::store<StoredIndexType>(globalIndex),
+                         Part::Storage::store<typename EntityToSubdomainMapType::mapped_type>(subdomain)));
+      sink(entity.type(), globalIndex, 0);
+      Collect<1, dim>::subEntities(*this, entity, sink);
+    } // walk the grid once
+    // the entity to subdomain map
+    std::sort(entitySubdomains.begin(), entitySubdomains.end());
+    for (size_t jj = 1; jj < entitySubdomains.size(); ++jj)
+      if (entitySubdomains[jj].first == entitySubdomains[jj - 1].first
+          && entitySubdomains[jj].second != entitySubdomains[jj - 1].second)
+        DUNE_THROW(Dune::InvalidStateException,
+                   "Error in " << id() << ": can not add entity to more than one subdomain!");
+    for (size_t jj = 0; jj < entitySubdomains.size(); ++jj)
+      entityToSubdomainMap_->insert(entityToSubdomainMap_->end(), entitySubdomains[jj]);
+    // the index maps of each subdomain, local indices are given in the order of the first occurrence (per codim) or in
+    // ascending order
+    for (size_t ss = 0; ss < numSubdomains; ++ss) {
+      if (occurrences[ss].empty())
+        continue;
+      std::shared_ptr<GeometryMapType> geometryMap = std::make_shared<GeometryMapType>();
+      CodimSizesType localCodimSizes(0);
+      std::vector<std::vector<std::pair<StoredIndexType, StoredIndexType>>> indexPairs(geometryTypes.size());
+      for (unsigned int codim = 0; codim <= dim; ++codim) {
+        const std::vector<OccurrenceType>& codimOccurrences = occurrences[ss][codim];
+        std::vector<size_t> order(codimOccurrences.size());
+        for (size_t jj = 0; jj < order.size(); ++jj)
+          order[jj] = jj;
+        // sort by entity (stable, so the first occurrence comes first) and keep only the first occurrences
+        std::stable_sort(order.begin(), order.end(), [&](const size_t aa, const size_t bb) {
+          return codimOccurrences[aa] < codimOccurrences[bb];
+        });
+        order.erase(std::unique(order.begin(),
+                                order.end(),
+                                [&](const size_t aa, const size_t bb) {
+                                  return codimOccurrences[aa] == codimOccurrences[bb];
+                                }),
+                    order.end());
+        // back to the order of the first occurrence
+        if (!ascendingLocalIndices)
+          std::sort(order.begin(), order.end());
+        for (size_t jj = 0; jj < order.size(); ++jj) {
+          const OccurrenceType& occurrence = codimOccurrences[order[jj]];
+          indexPairs[occurrence.first].push_back(
+              std::make_pair(Part::Storage::store<StoredIndexType>(occurrence.second),
+                             Part::Storage::store<StoredIndexType>(jj)));
+        }
+        localCodimSizes[codim] = order.size();
+      }
+      for (size_t gg = 0; gg < indexPairs.size(); ++gg) {
+        if (indexPairs[gg].empty())
+          continue;
+        std::sort(indexPairs[gg].begin(), indexPairs[gg].end());
+        IndexMapType& indexMap = (*geometryMap)[geometryTypes[gg]];
+        for (size_t jj = 0; jj < indexPairs[gg].size(); ++jj)
+          indexMap.insert(indexMap.end(), indexPairs[gg][jj]);
+      }
+      subdomainToEntityMap_.insert(std::make_pair(ss, geometryMap));
+      localCodimSizes_.insert(std::make_pair(ss, localCodimSizes));
+      ++size_;
+    } // the index maps of each subdomain
+  }   // ... add(...)
+
+  /**
+   *  \brief Reduces the interfaces between the subdomains given so far by greedy boundary refinement of the labeling
+   *         on the dual graph of the global grid part (see Partitioner::refine_partition), and rebuilds the subdomains
+   *         if any element moved.
+   *
+   *         Optional, has to be called after all elements have been added and before finalize().
+   *  \param weights one weight per element in the order of the walk over the global grid part, all 1 if empty
+   *  \return the edge cut before and after the refinement and the number of moves
+   */
+  Partitioner::RefinementStatistics refine(const double imbalance = 0.03,
+                                           const std::vector<double>& weights = std::vector<double>(),
+                                           const size_t maxPasses = 8)
+  {
+    assert(prepared_ && "Please call prepare() and add() before calling refine()!");
+    assert(!finalized_ && "Do not call refine() after calling finalized()!");
+    const auto& indexSet = globalGridPart_->indexSet();
+    if (entityToSubdomainMap_->size() != size_t(indexSet.size(0)))
+      DUNE_THROW(Dune::InvalidStateException,
+                 "Error in " << id() << ": please add all elements before calling refine() (there are "
+                             << indexSet.size(0)
+                             << " elements, "
+                             << entityToSubdomainMap_->size()
+                             << " have been added)!");
+    // the current labeling in the order of the walk
+    std::vector<size_t> subdomains;
+    subdomains.reserve(entityToSubdomainMap_->size());
+    size_t numSubdomains   = 0;
+    const auto entityItEnd = globalGridPart_->template end<0>();
+    for (auto entityIt = globalGridPart_->template begin<0>(); entityIt != entityItEnd; ++entityIt) {
+      subdomains.push_back(entityToSubdomainMap_->find(indexSet.index(*entityIt))->second);
+      numSubdomains = std::max(numSubdomains, subdomains.back() + 1);
+    }
+    const Partitioner::Graph graph = Partitioner::dual_graph(*globalGridPart_, weights);
+    const Partitioner::RefinementStatistics statistics =
+        Partitioner::refine_partition(graph, subdomains, numSubdomains, imbalance, maxPasses);
+    if (statistics.moves > 0) {
+      entityToSubdomainMap_->clear();
+      subdomainToEntityMap_.clear();
+      localCodimSizes_.clear();
+      size_ = 0;
+      add(subdomains, ascendingLocalIndices_);
+    }
+    return statistics;
+  } // ... refine(...)
+
   void finalize(const size_t oversamplingLayers = 0,
                 const size_t neighbor_recursion_level = NeighborRecursionLevel<GridType>::compute(),
 //                const std::string prefix = "", std::ostream& out = Dune::Stuff::Common::Logger().debug(),
@@ -262,7 +476,7 @@ public:
       //   * to map the local intersection index to the desired fake boundary id
       typedef std::map<int, int> IntersectionToBoundaryIdMapType;
       //   * to map the global entity index to one of those maps
-      typedef std::map<IndexType, IntersectionToBoundaryIdMapType> EntityToIntersectionInfoMapType;
+      typedef std::map<StoredIndexType, IntersectionToBoundaryIdMapType> EntityToIntersectionInfoMapType;
       //   * to hold one of those maps for each subdomain
       std::vector<std::shared_ptr<EntityToIntersectionInfoMapType>> subdomainInnerBoundaryInfos(size_);
       // for the coupling grid parts
@@ -271,9 +485,9 @@ public:
       //   * vector to hold a map of coupling sizes
       std::vector<std::map<size_t, CodimSizesType>> couplingCodimSizeMaps(size_, std::map<size_t, CodimSizesType>());
       //   * set of local coupling intersections
-      typedef std::vector<int> IntersectionInfoSetType;
+      typedef std::vector<Part::Storage::FaceType> IntersectionInfoSetType;
       //   * map to hold the above information for each coupling entity
-      typedef std::map<IndexType, IntersectionInfoSetType> EntityToIntersectionSetMapType;
+      typedef std::map<StoredIndexType, IntersectionInfoSetType> EntityToIntersectionSetMapType;
       //   * map to hold the above map for each neighboring subdomain
       typedef std::map<size_t, std::shared_ptr<EntityToIntersectionSetMapType>> CouplingIntersectionMapType;
       //   * vector to hold the above map for each subdomain
@@ -289,6 +503,9 @@ public:
       neighboringSubdomainSets_ = std::shared_ptr<std::vector<NeighboringSubdomainsSetType>>(
           new std::vector<NeighboringSubdomainsSetType>(size_, NeighboringSubdomainsSetType()));
       std::vector<NeighboringSubdomainsSetType>& neighboringSubdomainSets = *neighboringSubdomainSets_;
+      // for the face classification
+      faceTable_ = std::make_shared<FaceTableType>(globalGridPart_);
+      FaceTableType& faceTable = *faceTable_;
       // loop over all subdomains
       //   * to test for consecutive numbering
       //   * to compute the number of codim 0 entities per subdomain
@@ -333,6 +550,8 @@ public:
         const EntityType& entity          = *entityIt;
         const IndexType entityGlobalIndex = globalGridPart_->indexSet().index(entity);
         const size_t entitySubdomain      = getSubdomainOf(entityGlobalIndex);
+        const size_t entityFaceTableRow   = faceTable.element(entity);
+        faceTable.setSubdomain(entityFaceTableRow, entitySubdomain);
         // get the set of this subdomains neighbors
         NeighboringSubdomainsSetType& neighborsOfSubdomain = neighboringSubdomainSets[entitySubdomain];
         // get the boundary info map for this subdomain
@@ -348,6 +567,7 @@ public:
           if (intersection.boundary() && !intersection.neighbor()) {
             // get local index of the intersection
             const int intersectionLocalIndex = intersection.indexInInside();
+            faceTable.set(entityFaceTableRow, intersectionLocalIndex, FaceTableType::boundary, intersection.boundaryId());
             // report
 //#ifndef NDEBUG
 //            out << prefix << "    entity " << entityGlobalIndex << " lies at the domain boundary of subdomain "
@@ -377,7 +597,7 @@ public:
             //   * and get the entry for this entity
             IntersectionInfoSetType& entityBoundaryInfo = boundaryInfo[entityGlobalIndex];
             //   * and add this local intersection
-            entityBoundaryInfo.push_back(intersectionLocalIndex);
+            entityBoundaryInfo.push_back(Part::Storage::store<Part::Storage::FaceType>(intersectionLocalIndex));
           } else if (intersection.neighbor()) {
             // then this entity lies inside the domain
             // and has a neighbor
@@ -390,6 +610,7 @@ public:
             if (neighborSubdomain != entitySubdomain) {
               // get local index of the intersection
               const int intersectionLocalIndex = intersection.indexInInside();
+              faceTable.set(entityFaceTableRow, intersectionLocalIndex, FaceTableType::coupling, neighborSubdomain);
 //#ifndef NDEBUG
 //              // report
 //              out << prefix << "    entity " << entityGlobalIndex << " lies at an inner boundary of subdomain "
@@ -438,8 +659,10 @@ public:
               //   * get the entry for this entity
               IntersectionInfoSetType& entityCouplingBoundaryInfo = couplingBoundaryInfoMap[entityGlobalIndex];
               //   * and add this local intersection
-              entityCouplingBoundaryInfo.push_back(intersectionLocalIndex);
+              entityCouplingBoundaryInfo.push_back(
+                  Part::Storage::store<Part::Storage::FaceType>(intersectionLocalIndex));
             } else { // if neighbor is contained in this subdomain
+              faceTable.set(entityFaceTableRow, intersection.indexInInside(), FaceTableType::interior);
               subdomainsEntitiesAreConnected = true;
             } // check if neighbor is in another subdomain
           }   // check the type of this intersection
@@ -598,7 +821,9 @@ public:
                                            localGridParts_,
                                            boundaryGridParts_,
                                            couplingGridPartsMaps_,
-                                           oversampledLocalGridParts_);
+                                           oversampledLocalGridParts_,
+                                           faceTable_,
+                                           boundaryId_);
     else
       return Dune::make_shared<MsGridType>(grid_,
                                            globalGridPart_,
@@ -607,7 +832,9 @@ public:
                                            entityToSubdomainMap_,
                                            localGridParts_,
                                            boundaryGridParts_,
-                                           couplingGridPartsMaps_);
+                                           couplingGridPartsMaps_,
+                                           faceTable_,
+                                           boundaryId_);
   } // const std::shared_ptr< const MsGridType > createMsGrid() const
 
 private:
@@ -621,7 +848,8 @@ private:
     if (indexMap.find(globalIndex) == indexMap.end()) {
       const size_t codim         = dim - geometryType.dim();
       const IndexType localIndex = boost::numeric_cast<IndexType>(localCodimSizes[codim]);
-      indexMap.insert(std::pair<IndexType, IndexType>(globalIndex, localIndex));
+      indexMap.insert(std::make_pair(Part::Storage::store<StoredIndexType>(globalIndex),
+                                     Part::Storage::store<StoredIndexType>(localIndex)));
       // increase count for this codim
       ++(localCodimSizes[codim]);
       // report
@@ -654,7 +882,7 @@ private:
     //   * to map the local intersection index to the desired fake boundary id
     typedef std::map<int, int> IntersectionToBoundaryIdMapType;
     //   * to map the global entity index to one of those maps
-    typedef std::map<IndexType, IntersectionToBoundaryIdMapType> EntityToIntersectionInfoMapType;
+    typedef std::map<StoredIndexType, IntersectionToBoundaryIdMapType> EntityToIntersectionInfoMapType;
     //   * to hold one of those maps for each subdomain
     std::vector<std::shared_ptr<EntityToIntersectionInfoMapType>> oversamplingSubdomainInnerBoundaryInfos(size_);
     // walk the subdomains to create the oversampling
@@ -844,6 +1072,8 @@ private:
   // friends
   template <int, int>
   friend struct Add;
+  template <int, int>
+  friend struct Collect;
 
   // members
   const std::shared_ptr<const GridType> grid_;
@@ -866,7 +1096,10 @@ private:
   std::shared_ptr<std::map<size_t, std::shared_ptr<const BoundaryGridPartType>>> boundaryGridParts_;
   // for the coupling grid parts
   std::shared_ptr<std::vector<std::map<size_t, std::shared_ptr<const CouplingGridPartType>>>> couplingGridPartsMaps_;
+  // for the face classification
+  std::shared_ptr<FaceTableType> faceTable_;
   bool oversampled_;
+  bool ascendingLocalIndices_;
 }; // class Default
 
 //! specialization to stop the recursion
@@ -893,6 +1126,23 @@ struct Default<GridType>::Add<c, c>
   }   // static void subEntities()
 };    // struct Default< GridType >::Add< c, c >
 
+//! specialization to stop the recursion
+template <class GridType>
+template <int c>
+struct Default<GridType>::Collect<c, c>
+{
+  template <class SinkType>
+  static void subEntities(const Default<GridType>& factory, const typename Default<GridType>::EntityType& entity,
+                          SinkType& sink)
+  {
+    typedef typename Default<GridType>::EntityType::template Codim<c>::EntityPointer CodimCentityPtrType;
+    for (int i = 0; i < entity.template count<c>(); ++i) {
+      const CodimCentityPtrType codimCentityPtr = entity.template subEntity<c>(i);
+      sink(codimCentityPtr->type(), factory.globalGridPart_->indexSet().index(*codimCentityPtr), c);
+    }
+  } // static void subEntities()
+};  // struct Default< GridType >::Collect< c, c >
+
 } // namespace Factory
 } // namespace Multiscale
 } // namespace grid
@@ -0,0 +1,226 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_HIERARCHY_HH
+#define DUNE_GRID_MULTISCALE_HIERARCHY_HH
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/multiscale/default.hh>
+#include <dune/grid/multiscale/factory/default.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/multilevel.hh>
+#include <dune/grid/multiscale/partitioner/agglomeration.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  A hierarchy of nested decompositions of one grid, for two-level and multilevel domain decomposition.
+ *
+ *          Level 0 is the finest decomposition, each subdomain of level ll + 1 is the union of some subdomains of level
+ *          ll (its children, see parent() and children()). Each level is a complete multiscale grid (see msGrid()),
+ *          all of them share one global grid part.
+ *
+ *          The subdomains of each level are also available as coarse elements (volume, center and faces, see
+ *          Partitioner::CoarseElement): only those of level 0 are computed from the grid, all others are agglomerated
+ *          from the level below, so a coarse space can be assembled at a cost proportional to the number of
+ *          subdomains. The subdomains of the finest level have to be connected, those of the coarser levels do not.
+ */
+template <class GridImp>
+class Hierarchy
+{
+  typedef Hierarchy<GridImp> ThisType;
+
+public:
+  typedef GridImp GridType;
+  typedef Default<GridType> MsGridType;
+  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+
+  static const int dimWorld = GridType::dimensionworld;
+  typedef Partitioner::CoarseElement<dimWorld> CoarseElementType;
+
+  /**
+   *  \brief  Partitions the grid with Partitioner::multilevel_partition: the elements into numSubdomains[0]
+   *          subdomains, the coarse elements of each level ll into numSubdomains[ll + 1] subdomains of the next one.
+   */
+  static std::unique_ptr<ThisType> create(const std::shared_ptr<const GridType> grid,
+                                          const std::vector<size_t>& numSubdomains, const double imbalance = 0.03,
+                                          const unsigned int seed = 0, const size_t numOversamplingLayers = 0)
+  {
+    if (numSubdomains.empty())
+      DUNE_THROW(Dune::RangeError, "numSubdomains is empty!");
+    std::unique_ptr<ThisType> hierarchy(new ThisType(grid, numOversamplingLayers));
+    const auto graph = Partitioner::dual_graph(*hierarchy->globalGridPart_);
+    hierarchy->addFinestLevel(Partitioner::multilevel_partition(graph, numSubdomains[0], imbalance, seed));
+    for (size_t ll = 1; ll < numSubdomains.size(); ++ll) {
+      const auto coarseGraph = Partitioner::coarse_graph(hierarchy->coarseElements_.back());
+      hierarchy->addCoarserLevel(Partitioner::multilevel_partition(coarseGraph, numSubdomains[ll], imbalance, seed));
+    }
+    return hierarchy;
+  } // ... create(...)
+
+  /**
+   *  \param  labels  the subdomain of each element on level 0, in the order of the walk over the global grid part
+   *  \param  parents parents[ll][ss] is the subdomain of level ll + 1 which contains subdomain ss of level ll
+   */
+  Hierarchy(const std::shared_ptr<const GridType> grid, const std::vector<size_t>& labels,
+            const std::vector<std::vector<size_t>>& parents = std::vector<std::vector<size_t>>(),
+            const size_t numOversamplingLayers = 0)
+    : Hierarchy(grid, numOversamplingLayers)
+  {
+    addFinestLevel(labels);
+    for (const auto& levelParents : parents)
+      addCoarserLevel(levelParents);
+  }
+
+  size_t levels() const { return msGrids_.size(); }
+
+  const std::shared_ptr<const GridType>& grid() const { return grid_; }
+
+  const std::shared_ptr<const GlobalGridPartType>& globalGridPart() const { return globalGridPart_; }
+
+  const std::shared_ptr<const MsGridType>& msGrid(const size_t level) const
+  {
+    checkLevel(level);
+    return msGrids_[level];
+  }
+
+  //! the number of subdomains of level
+  size_t size(const size_t level) const
+  {
+    checkLevel(level);
+    return coarseElements_[level].size();
+  }
+
+  //! the subdomain of each element on level, in the order of the walk over the global grid part
+  const std::vector<size_t>& labels(const size_t level) const
+  {
+    checkLevel(level);
+    return labels_[level];
+  }
+
+  //! the subdomains of level as coarse elements, see Partitioner::CoarseElement
+  const std::vector<CoarseElementType>& coarseElements(const size_t level) const
+  {
+    checkLevel(level);
+    return coarseElements_[level];
+  }
+
+  //! the subdomain of level + 1 containing subdomain of level
+  size_t parent(const size_t level, const size_t subdomain) const
+  {
+    if (level + 1 >= levels())
+      DUNE_THROW(Dune::RangeError, "level " << level << " has no parents, there are " << levels() << " levels!");
+    return parents_[level][subdomain];
+  }
+
+  //! the subdomains of level - 1 contained in subdomain of level
+  const std::vector<size_t>& children(const size_t level, const size_t subdomain) const
+  {
+    if (level == 0 || level >= levels())
+      DUNE_THROW(Dune::RangeError, "level " << level << " has no children, there are " << levels() << " levels!");
+    return children_[level][subdomain];
+  }
+
+private:
+  Hierarchy(const std::shared_ptr<const GridType> grid, const size_t numOversamplingLayers)
+    : grid_(grid)
+    , globalGridPart_(std::make_shared<const GlobalGridPartType>(const_cast<GridType&>(*grid_)))
+    , numOversamplingLayers_(numOversamplingLayers)
+  {
+  }
+
+  void checkLevel(const size_t level) const
+  {
+    if (level >= levels())
+      DUNE_THROW(Dune::RangeError, "level " << level << " requested, there are " << levels() << " levels!");
+  }
+
+  //! the number of labels, every label in [0, result) has to be used
+  static size_t countLabels(const std::vector<size_t>& labels, const size_t level)
+  {
+    const size_t numLabels = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+    std::vector<bool> used(numLabels, false);
+    for (const size_t label : labels)
+      used[label] = true;
+    for (size_t ss = 0; ss < numLabels; ++ss)
+      if (!used[ss])
+        DUNE_THROW(Dune::InvalidStateException, "subdomain " << ss << " of level " << level << " is empty!");
+    return numLabels;
+  } // ... countLabels(...)
+
+  void addFinestLevel(const std::vector<size_t>& labels)
+  {
+    const size_t numSubdomains = countLabels(labels, 0);
+    coarseElements_.push_back(Partitioner::agglomerate(*globalGridPart_, labels, numSubdomains));
+    children_.emplace_back(numSubdomains);
+    labels_.push_back(labels);
+    msGrids_.push_back(buildMsGrid(labels, true));
+  } // ... addFinestLevel(...)
+
+  void addCoarserLevel(const std::vector<size_t>& parents)
+  {
+    const size_t level = levels();
+    if (parents.size() != coarseElements_.back().size())
+      DUNE_THROW(Dune::InvalidStateException,
+                 "parents of level " << level - 1 << " has size " << parents.size() << ", the level has "
+                                     << coarseElements_.back().size()
+                                     << " subdomains!");
+    const size_t numSubdomains = countLabels(parents, level);
+    coarseElements_.push_back(Partitioner::agglomerate(coarseElements_.back(), parents, numSubdomains));
+    std::vector<std::vector<size_t>> children(numSubdomains);
+    for (size_t ss = 0; ss < parents.size(); ++ss)
+      children[parents[ss]].push_back(ss);
+    children_.push_back(children);
+    parents_.push_back(parents);
+    std::vector<size_t> labels(labels_.back().size());
+    for (size_t ee = 0; ee < labels.size(); ++ee)
+      labels[ee] = parents[labels_.back()[ee]];
+    labels_.push_back(labels);
+    msGrids_.push_back(buildMsGrid(labels, false));
+  } // ... addCoarserLevel(...)
+
+  std::shared_ptr<const MsGridType> buildMsGrid(const std::vector<size_t>& labels, const bool assertConnected) const
+  {
+    Factory::Default<GridType> factory(grid_);
+    factory.prepare(globalGridPart_);
+    factory.add(labels);
+    factory.finalize(numOversamplingLayers_, Factory::NeighborRecursionLevel<GridType>::compute(), assertConnected);
+    return factory.createMsGrid();
+  } // ... buildMsGrid(...)
+
+  const std::shared_ptr<const GridType> grid_;
+  const std::shared_ptr<const GlobalGridPartType> globalGridPart_;
+  const size_t numOversamplingLayers_;
+  std::vector<std::shared_ptr<const MsGridType>> msGrids_;
+  std::vector<std::vector<size_t>> labels_;
+  std::vector<std::vector<CoarseElementType>> coarseElements_;
+  std::vector<std::vector<size_t>> parents_;
+  std::vector<std::vector<std::vector<size_t>>> children_;
+}; // class Hierarchy
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class Hierarchy
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_HIERARCHY_HH
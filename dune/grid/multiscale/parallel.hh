@@ -0,0 +1,235 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARALLEL_HH
+#define DUNE_GRID_MULTISCALE_PARALLEL_HH
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <exception>
+#include <condition_variable>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+//! the number of threads used if none is given (the number of hardware threads, at least one)
+inline size_t default_num_threads()
+{
+  const size_t hardware_threads = std::thread::hardware_concurrency();
+  return std::max(hardware_threads, size_t(1));
+}
+
+/**
+ *  \brief  Splits [begin, end) into contiguous chunks and calls functor(chunk_begin, chunk_end, thread) for each chunk
+ *          in its own thread.
+ *
+ *          Blocks until all chunks are done, the first exception thrown by any of the chunks is rethrown. The threads
+ *          are started anew upon each call, there is no pool.
+ *  \param  num_threads number of threads to use, 0 means default_num_threads()
+ */
+template <class FunctorType>
+void parallel_for_chunks(const size_t begin, const size_t end, FunctorType functor, size_t num_threads = 0)
+{
+  if (end <= begin)
+    return;
+  if (num_threads == 0)
+    num_threads = default_num_threads();
+  num_threads = std::min(num_threads, end - begin);
+  if (num_threads == 1) {
+    functor(begin, end, size_t(0));
+    return;
+  }
+  const size_t chunk_size = (end - begin + num_threads - 1) / num_threads;
+  std::vector<std::exception_ptr> exceptions(num_threads);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t tt = 0; tt < num_threads; ++tt) {
+    const size_t chunk_begin = std::min(begin + tt * chunk_size, end);
+    const size_t chunk_end   = std::min(chunk_begin + chunk_size, end);
+    threads.emplace_back([&functor, &exceptions, chunk_begin, chunk_end, tt]() {
+      try {
+        functor(chunk_begin, chunk_end, tt);
+      } catch (...) {
+        exceptions[tt] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& exception : exceptions)
+    if (exception)
+      std::rethrow_exception(exception);
+} // ... parallel_for_chunks(...)
+
+/**
+ *  \brief  Calls functor(ii) for all ii in [begin, end), distributed over num_threads threads (see
+ *          parallel_for_chunks).
+ */
+template <class FunctorType>
+void parallel_for(const size_t begin, const size_t end, FunctorType functor, const size_t num_threads = 0)
+{
+  parallel_for_chunks(begin,
+                      end,
+                      [&functor](const size_t chunk_begin, const size_t chunk_end, const size_t /*thread*/) {
+                        for (size_t ii = chunk_begin; ii < chunk_end; ++ii)
+                          functor(ii);
+                      },
+                      num_threads);
+} // ... parallel_for(...)
+
+/**
+ *  \brief  A reusable barrier for a fixed number of threads: wait() blocks until all participants have called it.
+ *
+ *          Everything a participant wrote before its wait() is visible to all participants after their wait().
+ */
+class Barrier
+{
+public:
+  explicit Barrier(const size_t participants)
+    : participants_(participants)
+    , waiting_(0)
+    , generation_(0)
+  {
+  }
+
+  Barrier(const Barrier& other) = delete;
+
+  Barrier& operator=(const Barrier& other) = delete;
+
+  size_t participants() const { return participants_; }
+
+  void wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const size_t generation = generation_;
+    if (++waiting_ == participants_) {
+      waiting_ = 0;
+      ++generation_;
+      released_.notify_all();
+    } else
+      released_.wait(lock, [&]() { return generation_ != generation; });
+  } // ... wait(...)
+
+private:
+  const size_t participants_;
+  size_t waiting_;
+  size_t generation_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+}; // class Barrier
+
+/**
+ *  \brief  A reusable barrier for a fixed set of numbered participants, which detects misuse instead of blocking
+ *          forever.
+ *
+ *          Each participant calls arrive(participant, key), with a key describing what it is about to do. Once all
+ *          participants have arrived, all calls return. If a participant arrives twice within one round, if the keys of
+ *          the participants differ or if not all participants arrive within the timeout, all participants which
+ *          arrived in this round throw a Dune::InvalidStateException instead. Everything a participant wrote before
+ *          its arrive() is visible to all participants after their arrive().
+ */
+class CheckedBarrier
+{
+public:
+  CheckedBarrier(const size_t participants, const std::chrono::milliseconds timeout)
+    : participants_(participants)
+    , timeout_(timeout)
+    , generation_(0)
+    , count_(0)
+    , arrived_(participants, false)
+    , keys_(participants, 0)
+  {
+  }
+
+  CheckedBarrier(const CheckedBarrier& other) = delete;
+
+  CheckedBarrier& operator=(const CheckedBarrier& other) = delete;
+
+  size_t participants() const { return participants_; }
+
+  std::chrono::milliseconds timeout() const { return timeout_; }
+
+  void arrive(const size_t participant, const long key)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (participant >= participants_)
+      DUNE_THROW(Dune::RangeError,
+                 "there are only " << participants_ << " participants (" << participant << " given)!");
+    const size_t generation = generation_;
+    if (arrived_[participant]) {
+      std::stringstream msg;
+      msg << "participant " << participant << " arrived twice, the participants have to arrive concurrently, each "
+          << "from its own thread!";
+      release(msg.str());
+      DUNE_THROW(Dune::InvalidStateException, msg.str());
+    }
+    arrived_[participant] = true;
+    keys_[participant]    = key;
+    if (++count_ == participants_) {
+      std::string failure;
+      for (size_t pp = 1; pp < participants_; ++pp)
+        if (keys_[pp] != keys_[0]) {
+          std::stringstream msg;
+          msg << "participants 0 and " << pp << " arrived for different purposes (" << keys_[0] << " and "
+              << keys_[pp] << ")!";
+          failure = msg.str();
+          break;
+        }
+      release(failure);
+    } else if (!released_.wait_for(lock, timeout_, [&]() { return generation_ != generation; })) {
+      std::stringstream msg;
+      msg << "timed out after " << timeout_.count() << "ms waiting for participants";
+      for (size_t pp = 0; pp < participants_; ++pp)
+        if (!arrived_[pp])
+          msg << " " << pp;
+      msg << ", all participants have to arrive concurrently, each from its own thread!";
+      release(msg.str());
+    }
+    const auto failure = failures_.find(generation);
+    if (failure != failures_.end())
+      DUNE_THROW(Dune::InvalidStateException, failure->second);
+  } // ... arrive(...)
+
+private:
+  //! ends the current round, has to be called with the lock held
+  void release(const std::string& failure)
+  {
+    if (!failure.empty()) {
+      failures_[generation_] = failure;
+      // keep the failures of the last rounds only, for participants which did not wake up yet
+      while (failures_.size() > 16)
+        failures_.erase(failures_.begin());
+    }
+    std::fill(arrived_.begin(), arrived_.end(), false);
+    count_ = 0;
+    ++generation_;
+    released_.notify_all();
+  } // ... release(...)
+
+  const size_t participants_;
+  const std::chrono::milliseconds timeout_;
+  size_t generation_;
+  size_t count_;
+  std::vector<bool> arrived_;
+  std::vector<long> keys_;
+  std::map<size_t, std::string> failures_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+}; // class CheckedBarrier
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARALLEL_HH
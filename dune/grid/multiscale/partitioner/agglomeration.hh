@@ -0,0 +1,201 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_AGGLOMERATION_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_AGGLOMERATION_HH
+
+#include <map>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+//! the part of the boundary of a coarse element shared with one neighbor
+struct CoarseFace
+{
+  CoarseFace()
+    : neighbor(0)
+    , numIntersections(0)
+    , area(0)
+  {
+  }
+
+  size_t neighbor;
+  //! number of intersections of fine elements (counted from this side)
+  size_t numIntersections;
+  double area;
+}; // struct CoarseFace
+
+/**
+ *  \brief  A union of fine elements (e.g. a subdomain) as an element of a coarse grid: its volume, its center of mass,
+ *          the faces shared with its neighbors (sorted by neighbor) and the area it shares with the domain boundary.
+ */
+template <int dimWorld>
+struct CoarseElement
+{
+  CoarseElement()
+    : numElements(0)
+    , volume(0)
+    , center(0)
+    , boundaryArea(0)
+  {
+  }
+
+  size_t numElements;
+  double volume;
+  FieldVector<double, dimWorld> center;
+  std::vector<CoarseFace> faces;
+  double boundaryArea;
+}; // struct CoarseElement
+
+/**
+ *  \brief  Agglomerates the elements of gridPart with equal label into coarse elements, in one walk over the elements
+ *          and their intersections.
+ *  \param  labels the label of each element in the order of the walk, in [0, numParts)
+ */
+template <class GridPartType>
+std::vector<CoarseElement<GridPartType::GridType::dimensionworld>>
+agglomerate(const GridPartType& gridPart, const std::vector<size_t>& labels, const size_t numParts)
+{
+  static const int dimWorld     = GridPartType::GridType::dimensionworld;
+  static const unsigned int dim = GridPartType::GridType::dimension;
+  const auto& indexSet          = gridPart.indexSet();
+  // label of each element by index, with an offset per geometry type as in dual_graph()
+  std::vector<size_t> geometryTypeOffsets(GlobalGeometryTypeIndex::size(dim), 0);
+  size_t numElements = 0;
+  for (const auto& geometryType : indexSet.geomTypes(0)) {
+    geometryTypeOffsets[GlobalGeometryTypeIndex::index(geometryType)] = numElements;
+    numElements += indexSet.size(geometryType);
+  }
+  if (labels.size() != numElements)
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the grid part has " << numElements << " elements!");
+  const auto row = [&](const typename GridPartType::template Codim<0>::EntityType& element) {
+    return geometryTypeOffsets[GlobalGeometryTypeIndex::index(element.type())] + indexSet.index(element);
+  };
+  std::vector<size_t> labelsByRow(numElements);
+  size_t position  = 0;
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it, ++position) {
+    if (labels[position] >= numParts)
+      DUNE_THROW(Dune::RangeError, "label " << labels[position] << " of element " << position << " is too large!");
+    labelsByRow[row(*it)] = labels[position];
+  }
+  std::vector<CoarseElement<dimWorld>> coarse(numParts);
+  std::vector<std::map<size_t, CoarseFace>> faces(numParts);
+  position = 0;
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it, ++position) {
+    const auto& element = *it;
+    const auto geometry = element.geometry();
+    const double volume = geometry.volume();
+    const auto center   = geometry.center();
+    auto& coarseElement = coarse[labels[position]];
+    ++coarseElement.numElements;
+    coarseElement.volume += volume;
+    for (int dd = 0; dd < dimWorld; ++dd)
+      coarseElement.center[dd] += volume * center[dd];
+    const auto intersectionItEnd = gridPart.iend(element);
+    for (auto intersectionIt = gridPart.ibegin(element); intersectionIt != intersectionItEnd; ++intersectionIt) {
+      const auto& intersection = *intersectionIt;
+      if (intersection.neighbor()) {
+        const auto neighborPtr     = intersection.outside();
+        const size_t neighborLabel = labelsByRow[row(*neighborPtr)];
+        if (neighborLabel != labels[position]) {
+          CoarseFace& face = faces[labels[position]][neighborLabel];
+          face.neighbor    = neighborLabel;
+          ++face.numIntersections;
+          face.area += intersection.geometry().volume();
+        }
+      } else if (intersection.boundary())
+        coarseElement.boundaryArea += intersection.geometry().volume();
+    }
+  }
+  for (size_t pp = 0; pp < numParts; ++pp) {
+    if (coarse[pp].volume > 0)
+      coarse[pp].center /= coarse[pp].volume;
+    for (const auto& element : faces[pp])
+      coarse[pp].faces.push_back(element.second);
+  }
+  return coarse;
+} // ... agglomerate(...)
+
+/**
+ *  \brief  Agglomerates coarse elements further: fine[ii] becomes part of the coarse element parents[ii]. Costs are
+ *          proportional to the number of fine coarse elements and their faces, the grid is not touched.
+ */
+template <int dimWorld>
+std::vector<CoarseElement<dimWorld>> agglomerate(const std::vector<CoarseElement<dimWorld>>& fine,
+                                                 const std::vector<size_t>& parents, const size_t numParents)
+{
+  if (parents.size() != fine.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "parents has size " << parents.size() << ", there are " << fine.size() << " coarse elements!");
+  std::vector<CoarseElement<dimWorld>> coarse(numParents);
+  std::vector<std::map<size_t, CoarseFace>> faces(numParents);
+  for (size_t ii = 0; ii < fine.size(); ++ii) {
+    const size_t parent = parents[ii];
+    if (parent >= numParents)
+      DUNE_THROW(Dune::RangeError, "parent " << parent << " of coarse element " << ii << " is too large!");
+    auto& coarseElement = coarse[parent];
+    coarseElement.numElements += fine[ii].numElements;
+    coarseElement.volume += fine[ii].volume;
+    coarseElement.boundaryArea += fine[ii].boundaryArea;
+    for (int dd = 0; dd < dimWorld; ++dd)
+      coarseElement.center[dd] += fine[ii].volume * fine[ii].center[dd];
+    for (const CoarseFace& fineFace : fine[ii].faces) {
+      const size_t neighborParent = parents[fineFace.neighbor];
+      if (neighborParent == parent)
+        continue;
+      CoarseFace& face = faces[parent][neighborParent];
+      face.neighbor    = neighborParent;
+      face.numIntersections += fineFace.numIntersections;
+      face.area += fineFace.area;
+    }
+  }
+  for (size_t pp = 0; pp < numParents; ++pp) {
+    if (coarse[pp].volume > 0)
+      coarse[pp].center /= coarse[pp].volume;
+    for (const auto& element : faces[pp])
+      coarse[pp].faces.push_back(element.second);
+  }
+  return coarse;
+} // ... agglomerate(...)
+
+/**
+ *  \brief  The graph of coarse elements: vertex ii is coarse[ii] (weighted with its number of fine elements), two
+ *          vertices are connected if they share a face (weighted with its number of intersections).
+ */
+template <int dimWorld>
+Graph coarse_graph(const std::vector<CoarseElement<dimWorld>>& coarse)
+{
+  Graph graph;
+  graph.vertexWeights.resize(coarse.size());
+  graph.offsets.assign(coarse.size() + 1, 0);
+  for (size_t ii = 0; ii < coarse.size(); ++ii) {
+    graph.vertexWeights[ii] = double(coarse[ii].numElements);
+    for (const CoarseFace& face : coarse[ii].faces) {
+      graph.adjacency.push_back(face.neighbor);
+      graph.edgeWeights.push_back(double(face.numIntersections));
+    }
+    graph.offsets[ii + 1] = graph.adjacency.size();
+  }
+  return graph;
+} // ... coarse_graph(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_AGGLOMERATION_HH
@@ -0,0 +1,158 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_BALANCE_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_BALANCE_HH
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/refinement.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+//! what rebalance_partition() did
+struct BalanceStatistics
+{
+  BalanceStatistics()
+    : imbalanceBefore(1)
+    , imbalanceAfter(1)
+    , cutBefore(0)
+    , cutAfter(0)
+    , moves(0)
+  {
+  }
+
+  double imbalanceBefore;
+  double imbalanceAfter;
+  double cutBefore;
+  double cutAfter;
+  //! the number of vertices which changed their part
+  size_t moves;
+}; // struct BalanceStatistics
+
+/**
+ *  \brief  Moves boundary vertices from heavy to lighter neighboring parts until no part is heavier than
+ *          (1 + imbalance) * totalWeight / numParts, at most maxMoves vertices are moved.
+ *
+ *          In each pass, the boundary vertices of each overweight part (heaviest first) are moved by decreasing gain
+ *          in edge cut to the neighboring part they are most connected to, as long as that part stays lighter than the
+ *          one they leave. Load which can not be placed next to a heavy part thus diffuses through its neighbors in
+ *          the following passes. A vertex is never moved if its part would become empty or disconnected (see
+ *          internal::LocalConnectivity), so the parts stay connected if they were.
+ */
+inline BalanceStatistics rebalance_partition(const Graph& graph, std::vector<size_t>& labels, const size_t numParts,
+                                             const double imbalance = 0.05,
+                                             const size_t maxMoves = std::numeric_limits<size_t>::max(),
+                                             const size_t maxPasses = 64)
+{
+  if (labels.size() != graph.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the graph has " << graph.size() << " vertices!");
+  BalanceStatistics statistics;
+  statistics.cutBefore       = edge_cut(graph, labels);
+  statistics.cutAfter        = statistics.cutBefore;
+  statistics.imbalanceBefore = Partitioner::imbalance(graph, labels, numParts);
+  statistics.imbalanceAfter  = statistics.imbalanceBefore;
+  if (numParts < 2)
+    return statistics;
+  std::vector<double> weights = part_weights(graph, labels, numParts);
+  std::vector<size_t> sizes(numParts, 0);
+  for (const size_t label : labels)
+    ++sizes[label];
+  const double maxWeight = graph.totalWeight() / double(numParts) * (1.0 + imbalance);
+  internal::LocalConnectivity connectivity(graph);
+  std::vector<std::vector<size_t>> members(numParts);
+  std::vector<double> connection(numParts, 0.0);
+  std::vector<size_t> neighborParts;
+  // the most connected neighboring part of vv which is light enough, returns (gain, part), part is numParts if none
+  const auto bestMove = [&](const size_t vv) -> std::pair<double, size_t> {
+    const size_t own = labels[vv];
+    neighborParts.clear();
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+      const size_t part = labels[graph.adjacency[ii]];
+      if (connection[part] == 0.0 && part != own)
+        neighborParts.push_back(part);
+      connection[part] += graph.edgeWeights[ii];
+    }
+    std::pair<double, size_t> best(-std::numeric_limits<double>::max(), numParts);
+    for (const size_t part : neighborParts) {
+      // only moves which reduce the difference between the two parts
+      if (weights[part] + graph.vertexWeights[vv] >= weights[own])
+        continue;
+      const double gain = connection[part] - connection[own];
+      if (gain > best.first || (gain == best.first && weights[part] < weights[best.second]))
+        best = std::make_pair(gain, part);
+    }
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii)
+      connection[labels[graph.adjacency[ii]]] = 0.0;
+    return best;
+  };
+  std::vector<size_t> heavyParts;
+  std::vector<std::pair<double, size_t>> candidates;
+  for (size_t pass = 0; pass < maxPasses && statistics.moves < maxMoves; ++pass) {
+    heavyParts.clear();
+    for (size_t pp = 0; pp < numParts; ++pp)
+      if (weights[pp] > maxWeight)
+        heavyParts.push_back(pp);
+    if (heavyParts.empty())
+      break;
+    std::sort(heavyParts.begin(), heavyParts.end(), [&](const size_t left, const size_t right) {
+      return weights[left] > weights[right];
+    });
+    for (auto& part : members)
+      part.clear();
+    for (size_t vv = 0; vv < graph.size(); ++vv)
+      if (weights[labels[vv]] > maxWeight)
+        members[labels[vv]].push_back(vv);
+    size_t passMoves = 0;
+    for (const size_t heavy : heavyParts) {
+      candidates.clear();
+      for (const size_t vv : members[heavy]) {
+        const std::pair<double, size_t> move = bestMove(vv);
+        if (move.second < numParts)
+          candidates.push_back(std::make_pair(-move.first, vv));
+      }
+      std::sort(candidates.begin(), candidates.end());
+      for (const auto& candidate : candidates) {
+        if (weights[heavy] <= maxWeight || statistics.moves >= maxMoves)
+          break;
+        const size_t vv = candidate.second;
+        // earlier moves may have changed the gain or the weights
+        const std::pair<double, size_t> move = bestMove(vv);
+        if (move.second == numParts || sizes[heavy] == 1 || !connectivity.staysConnected(labels, vv))
+          continue;
+        labels[vv] = move.second;
+        weights[heavy] -= graph.vertexWeights[vv];
+        weights[move.second] += graph.vertexWeights[vv];
+        --sizes[heavy];
+        ++sizes[move.second];
+        statistics.cutAfter -= move.first;
+        ++statistics.moves;
+        ++passMoves;
+      }
+    }
+    if (passMoves == 0)
+      break;
+  } // for (size_t pass = 0; ...)
+  statistics.imbalanceAfter = Partitioner::imbalance(graph, labels, numParts);
+  return statistics;
+} // ... rebalance_partition(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_BALANCE_HH
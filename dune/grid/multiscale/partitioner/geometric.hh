@@ -0,0 +1,307 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_GEOMETRIC_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_GEOMETRIC_HH
+
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <mutex>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/grid/multiscale/parallel.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+//! the centers of the elements of gridPart, in the order of the walk from gridPart.begin< 0 >() to end< 0 >()
+template <class GridPartType>
+std::vector<FieldVector<double, GridPartType::GridType::dimensionworld>> element_centers(const GridPartType& gridPart)
+{
+  std::vector<FieldVector<double, GridPartType::GridType::dimensionworld>> centers;
+  centers.reserve(gridPart.indexSet().size(0));
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it) {
+    const auto center = it->geometry().center();
+    centers.emplace_back();
+    for (size_t dd = 0; dd < center.size(); ++dd)
+      centers.back()[dd] = center[dd];
+  }
+  return centers;
+} // ... element_centers(...)
+
+namespace internal {
+
+template <int dim>
+void check_input(const std::vector<FieldVector<double, dim>>& points, const std::vector<double>& weights,
+                 const size_t numParts)
+{
+  if (numParts == 0 || numParts > points.size())
+    DUNE_THROW(Dune::RangeError, "can not partition " << points.size() << " points into " << numParts << " parts!");
+  if (!weights.empty() && weights.size() != points.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "weights has size " << weights.size() << ", there are " << points.size() << " points!");
+} // ... check_input(...)
+
+//! a range of the permutation which still has to be split into numParts parts, labeled from firstLabel on
+struct BisectionRange
+{
+  size_t begin;
+  size_t end;
+  size_t numParts;
+  size_t firstLabel;
+};
+
+/**
+ *  \brief  Reorders permutation[begin, end) such that [begin, split) holds the points with the smallest coordinate dd
+ *          and has about the given weight, and returns split (in [begin + minLeft, end - minRight]).
+ *
+ *          A weighted quickselect: expected linear in end - begin.
+ */
+template <int dim>
+size_t weighted_split(const std::vector<FieldVector<double, dim>>& points, const std::vector<double>& weights,
+                      std::vector<size_t>& permutation, const size_t begin, const size_t end, const size_t dd,
+                      const double target, const size_t minLeft, const size_t minRight)
+{
+  const auto less   = [&](const size_t left, const size_t right) { return points[left][dd] < points[right][dd]; };
+  const auto weight = [&](const size_t point) { return weights.empty() ? 1.0 : weights[point]; };
+  size_t lo     = begin;
+  size_t hi     = end;
+  double before = 0; // the weight of [begin, lo)
+  while (hi - lo > 1) {
+    const size_t mid = lo + (hi - lo) / 2;
+    std::nth_element(permutation.begin() + lo, permutation.begin() + mid, permutation.begin() + hi, less);
+    double left = 0;
+    for (size_t ii = lo; ii < mid; ++ii)
+      left += weight(permutation[ii]);
+    if (before + left < target) {
+      before += left;
+      lo = mid;
+    } else
+      hi = mid;
+  }
+  size_t split = lo;
+  if (lo < end && (before + weight(permutation[lo]) - target) < (target - before))
+    ++split;
+  split = std::min(std::max(split, begin + minLeft), end - minRight);
+  std::nth_element(permutation.begin() + begin, permutation.begin() + split, permutation.begin() + end, less);
+  return split;
+} // ... weighted_split(...)
+
+template <int dim>
+void bisect(const std::vector<FieldVector<double, dim>>& points, const std::vector<double>& weights,
+            std::vector<size_t>& permutation, const BisectionRange& range, std::vector<BisectionRange>& children)
+{
+  // cut the longest extent of the bounding box
+  FieldVector<double, dim> lower(std::numeric_limits<double>::max());
+  FieldVector<double, dim> upper(std::numeric_limits<double>::lowest());
+  double total = 0;
+  for (size_t ii = range.begin; ii < range.end; ++ii) {
+    const auto& point = points[permutation[ii]];
+    for (size_t dd = 0; dd < size_t(dim); ++dd) {
+      lower[dd] = std::min(lower[dd], point[dd]);
+      upper[dd] = std::max(upper[dd], point[dd]);
+    }
+    total += weights.empty() ? 1.0 : weights[permutation[ii]];
+  }
+  size_t direction = 0;
+  for (size_t dd = 1; dd < size_t(dim); ++dd)
+    if (upper[dd] - lower[dd] > upper[direction] - lower[direction])
+      direction = dd;
+  const size_t numParts0 = range.numParts / 2;
+  const size_t numParts1 = range.numParts - numParts0;
+  const size_t split     = weighted_split(points,
+                                          weights,
+                                          permutation,
+                                          range.begin,
+                                          range.end,
+                                          direction,
+                                          total * double(numParts0) / double(range.numParts),
+                                          numParts0,
+                                          numParts1);
+  children.push_back(BisectionRange{range.begin, split, numParts0, range.firstLabel});
+  children.push_back(BisectionRange{split, range.end, numParts1, range.firstLabel + numParts0});
+} // ... bisect(...)
+
+//! rotates and reflects the coordinates (of bits bits each) into the transposed Hilbert index (J. Skilling, 2004)
+template <size_t dim>
+void axes_to_transpose(std::uint64_t (&xx)[dim], const unsigned int bits)
+{
+  const std::uint64_t mm = std::uint64_t(1) << (bits - 1);
+  // inverse undo
+  for (std::uint64_t qq = mm; qq > 1; qq >>= 1) {
+    const std::uint64_t pp = qq - 1;
+    for (size_t ii = 0; ii < dim; ++ii) {
+      if (xx[ii] & qq)
+        xx[0] ^= pp;
+      else {
+        const std::uint64_t tt = (xx[0] ^ xx[ii]) & pp;
+        xx[0] ^= tt;
+        xx[ii] ^= tt;
+      }
+    }
+  }
+  // Gray encode
+  for (size_t ii = 1; ii < dim; ++ii)
+    xx[ii] ^= xx[ii - 1];
+  std::uint64_t tt = 0;
+  for (std::uint64_t qq = mm; qq > 1; qq >>= 1)
+    if (xx[dim - 1] & qq)
+      tt ^= qq - 1;
+  for (size_t ii = 0; ii < dim; ++ii)
+    xx[ii] ^= tt;
+} // ... axes_to_transpose(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Recursive coordinate bisection: the points are recursively split at the weighted median of the longest
+ *          extent of their bounding box, into numParts parts of equal weight (up to the weight of one point).
+ *
+ *          Each split is a weighted quickselect, the ranges of one level of the recursion are split in parallel.
+ *  \param  weights one weight per point, all 1 if empty
+ *  \return the part of each point
+ */
+template <int dim>
+std::vector<size_t> recursive_coordinate_bisection(const std::vector<FieldVector<double, dim>>& points,
+                                                   const size_t numParts,
+                                                   const std::vector<double>& weights = std::vector<double>(),
+                                                   const size_t num_threads = 0)
+{
+  internal::check_input(points, weights, numParts);
+  std::vector<size_t> permutation(points.size());
+  std::iota(permutation.begin(), permutation.end(), size_t(0));
+  std::vector<internal::BisectionRange> ranges(1, internal::BisectionRange{0, points.size(), numParts, 0});
+  std::vector<internal::BisectionRange> finished;
+  while (!ranges.empty()) {
+    std::vector<std::vector<internal::BisectionRange>> children(ranges.size());
+    parallel_for(0,
+                 ranges.size(),
+                 [&](const size_t rr) { internal::bisect(points, weights, permutation, ranges[rr], children[rr]); },
+                 num_threads);
+    ranges.clear();
+    for (const auto& pair : children)
+      for (const auto& child : pair)
+        (child.numParts > 1 ? ranges : finished).push_back(child);
+  }
+  std::vector<size_t> labels(points.size(), 0);
+  for (const auto& range : finished)
+    for (size_t ii = range.begin; ii < range.end; ++ii)
+      labels[permutation[ii]] = range.firstLabel;
+  return labels;
+} // ... recursive_coordinate_bisection(...)
+
+/**
+ *  \brief  The position of each point along a Hilbert curve through the bounding box of all points (with as many bits
+ *          per coordinate as fit into 64 bits).
+ */
+template <int dim>
+std::vector<std::uint64_t> hilbert_keys(const std::vector<FieldVector<double, dim>>& points,
+                                        const size_t num_threads = 0)
+{
+  static_assert(dim > 0 && dim <= 64, "a Hilbert key has to fit into 64 bits!");
+  const unsigned int bits = std::min(64 / dim, 32);
+  FieldVector<double, dim> lower(std::numeric_limits<double>::max());
+  FieldVector<double, dim> upper(std::numeric_limits<double>::lowest());
+  for (const auto& point : points)
+    for (size_t dd = 0; dd < size_t(dim); ++dd) {
+      lower[dd] = std::min(lower[dd], point[dd]);
+      upper[dd] = std::max(upper[dd], point[dd]);
+    }
+  const double maxCoordinate = double((std::uint64_t(1) << bits) - 1);
+  std::vector<std::uint64_t> keys(points.size());
+  parallel_for(0,
+               points.size(),
+               [&](const size_t ii) {
+                 std::uint64_t xx[dim];
+                 for (size_t dd = 0; dd < size_t(dim); ++dd) {
+                   const double extent = upper[dd] - lower[dd];
+                   const double scaled = (extent > 0) ? (points[ii][dd] - lower[dd]) / extent : 0.0;
+                   xx[dd]              = std::uint64_t(std::floor(scaled * maxCoordinate));
+                 }
+                 if (dim > 1)
+                   internal::axes_to_transpose<dim>(xx, bits);
+                 // interleave the bits of the transposed index, most significant first
+                 std::uint64_t key = 0;
+                 for (unsigned int bb = bits; bb > 0; --bb)
+                   for (size_t dd = 0; dd < size_t(dim); ++dd)
+                     key = (key << 1) | ((xx[dd] >> (bb - 1)) & 1);
+                 keys[ii] = key;
+               },
+               num_threads);
+  return keys;
+} // ... hilbert_keys(...)
+
+/**
+ *  \brief  Orders the points along a Hilbert curve and cuts this ordering into numParts pieces of equal weight (up to
+ *          the weight of one point).
+ *
+ *          The keys are computed and sorted in parallel (chunks sorted by each thread, then merged).
+ *  \param  weights one weight per point, all 1 if empty
+ *  \return the part of each point
+ */
+template <int dim>
+std::vector<size_t> hilbert_partition(const std::vector<FieldVector<double, dim>>& points, const size_t numParts,
+                                      const std::vector<double>& weights = std::vector<double>(),
+                                      const size_t num_threads = 0)
+{
+  internal::check_input(points, weights, numParts);
+  const size_t size                     = points.size();
+  const std::vector<std::uint64_t> keys = hilbert_keys(points, num_threads);
+  std::vector<size_t> order(size);
+  std::iota(order.begin(), order.end(), size_t(0));
+  const auto less = [&](const size_t left, const size_t right) {
+    return keys[left] < keys[right] || (keys[left] == keys[right] && left < right);
+  };
+  std::vector<size_t> chunkEnds;
+  std::mutex mutex;
+  parallel_for_chunks(0,
+                      size,
+                      [&](const size_t chunkBegin, const size_t chunkEnd, const size_t /*thread*/) {
+                        std::sort(order.begin() + chunkBegin, order.begin() + chunkEnd, less);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        chunkEnds.push_back(chunkEnd);
+                      },
+                      num_threads);
+  std::sort(chunkEnds.begin(), chunkEnds.end());
+  for (size_t cc = 1; cc < chunkEnds.size(); ++cc)
+    std::inplace_merge(order.begin(), order.begin() + chunkEnds[cc - 1], order.begin() + chunkEnds[cc], less);
+  // cut where the prefix weight passes multiples of total / numParts, keeping each part non-empty
+  std::vector<double> prefix(size + 1, 0.0);
+  for (size_t ii = 0; ii < size; ++ii)
+    prefix[ii + 1] = prefix[ii] + (weights.empty() ? 1.0 : weights[order[ii]]);
+  std::vector<size_t> labels(size);
+  size_t begin = 0;
+  for (size_t pp = 0; pp < numParts; ++pp) {
+    size_t end = size;
+    if (pp + 1 < numParts) {
+      const double target = prefix[size] * double(pp + 1) / double(numParts);
+      end = size_t(std::lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin());
+      if (end > 0 && (target - prefix[end - 1]) < (prefix[end] - target))
+        --end;
+      end = std::min(std::max(end, begin + 1), size - (numParts - pp - 1));
+    }
+    for (size_t ii = begin; ii < end; ++ii)
+      labels[order[ii]] = pp;
+    begin = end;
+  }
+  return labels;
+} // ... hilbert_partition(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_GEOMETRIC_HH
@@ -0,0 +1,200 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_GRAPH_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_GRAPH_HH
+
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  A weighted undirected graph in compressed row storage: the neighbors of vertex vv are
+ *          adjacency[offsets[vv]] to adjacency[offsets[vv + 1] - 1] (without vv itself, each neighbor once), with
+ *          edge weights edgeWeights[offsets[vv]] to edgeWeights[offsets[vv + 1] - 1].
+ */
+struct Graph
+{
+  Graph()
+    : offsets(1, 0)
+  {
+  }
+
+  size_t size() const { return vertexWeights.size(); }
+
+  size_t degree(const size_t vertex) const { return offsets[vertex + 1] - offsets[vertex]; }
+
+  double totalWeight() const { return std::accumulate(vertexWeights.begin(), vertexWeights.end(), 0.0); }
+
+  std::vector<size_t> offsets;
+  std::vector<size_t> adjacency;
+  std::vector<double> edgeWeights;
+  std::vector<double> vertexWeights;
+}; // struct Graph
+
+/**
+ *  \brief  The dual graph of a grid part: vertex ii is the ii'th element of the walk from gridPart.begin< 0 >() to
+ *          gridPart.end< 0 >(), two vertices are connected if the elements share an intersection (with the number of
+ *          shared intersections as edge weight).
+ *
+ *          This is the numbering Factory::Default::add(subdomains) expects, so a labeling of the graph can be passed
+ *          on directly.
+ *  \param  weights the vertex weights (e.g. polynomial degree or coefficient cost per element), all 1 if empty
+ */
+template <class GridPartType>
+Graph dual_graph(const GridPartType& gridPart, const std::vector<double>& weights = std::vector<double>())
+{
+  static const unsigned int dimension = GridPartType::GridType::dimension;
+  const auto& indexSet = gridPart.indexSet();
+  // element -> walk position, with an offset per geometry type since indices are only unique per geometry type
+  std::vector<size_t> geometryTypeOffsets(GlobalGeometryTypeIndex::size(dimension), 0);
+  size_t numElements = 0;
+  for (const auto& geometryType : indexSet.geomTypes(0)) {
+    geometryTypeOffsets[GlobalGeometryTypeIndex::index(geometryType)] = numElements;
+    numElements += indexSet.size(geometryType);
+  }
+  if (!weights.empty() && weights.size() != numElements)
+    DUNE_THROW(Dune::InvalidStateException,
+               "weights has size " << weights.size() << ", there are " << numElements << " elements!");
+  const auto row = [&](const typename GridPartType::template Codim<0>::EntityType& element) {
+    return geometryTypeOffsets[GlobalGeometryTypeIndex::index(element.type())] + indexSet.index(element);
+  };
+  std::vector<size_t> positions(numElements, std::numeric_limits<size_t>::max());
+  size_t position = 0;
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it)
+    positions[row(*it)] = position++;
+  Graph graph;
+  graph.vertexWeights = weights.empty() ? std::vector<double>(position, 1.0) : weights;
+  graph.offsets.assign(position + 1, 0);
+  // collect the neighbors of each element, merging multiple intersections with the same neighbor
+  std::vector<size_t> neighbors;
+  position = 0;
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it, ++position) {
+    const auto& element = *it;
+    neighbors.clear();
+    const auto intersectionItEnd = gridPart.iend(element);
+    for (auto intersectionIt = gridPart.ibegin(element); intersectionIt != intersectionItEnd; ++intersectionIt) {
+      const auto& intersection = *intersectionIt;
+      if (intersection.neighbor()) {
+        const auto neighborPtr = intersection.outside();
+        neighbors.push_back(positions[row(*neighborPtr)]);
+      }
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    for (size_t ii = 0; ii < neighbors.size(); ++ii) {
+      if (ii > 0 && neighbors[ii] == neighbors[ii - 1])
+        graph.edgeWeights.back() += 1.0;
+      else {
+        graph.adjacency.push_back(neighbors[ii]);
+        graph.edgeWeights.push_back(1.0);
+      }
+    }
+    graph.offsets[position + 1] = graph.adjacency.size();
+  }
+  return graph;
+} // ... dual_graph(...)
+
+//! the sum of the weights of all edges between vertices with different labels
+inline double edge_cut(const Graph& graph, const std::vector<size_t>& labels)
+{
+  double cut = 0;
+  for (size_t vv = 0; vv < graph.size(); ++vv)
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii)
+      if (labels[graph.adjacency[ii]] != labels[vv])
+        cut += graph.edgeWeights[ii];
+  return cut / 2;
+} // ... edge_cut(...)
+
+//! the sum of the vertex weights of each part
+inline std::vector<double> part_weights(const Graph& graph, const std::vector<size_t>& labels, const size_t numParts)
+{
+  std::vector<double> weights(numParts, 0.0);
+  for (size_t vv = 0; vv < graph.size(); ++vv)
+    weights[labels[vv]] += graph.vertexWeights[vv];
+  return weights;
+}
+
+//! the weight of the heaviest part divided by the average weight of a part (1 for a perfectly balanced labeling)
+inline double imbalance(const Graph& graph, const std::vector<size_t>& labels, const size_t numParts)
+{
+  const std::vector<double> weights = part_weights(graph, labels, numParts);
+  const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+  if (total <= 0)
+    return 1.0;
+  return *std::max_element(weights.begin(), weights.end()) * double(numParts) / total;
+} // ... imbalance(...)
+
+//! the number of connected components of each part
+inline std::vector<size_t> components(const Graph& graph, const std::vector<size_t>& labels, const size_t numParts)
+{
+  std::vector<size_t> numComponents(numParts, 0);
+  std::vector<bool> visited(graph.size(), false);
+  std::vector<size_t> stack;
+  for (size_t root = 0; root < graph.size(); ++root) {
+    if (visited[root])
+      continue;
+    ++numComponents[labels[root]];
+    visited[root] = true;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const size_t vv = stack.back();
+      stack.pop_back();
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = graph.adjacency[ii];
+        if (!visited[neighbor] && labels[neighbor] == labels[root]) {
+          visited[neighbor] = true;
+          stack.push_back(neighbor);
+        }
+      }
+    }
+  }
+  return numComponents;
+} // ... components(...)
+
+/**
+ *  \brief  The subgraph induced by the given vertices (in the given order), i.e. vertex ii of the subgraph is vertex
+ *          vertices[ii] of the graph.
+ */
+inline Graph induced_subgraph(const Graph& graph, const std::vector<size_t>& vertices)
+{
+  std::vector<size_t> local(graph.size(), std::numeric_limits<size_t>::max());
+  for (size_t ii = 0; ii < vertices.size(); ++ii)
+    local[vertices[ii]] = ii;
+  Graph subgraph;
+  subgraph.vertexWeights.resize(vertices.size());
+  subgraph.offsets.assign(vertices.size() + 1, 0);
+  for (size_t ii = 0; ii < vertices.size(); ++ii) {
+    const size_t vv            = vertices[ii];
+    subgraph.vertexWeights[ii] = graph.vertexWeights[vv];
+    for (size_t jj = graph.offsets[vv]; jj < graph.offsets[vv + 1]; ++jj) {
+      const size_t neighbor = local[graph.adjacency[jj]];
+      if (neighbor != std::numeric_limits<size_t>::max()) {
+        subgraph.adjacency.push_back(neighbor);
+        subgraph.edgeWeights.push_back(graph.edgeWeights[jj]);
+      }
+    }
+    subgraph.offsets[ii + 1] = subgraph.adjacency.size();
+  }
+  return subgraph;
+} // ... induced_subgraph(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_GRAPH_HH
@@ -0,0 +1,266 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_LABELFILE_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_LABELFILE_HH
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/multiscale/partitioner/mappedfile.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  How the labels of a label file are ordered.
+ *
+ *          - index: one label per element, ordered by the index of the element in the index set of the grid part
+ *                   (elements of different geometry types one after the other, in the order of geomTypes(0))
+ *          - center_hash: pairs of a hash of the element center and the label, sorted by hash, so the file does not
+ *                   depend on the numbering of the elements (centers have to agree up to 1e-9)
+ */
+enum class LabelOrdering : std::uint32_t
+{
+  index       = 0,
+  center_hash = 1
+};
+
+/**
+ *  \brief  The header of a label file, followed by count entries (std::uint32_t labels for LabelOrdering::index,
+ *          HashedLabel for LabelOrdering::center_hash), all in native byte order. The checksum is the 64 bit FNV-1a
+ *          hash of the entries.
+ */
+struct LabelFileHeader
+{
+  static const std::uint32_t currentVersion = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t ordering;
+  std::uint64_t count;
+  std::uint64_t checksum;
+}; // struct LabelFileHeader
+
+struct HashedLabel
+{
+  std::uint64_t hash;
+  std::uint32_t label;
+  std::uint32_t padding;
+}; // struct HashedLabel
+
+namespace internal {
+
+static const char labelFileMagic[8] = {'D', 'G', 'M', 'L', 'A', 'B', 'E', 'L'};
+
+inline std::uint64_t fnv1a(const char* data, const size_t bytes,
+                           std::uint64_t hash = std::uint64_t(14695981039346656037ULL))
+{
+  for (size_t ii = 0; ii < bytes; ++ii) {
+    hash ^= std::uint64_t(static_cast<unsigned char>(data[ii]));
+    hash *= std::uint64_t(1099511628211ULL);
+  }
+  return hash;
+}
+
+template <class CoordinateType>
+std::uint64_t center_hash(const CoordinateType& center)
+{
+  std::uint64_t hash = fnv1a(nullptr, 0);
+  for (size_t dd = 0; dd < center.size(); ++dd) {
+    const std::int64_t rounded = std::llround(double(center[dd]) * 1e9);
+    hash                       = fnv1a(reinterpret_cast<const char*>(&rounded), sizeof(rounded), hash);
+  }
+  return hash;
+}
+
+//! the position of each element (in the order of the walk) in LabelOrdering::index
+template <class GridPartType>
+std::vector<size_t> index_positions(const GridPartType& gridPart)
+{
+  static const unsigned int dimension = GridPartType::GridType::dimension;
+  const auto& indexSet = gridPart.indexSet();
+  std::vector<size_t> geometryTypeOffsets(GlobalGeometryTypeIndex::size(dimension), 0);
+  size_t numElements = 0;
+  for (const auto& geometryType : indexSet.geomTypes(0)) {
+    geometryTypeOffsets[GlobalGeometryTypeIndex::index(geometryType)] = numElements;
+    numElements += indexSet.size(geometryType);
+  }
+  std::vector<size_t> positions;
+  positions.reserve(numElements);
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it)
+    positions.push_back(geometryTypeOffsets[GlobalGeometryTypeIndex::index(it->type())] + indexSet.index(*it));
+  return positions;
+} // ... index_positions(...)
+
+//! the hash of the center of each element, in the order of the walk
+template <class GridPartType>
+std::vector<std::uint64_t> center_hashes(const GridPartType& gridPart)
+{
+  std::vector<std::uint64_t> hashes;
+  hashes.reserve(gridPart.indexSet().size(0));
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it)
+    hashes.push_back(center_hash(it->geometry().center()));
+  return hashes;
+} // ... center_hashes(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Reads a label file (memory mapped), checking its header, size and checksum.
+ *  \return the label of each element of gridPart, in the order of the walk (as expected by Factory::Default::add())
+ */
+template <class GridPartType>
+std::vector<size_t> read_labels(const std::string& filename, const GridPartType& gridPart)
+{
+  const MappedFile file(filename);
+  file.adviseSequential();
+  if (file.size() < sizeof(LabelFileHeader))
+    DUNE_THROW(Dune::IOError, "'" << filename << "' is too small to be a label file!");
+  LabelFileHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, internal::labelFileMagic, sizeof(header.magic)) != 0)
+    DUNE_THROW(Dune::IOError, "'" << filename << "' is not a label file!");
+  if (header.version != LabelFileHeader::currentVersion)
+    DUNE_THROW(Dune::IOError,
+               "'" << filename << "' has version " << header.version << ", only version "
+                   << LabelFileHeader::currentVersion
+                   << " is supported!");
+  const size_t numElements = gridPart.indexSet().size(0);
+  if (header.count != numElements)
+    DUNE_THROW(Dune::IOError,
+               "'" << filename << "' contains " << header.count << " labels, the grid part has " << numElements
+                   << " elements!");
+  size_t entrySize = 0;
+  if (header.ordering == std::uint32_t(LabelOrdering::index))
+    entrySize = sizeof(std::uint32_t);
+  else if (header.ordering == std::uint32_t(LabelOrdering::center_hash))
+    entrySize = sizeof(HashedLabel);
+  else
+    DUNE_THROW(Dune::IOError, "'" << filename << "' has the unknown ordering " << header.ordering << "!");
+  const char* entries = file.data() + sizeof(LabelFileHeader);
+  if (file.size() != sizeof(LabelFileHeader) + numElements * entrySize)
+    DUNE_THROW(Dune::IOError,
+               "'" << filename << "' has " << file.size() << " bytes, expected "
+                   << sizeof(LabelFileHeader) + numElements * entrySize
+                   << "!");
+  if (internal::fnv1a(entries, numElements * entrySize) != header.checksum)
+    DUNE_THROW(Dune::IOError, "'" << filename << "' is corrupt (checksum mismatch)!");
+  std::vector<size_t> labels(numElements);
+  if (header.ordering == std::uint32_t(LabelOrdering::index)) {
+    const std::vector<size_t> positions = internal::index_positions(gridPart);
+    for (size_t ii = 0; ii < numElements; ++ii) {
+      std::uint32_t label;
+      std::memcpy(&label, entries + positions[ii] * entrySize, sizeof(label));
+      labels[ii] = label;
+    }
+  } else {
+    const std::vector<std::uint64_t> hashes = internal::center_hashes(gridPart);
+    const HashedLabel* begin                = reinterpret_cast<const HashedLabel*>(entries);
+    const HashedLabel* end                  = begin + numElements;
+    for (size_t ii = 0; ii < numElements; ++ii) {
+      const HashedLabel* entry = std::lower_bound(begin, end, hashes[ii], [](const HashedLabel& ll, std::uint64_t hh) {
+        return ll.hash < hh;
+      });
+      if (entry == end || entry->hash != hashes[ii])
+        DUNE_THROW(Dune::IOError,
+                   "'" << filename << "' contains no label for the center of element " << ii << " of the walk!");
+      labels[ii] = entry->label;
+    }
+  }
+  return labels;
+} // ... read_labels(...)
+
+/**
+ *  \brief  Writes a label file for the elements of gridPart.
+ *  \param  labels the label of each element, in the order of the walk
+ */
+template <class GridPartType>
+void write_labels(const std::string& filename, const GridPartType& gridPart, const std::vector<size_t>& labels,
+                  const LabelOrdering ordering = LabelOrdering::index)
+{
+  const size_t numElements = gridPart.indexSet().size(0);
+  if (labels.size() != numElements)
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the grid part has " << numElements << " elements!");
+  for (const size_t label : labels)
+    if (label > std::numeric_limits<std::uint32_t>::max())
+      DUNE_THROW(Dune::RangeError, "label " << label << " does not fit into a label file!");
+  std::vector<char> entries;
+  if (ordering == LabelOrdering::index) {
+    const std::vector<size_t> positions = internal::index_positions(gridPart);
+    std::vector<std::uint32_t> byIndex(numElements);
+    for (size_t ii = 0; ii < numElements; ++ii)
+      byIndex[positions[ii]] = std::uint32_t(labels[ii]);
+    entries.resize(numElements * sizeof(std::uint32_t));
+    std::memcpy(entries.data(), byIndex.data(), entries.size());
+  } else {
+    const std::vector<std::uint64_t> hashes = internal::center_hashes(gridPart);
+    std::vector<HashedLabel> byHash(numElements);
+    for (size_t ii = 0; ii < numElements; ++ii) {
+      byHash[ii].hash    = hashes[ii];
+      byHash[ii].label   = std::uint32_t(labels[ii]);
+      byHash[ii].padding = 0;
+    }
+    std::sort(byHash.begin(), byHash.end(), [](const HashedLabel& left, const HashedLabel& right) {
+      return left.hash < right.hash;
+    });
+    for (size_t ii = 1; ii < numElements; ++ii)
+      if (byHash[ii].hash == byHash[ii - 1].hash)
+        DUNE_THROW(Dune::InvalidStateException,
+                   "two elements have the same center hash, please use LabelOrdering::index!");
+    entries.resize(numElements * sizeof(HashedLabel));
+    std::memcpy(entries.data(), byHash.data(), entries.size());
+  }
+  LabelFileHeader header;
+  std::memcpy(header.magic, internal::labelFileMagic, sizeof(header.magic));
+  header.version  = LabelFileHeader::currentVersion;
+  header.ordering = std::uint32_t(ordering);
+  header.count    = numElements;
+  header.checksum = internal::fnv1a(entries.data(), entries.size());
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(entries.data(), std::streamsize(entries.size()));
+  if (!out)
+    DUNE_THROW(Dune::IOError, "could not write '" << filename << "'!");
+} // ... write_labels(...)
+
+/**
+ *  \brief  Writes the labeling of an existing multiscale grid, to be read again by read_labels() (e.g. by
+ *          Providers::LabelFile) with the same global grid.
+ */
+template <class MsGridType>
+void write_labels(const std::string& filename, const MsGridType& msGrid,
+                  const LabelOrdering ordering = LabelOrdering::index)
+{
+  const auto globalGridPart = msGrid.globalGridPart();
+  std::vector<size_t> labels;
+  labels.reserve(globalGridPart.indexSet().size(0));
+  const auto itEnd = globalGridPart.template end<0>();
+  for (auto it = globalGridPart.template begin<0>(); it != itEnd; ++it)
+    labels.push_back(msGrid.subdomainOf(*it));
+  write_labels(filename, globalGridPart, labels, ordering);
+} // ... write_labels(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_LABELFILE_HH
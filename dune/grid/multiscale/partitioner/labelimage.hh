@@ -0,0 +1,320 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_LABELIMAGE_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_LABELIMAGE_HH
+
+#include <set>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/version.hh>
+
+#include <dune/grid/multiscale/parallel.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/mappedfile.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  A memory mapped raw label volume: size[0] * size[1] * size[2] unsigned integer voxels of bytesPerVoxel
+ *          bytes each (native byte order, x running fastest), after headerBytes bytes of header. The image covers the
+ *          box [lowerLeft, upperRight], 2d images have size[2] = 1.
+ */
+class LabelImage
+{
+public:
+  LabelImage(const std::string& filename, const std::vector<size_t>& size, const FieldVector<double, 3>& lowerLeft,
+             const FieldVector<double, 3>& upperRight, const size_t bytesPerVoxel = 1, const size_t headerBytes = 0)
+    : file_(filename)
+    , lowerLeft_(lowerLeft)
+    , upperRight_(upperRight)
+    , bytesPerVoxel_(bytesPerVoxel)
+    , headerBytes_(headerBytes)
+  {
+    if (size.empty() || size.size() > 3)
+      DUNE_THROW(Dune::RangeError, "a label image has 1, 2 or 3 dimensions (size has " << size.size() << " entries)!");
+    if (bytesPerVoxel != 1 && bytesPerVoxel != 2 && bytesPerVoxel != 4 && bytesPerVoxel != 8)
+      DUNE_THROW(Dune::RangeError, "voxels have 1, 2, 4 or 8 bytes (not " << bytesPerVoxel << ")!");
+    for (size_t dd = 0; dd < 3; ++dd) {
+      size_[dd] = (dd < size.size()) ? size[dd] : 1;
+      if (size_[dd] == 0)
+        DUNE_THROW(Dune::RangeError, "the image is empty in direction " << dd << "!");
+    }
+    const size_t expected = headerBytes + size_[0] * size_[1] * size_[2] * bytesPerVoxel;
+    if (file_.size() != expected)
+      DUNE_THROW(Dune::IOError,
+                 "'" << filename << "' has " << file_.size() << " bytes, expected " << expected << " for a "
+                     << size_[0]
+                     << "x"
+                     << size_[1]
+                     << "x"
+                     << size_[2]
+                     << " image!");
+  } // LabelImage(...)
+
+  //! the label of the voxel containing point (points outside the image are clamped to it)
+  template <int dim>
+  std::uint64_t operator()(const FieldVector<double, dim>& point) const
+  {
+    size_t offset = 0;
+    size_t stride = 1;
+    for (size_t dd = 0; dd < 3; ++dd) {
+      size_t voxel = 0;
+      if (dd < size_t(dim) && upperRight_[dd] > lowerLeft_[dd]) {
+        const double relative = (point[dd] - lowerLeft_[dd]) / (upperRight_[dd] - lowerLeft_[dd]);
+        const double scaled   = std::floor(relative * double(size_[dd]));
+        voxel                 = (scaled <= 0) ? 0 : std::min(size_t(scaled), size_[dd] - 1);
+      }
+      offset += voxel * stride;
+      stride *= size_[dd];
+    }
+    const char* data = file_.data() + headerBytes_ + offset * bytesPerVoxel_;
+    switch (bytesPerVoxel_) {
+      case 1:
+        return std::uint64_t(static_cast<unsigned char>(*data));
+      case 2: {
+        std::uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      }
+      case 4: {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      }
+      default: {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      }
+    }
+  } // ... operator()(...)
+
+private:
+  const MappedFile file_;
+  size_t size_[3];
+  const FieldVector<double, 3> lowerLeft_;
+  const FieldVector<double, 3> upperRight_;
+  const size_t bytesPerVoxel_;
+  const size_t headerBytes_;
+}; // class LabelImage
+
+/**
+ *  \brief  Samples image for each element of gridPart: at the element center if subSamples is 1, else by majority vote
+ *          over subSamples^dim points (on a regular lattice in the reference cube, only those inside the reference
+ *          element for simplices).
+ *
+ *          The entity seeds are collected during the grid walk, the sample points are computed and the image is read in
+ *          parallel.
+ *  \return the image label of each element, in the order of the walk
+ */
+template <class GridPartType>
+std::vector<std::uint64_t> sample_label_image(const LabelImage& image, const GridPartType& gridPart,
+                                              const size_t subSamples = 1, const size_t num_threads = 0)
+{
+  typedef typename GridPartType::GridType GridType;
+  typedef typename GridType::template Codim<0>::EntitySeed EntitySeedType;
+  static const int dimension      = GridType::dimension;
+  static const int dimensionworld = GridType::dimensionworld;
+  typedef FieldVector<double, dimensionworld> PointType;
+  if (subSamples == 0)
+    DUNE_THROW(Dune::RangeError, "subSamples has to be positive!");
+  // the local sample points of cubes
+  std::vector<FieldVector<typename GridType::ctype, dimension>> lattice;
+  size_t latticeSize = 1;
+  for (int dd = 0; dd < dimension; ++dd)
+    latticeSize *= subSamples;
+  for (size_t ii = 0; ii < latticeSize; ++ii) {
+    FieldVector<typename GridType::ctype, dimension> local(0.0);
+    size_t rest = ii;
+    for (int dd = 0; dd < dimension; ++dd) {
+      local[dd] = (double(rest % subSamples) + 0.5) / double(subSamples);
+      rest /= subSamples;
+    }
+    lattice.push_back(local);
+  }
+  const GridType& grid = gridPart.grid();
+  std::vector<EntitySeedType> seeds;
+  seeds.reserve(gridPart.indexSet().size(0));
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it)
+    seeds.push_back(it->seed());
+  std::vector<std::uint64_t> labels(seeds.size());
+  parallel_for_chunks(0,
+                      seeds.size(),
+                      [&](const size_t chunkBegin, const size_t chunkEnd, const size_t /*thread*/) {
+                        std::vector<std::uint64_t> votes;
+                        PointType point;
+                        for (size_t ee = chunkBegin; ee < chunkEnd; ++ee) {
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 4)
+                          const auto entity = grid.entity(seeds[ee]);
+#else
+                          const auto entityPtr = grid.entityPointer(seeds[ee]);
+                          const auto& entity   = *entityPtr;
+#endif
+                          const auto geometry = entity.geometry();
+                          const bool simplex  = entity.type().isSimplex();
+                          votes.clear();
+                          if (subSamples > 1) {
+                            for (const auto& local : lattice) {
+                              double sum = 0;
+                              for (int dd = 0; dd < dimension; ++dd)
+                                sum += local[dd];
+                              if (simplex && sum > 1)
+                                continue;
+                              const auto global = geometry.global(local);
+                              for (int dd = 0; dd < dimensionworld; ++dd)
+                                point[dd] = global[dd];
+                              votes.push_back(image(point));
+                            }
+                          }
+                          if (votes.empty()) {
+                            // the center, or no lattice point inside the reference element
+                            const auto center = geometry.center();
+                            for (int dd = 0; dd < dimensionworld; ++dd)
+                              point[dd] = center[dd];
+                            votes.push_back(image(point));
+                          }
+                          // the most frequent label, the smallest one on ties
+                          std::sort(votes.begin(), votes.end());
+                          std::uint64_t best = votes[0];
+                          size_t bestCount   = 0;
+                          for (size_t vv = 0; vv < votes.size();) {
+                            size_t ww = vv;
+                            while (ww < votes.size() && votes[ww] == votes[vv])
+                              ++ww;
+                            if (ww - vv > bestCount) {
+                              best      = votes[vv];
+                              bestCount = ww - vv;
+                            }
+                            vv = ww;
+                          }
+                          labels[ee] = best;
+                        }
+                      },
+                      num_threads);
+  return labels;
+} // ... sample_label_image(...)
+
+/**
+ *  \brief  Splits the vertices of graph into connected regions of equal value.
+ *  \return the region of each vertex (numbered by their first vertex)
+ */
+inline std::vector<size_t> connected_regions(const Graph& graph, const std::vector<std::uint64_t>& values)
+{
+  const size_t unassigned = std::numeric_limits<size_t>::max();
+  std::vector<size_t> regions(graph.size(), unassigned);
+  std::vector<size_t> stack;
+  size_t numRegions = 0;
+  for (size_t root = 0; root < graph.size(); ++root) {
+    if (regions[root] != unassigned)
+      continue;
+    regions[root] = numRegions;
+    stack.push_back(root);
+    while (!stack.empty()) {
+      const size_t vv = stack.back();
+      stack.pop_back();
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = graph.adjacency[ii];
+        if (regions[neighbor] == unassigned && values[neighbor] == values[root]) {
+          regions[neighbor] = numRegions;
+          stack.push_back(neighbor);
+        }
+      }
+    }
+    ++numRegions;
+  }
+  return regions;
+} // ... connected_regions(...)
+
+/**
+ *  \brief  Merges each part with less than minSize vertices into the neighboring part it shares the heaviest edges with
+ *          (smallest parts first), parts without neighbors are kept.
+ *  \return the new labels, numbered contiguously from 0
+ */
+inline std::vector<size_t> merge_small_parts(const Graph& graph, const std::vector<size_t>& labels,
+                                             const size_t minSize)
+{
+  const size_t numParts = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+  std::vector<std::vector<size_t>> members(numParts);
+  for (size_t vv = 0; vv < labels.size(); ++vv)
+    members[labels[vv]].push_back(vv);
+  std::vector<size_t> parent(numParts);
+  for (size_t pp = 0; pp < numParts; ++pp)
+    parent[pp] = pp;
+  const auto find = [&](size_t pp) {
+    while (parent[pp] != pp) {
+      parent[pp] = parent[parent[pp]];
+      pp         = parent[pp];
+    }
+    return pp;
+  };
+  std::set<std::pair<size_t, size_t>> small;
+  for (size_t pp = 0; pp < numParts; ++pp)
+    if (!members[pp].empty() && members[pp].size() < minSize)
+      small.insert(std::make_pair(members[pp].size(), pp));
+  std::vector<double> connection(numParts, 0.0);
+  std::vector<size_t> neighborParts;
+  while (!small.empty()) {
+    const size_t pp = small.begin()->second;
+    small.erase(small.begin());
+    neighborParts.clear();
+    for (const size_t vv : members[pp])
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = find(labels[graph.adjacency[ii]]);
+        if (neighbor == pp)
+          continue;
+        if (connection[neighbor] == 0.0)
+          neighborParts.push_back(neighbor);
+        connection[neighbor] += graph.edgeWeights[ii];
+      }
+    if (neighborParts.empty())
+      continue;
+    size_t target = neighborParts[0];
+    for (const size_t neighbor : neighborParts) {
+      if (connection[neighbor] > connection[target])
+        target = neighbor;
+    }
+    for (const size_t neighbor : neighborParts)
+      connection[neighbor] = 0.0;
+    if (small.erase(std::make_pair(members[target].size(), target)) > 0
+        && members[target].size() + members[pp].size() < minSize)
+      small.insert(std::make_pair(members[target].size() + members[pp].size(), target));
+    parent[pp] = target;
+    members[target].insert(members[target].end(), members[pp].begin(), members[pp].end());
+    std::vector<size_t>().swap(members[pp]);
+  }
+  // number the remaining parts contiguously
+  const size_t unassigned = std::numeric_limits<size_t>::max();
+  std::vector<size_t> numbers(numParts, unassigned);
+  size_t numMerged = 0;
+  std::vector<size_t> merged(labels.size());
+  for (size_t vv = 0; vv < labels.size(); ++vv) {
+    const size_t root = find(labels[vv]);
+    if (numbers[root] == unassigned)
+      numbers[root] = numMerged++;
+    merged[vv] = numbers[root];
+  }
+  return merged;
+} // ... merge_small_parts(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_LABELIMAGE_HH
@@ -0,0 +1,92 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_MAPPEDFILE_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_MAPPEDFILE_HH
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dune/common/exceptions.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  A file mapped read-only into memory, so that only the pages actually touched are read (and the file may be
+ *          larger than the available memory).
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename)
+    : filename_(filename)
+    , data_(nullptr)
+    , size_(0)
+  {
+    const int descriptor = ::open(filename.c_str(), O_RDONLY);
+    if (descriptor < 0)
+      DUNE_THROW(Dune::IOError, "could not open '" << filename << "': " << std::strerror(errno) << "!");
+    struct stat status;
+    if (::fstat(descriptor, &status) != 0) {
+      ::close(descriptor);
+      DUNE_THROW(Dune::IOError, "could not stat '" << filename << "': " << std::strerror(errno) << "!");
+    }
+    size_ = size_t(status.st_size);
+    if (size_ > 0) {
+      void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, descriptor, 0);
+      if (mapped == MAP_FAILED) {
+        ::close(descriptor);
+        DUNE_THROW(Dune::IOError, "could not map '" << filename << "': " << std::strerror(errno) << "!");
+      }
+      data_ = static_cast<const char*>(mapped);
+    }
+    // the mapping stays valid after closing the file
+    ::close(descriptor);
+  } // MappedFile(...)
+
+  MappedFile(const MappedFile& other) = delete;
+
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  ~MappedFile()
+  {
+    if (data_ != nullptr)
+      ::munmap(const_cast<char*>(data_), size_);
+  }
+
+  const std::string& filename() const { return filename_; }
+
+  const char* data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  //! tells the kernel that the file will be read sequentially (a hint only, failures are ignored)
+  void adviseSequential() const
+  {
+    if (data_ != nullptr)
+      ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+  }
+
+private:
+  const std::string filename_;
+  const char* data_;
+  size_t size_;
+}; // class MappedFile
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_MAPPEDFILE_HH
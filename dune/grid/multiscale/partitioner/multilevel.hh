@@ -0,0 +1,424 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_MULTILEVEL_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_MULTILEVEL_HH
+
+#include <set>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <random>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/refinement.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+namespace internal {
+
+static const size_t unassigned = std::numeric_limits<size_t>::max();
+
+//! one level of a multilevel hierarchy: the coarse graph and the map from fine to coarse vertices
+struct CoarseLevel
+{
+  Graph graph;
+  std::vector<size_t> fineToCoarse;
+};
+
+/**
+ *  \brief  Contracts a heavy edge matching: each vertex (visited in random order) is matched with the unmatched
+ *          neighbor it shares the heaviest edge with.
+ */
+inline CoarseLevel contract_heavy_edge_matching(const Graph& graph, std::mt19937& random)
+{
+  const size_t size = graph.size();
+  std::vector<size_t> order(size);
+  std::iota(order.begin(), order.end(), size_t(0));
+  std::shuffle(order.begin(), order.end(), random);
+  std::vector<size_t> match(size, unassigned);
+  for (const size_t vv : order) {
+    if (match[vv] != unassigned)
+      continue;
+    size_t best       = vv;
+    double bestWeight = -1;
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+      const size_t neighbor = graph.adjacency[ii];
+      if (match[neighbor] == unassigned && graph.edgeWeights[ii] > bestWeight) {
+        best       = neighbor;
+        bestWeight = graph.edgeWeights[ii];
+      }
+    }
+    match[vv]   = best;
+    match[best] = vv;
+  }
+  CoarseLevel level;
+  level.fineToCoarse.assign(size, unassigned);
+  std::vector<size_t> members;
+  members.reserve(2 * size);
+  std::vector<size_t> memberOffsets(1, 0);
+  for (size_t vv = 0; vv < size; ++vv) {
+    if (level.fineToCoarse[vv] != unassigned)
+      continue;
+    const size_t coarse           = memberOffsets.size() - 1;
+    level.fineToCoarse[vv]        = coarse;
+    level.fineToCoarse[match[vv]] = coarse;
+    members.push_back(vv);
+    if (match[vv] != vv)
+      members.push_back(match[vv]);
+    memberOffsets.push_back(members.size());
+  }
+  const size_t coarseSize = memberOffsets.size() - 1;
+  Graph& coarseGraph      = level.graph;
+  coarseGraph.vertexWeights.assign(coarseSize, 0.0);
+  coarseGraph.offsets.assign(coarseSize + 1, 0);
+  // position[cc] is the position of the edge to cc in the current row, if marker[cc] is the current row
+  std::vector<size_t> marker(coarseSize, unassigned);
+  std::vector<size_t> position(coarseSize, 0);
+  for (size_t cc = 0; cc < coarseSize; ++cc) {
+    for (size_t mm = memberOffsets[cc]; mm < memberOffsets[cc + 1]; ++mm) {
+      const size_t vv = members[mm];
+      coarseGraph.vertexWeights[cc] += graph.vertexWeights[vv];
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = level.fineToCoarse[graph.adjacency[ii]];
+        if (neighbor == cc)
+          continue;
+        if (marker[neighbor] != cc) {
+          marker[neighbor]   = cc;
+          position[neighbor] = coarseGraph.adjacency.size();
+          coarseGraph.adjacency.push_back(neighbor);
+          coarseGraph.edgeWeights.push_back(graph.edgeWeights[ii]);
+        } else
+          coarseGraph.edgeWeights[position[neighbor]] += graph.edgeWeights[ii];
+      }
+    }
+    coarseGraph.offsets[cc + 1] = coarseGraph.adjacency.size();
+  }
+  return level;
+} // ... contract_heavy_edge_matching(...)
+
+//! by how much the weights of both sides exceed their maxima
+inline double overweight(const double weights[2], const double maxWeights[2])
+{
+  return std::max(0.0, weights[0] - maxWeights[0]) + std::max(0.0, weights[1] - maxWeights[1]);
+}
+
+/**
+ *  \brief  Fiduccia-Mattheyses refinement of a bisection: in each pass, vertices are moved (each at most once) in the
+ *          order of their gain in edge cut, as long as the balance constraint allows it, and the best intermediate
+ *          state is kept. Overweight sides are rebalanced first.
+ */
+inline void refine_bisection(const Graph& graph, std::vector<size_t>& side, const double maxWeights[2],
+                             const size_t maxPasses = 8)
+{
+  const size_t size = graph.size();
+  double weights[2] = {0.0, 0.0};
+  for (size_t vv = 0; vv < size; ++vv)
+    weights[side[vv]] += graph.vertexWeights[vv];
+  std::vector<double> gains(size);
+  std::vector<bool> locked(size);
+  std::vector<bool> queued(size);
+  std::vector<size_t> moves;
+  const size_t maxUselessMoves = 64 + size / 100;
+  for (size_t pass = 0; pass < maxPasses; ++pass) {
+    // gains and the boundary vertices of both sides, ordered by decreasing gain
+    std::set<std::pair<double, size_t>> queues[2];
+    std::fill(locked.begin(), locked.end(), false);
+    std::fill(queued.begin(), queued.end(), false);
+    for (size_t vv = 0; vv < size; ++vv) {
+      double gain     = 0;
+      bool isBoundary = false;
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        if (side[graph.adjacency[ii]] != side[vv]) {
+          gain += graph.edgeWeights[ii];
+          isBoundary = true;
+        } else
+          gain -= graph.edgeWeights[ii];
+      }
+      gains[vv] = gain;
+      if (isBoundary || overweight(weights, maxWeights) > 0) {
+        queues[side[vv]].insert(std::make_pair(-gain, vv));
+        queued[vv] = true;
+      }
+    }
+    moves.clear();
+    double delta          = 0;
+    double bestDelta      = 0;
+    double bestOverweight = overweight(weights, maxWeights);
+    size_t bestMoves      = 0;
+    while (moves.size() < bestMoves + maxUselessMoves) {
+      // choose the side to move from: overweight sides first, then the best feasible gain
+      size_t from = 2;
+      for (size_t ss = 0; ss < 2; ++ss) {
+        if (queues[ss].empty())
+          continue;
+        const size_t candidate = queues[ss].begin()->second;
+        const double newWeight = weights[1 - ss] + graph.vertexWeights[candidate];
+        const bool feasible    = newWeight <= maxWeights[1 - ss] || weights[ss] > maxWeights[ss];
+        if (!feasible)
+          continue;
+        if (from == 2 || weights[ss] > maxWeights[ss]
+            || (weights[from] <= maxWeights[from] && gains[candidate] > gains[queues[from].begin()->second]))
+          from = ss;
+      }
+      if (from == 2)
+        break;
+      const size_t vv = queues[from].begin()->second;
+      queues[from].erase(queues[from].begin());
+      queued[vv] = false;
+      locked[vv] = true;
+      // move it
+      const size_t to = 1 - from;
+      side[vv]        = to;
+      weights[from] -= graph.vertexWeights[vv];
+      weights[to] += graph.vertexWeights[vv];
+      delta -= gains[vv];
+      moves.push_back(vv);
+      const double currentOverweight = overweight(weights, maxWeights);
+      if (currentOverweight < bestOverweight - 1e-12
+          || (currentOverweight <= bestOverweight + 1e-12 && delta < bestDelta - 1e-12)) {
+        bestOverweight = currentOverweight;
+        bestDelta      = delta;
+        bestMoves      = moves.size();
+      }
+      // update the gains of the neighbors
+      for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = graph.adjacency[ii];
+        if (locked[neighbor])
+          continue;
+        if (queued[neighbor])
+          queues[side[neighbor]].erase(std::make_pair(-gains[neighbor], neighbor));
+        gains[neighbor] += (side[neighbor] == to ? -2.0 : 2.0) * graph.edgeWeights[ii];
+        queues[side[neighbor]].insert(std::make_pair(-gains[neighbor], neighbor));
+        queued[neighbor] = true;
+      }
+    } // while (moves.size() < bestMoves + maxUselessMoves)
+    // roll back to the best state
+    for (size_t mm = moves.size(); mm > bestMoves; --mm) {
+      const size_t vv = moves[mm - 1];
+      weights[side[vv]] -= graph.vertexWeights[vv];
+      side[vv] = 1 - side[vv];
+      weights[side[vv]] += graph.vertexWeights[vv];
+    }
+    if (bestMoves == 0)
+      break;
+  } // for (size_t pass = 0; pass < maxPasses; ++pass)
+} // ... refine_bisection(...)
+
+/**
+ *  \brief  Greedy graph growing: side 0 is grown from a random vertex, always adding the frontier vertex which
+ *          increases the edge cut the least, until it reaches its target weight.
+ */
+inline std::vector<size_t> grow_bisection(const Graph& graph, const double targetWeight, std::mt19937& random)
+{
+  const size_t size = graph.size();
+  std::vector<size_t> side(size, 1);
+  std::vector<double> gains(size, 0.0);
+  std::vector<bool> queued(size, false);
+  std::set<std::pair<double, size_t>> frontier;
+  std::uniform_int_distribution<size_t> distribution(0, size - 1);
+  double weight = 0;
+  size_t grown  = 0;
+  while (weight < targetWeight && grown < size) {
+    size_t vv;
+    if (frontier.empty()) {
+      // start (or continue in another component) at a random vertex of side 1
+      vv = distribution(random);
+      while (side[vv] == 0)
+        vv = (vv + 1) % size;
+    } else {
+      vv = frontier.begin()->second;
+      frontier.erase(frontier.begin());
+      queued[vv] = false;
+    }
+    if (grown > 0 && weight + graph.vertexWeights[vv] > targetWeight
+        && (weight + graph.vertexWeights[vv] - targetWeight) > (targetWeight - weight))
+      break;
+    side[vv] = 0;
+    weight += graph.vertexWeights[vv];
+    ++grown;
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+      const size_t neighbor = graph.adjacency[ii];
+      if (side[neighbor] == 0)
+        continue;
+      if (queued[neighbor])
+        frontier.erase(std::make_pair(-gains[neighbor], neighbor));
+      gains[neighbor] += 2.0 * graph.edgeWeights[ii];
+      frontier.insert(std::make_pair(-gains[neighbor], neighbor));
+      queued[neighbor] = true;
+    }
+  }
+  return side;
+} // ... grow_bisection(...)
+
+/**
+ *  \brief  Multilevel bisection of graph into two sides of weight fraction and (1 - fraction) of the total weight,
+ *          each allowed to exceed its target by the factor (1 + imbalance).
+ */
+inline std::vector<size_t> multilevel_bisection(const Graph& graph, const double fraction, const double imbalance,
+                                                std::mt19937& random, const size_t coarsestSize = 128,
+                                                const size_t initialTries = 4)
+{
+  // coarsen
+  std::vector<CoarseLevel> levels;
+  while (true) {
+    const Graph& current = levels.empty() ? graph : levels.back().graph;
+    if (current.size() <= coarsestSize)
+      break;
+    CoarseLevel level = contract_heavy_edge_matching(current, random);
+    if (double(level.graph.size()) > 0.95 * double(current.size()))
+      break;
+    levels.push_back(std::move(level));
+  }
+  const double totalWeight   = graph.totalWeight();
+  const double maxWeights[2] = {fraction * totalWeight * (1.0 + imbalance),
+                                (1.0 - fraction) * totalWeight * (1.0 + imbalance)};
+  // initial bisection of the coarsest graph, the best of several tries
+  const Graph& coarsest = levels.empty() ? graph : levels.back().graph;
+  std::vector<size_t> side;
+  double bestCut = std::numeric_limits<double>::max();
+  for (size_t tt = 0; tt < initialTries; ++tt) {
+    std::vector<size_t> candidate = grow_bisection(coarsest, fraction * totalWeight, random);
+    refine_bisection(coarsest, candidate, maxWeights);
+    double weights[2] = {0.0, 0.0};
+    for (size_t vv = 0; vv < coarsest.size(); ++vv)
+      weights[candidate[vv]] += coarsest.vertexWeights[vv];
+    // prefer balanced bisections, then small cuts
+    const double cut = edge_cut(coarsest, candidate) + overweight(weights, maxWeights) * totalWeight;
+    if (cut < bestCut) {
+      bestCut = cut;
+      side.swap(candidate);
+    }
+  }
+  // uncoarsen, refining on each level
+  for (size_t ll = levels.size(); ll > 0; --ll) {
+    const Graph& finer = (ll > 1) ? levels[ll - 2].graph : graph;
+    const std::vector<size_t>& fineToCoarse = levels[ll - 1].fineToCoarse;
+    std::vector<size_t> fineSide(finer.size());
+    for (size_t vv = 0; vv < finer.size(); ++vv)
+      fineSide[vv] = side[fineToCoarse[vv]];
+    refine_bisection(finer, fineSide, maxWeights);
+    side.swap(fineSide);
+  }
+  return side;
+} // ... multilevel_bisection(...)
+
+/**
+ *  \brief  Makes sure that each side has at least the given number of vertices, by moving vertices from the other side.
+ *
+ *          A side which is too small is grown along the edges of graph (breadth first, starting from its own vertices),
+ *          so that it does not fall apart. Only if it has no neighbors left (e.g. if it is empty or graph is not
+ *          connected) the first vertex of the other side is taken.
+ */
+inline void ensure_side_sizes(const Graph& graph, std::vector<size_t>& side, const size_t minSizes[2])
+{
+  size_t sizes[2] = {0, 0};
+  for (const size_t ss : side)
+    ++sizes[ss];
+  for (size_t ss = 0; ss < 2; ++ss) {
+    if (sizes[ss] >= minSizes[ss])
+      continue;
+    std::vector<size_t> grown;
+    for (size_t vv = 0; vv < side.size(); ++vv)
+      if (side[vv] == ss)
+        grown.push_back(vv);
+    // grown[next] is the first vertex of side ss which may still have neighbors on the other side
+    size_t next = 0;
+    while (sizes[ss] < minSizes[ss] && sizes[1 - ss] > minSizes[1 - ss]) {
+      size_t vv = unassigned;
+      for (; next < grown.size() && vv == unassigned; ++next)
+        for (size_t ii = graph.offsets[grown[next]]; ii < graph.offsets[grown[next] + 1]; ++ii)
+          if (side[graph.adjacency[ii]] != ss) {
+            vv = graph.adjacency[ii];
+            break;
+          }
+      if (vv != unassigned)
+        --next; // grown[next] may have further neighbors on the other side
+      else
+        vv = std::find_if(side.begin(), side.end(), [&](const size_t sd) { return sd != ss; }) - side.begin();
+      side[vv] = ss;
+      ++sizes[ss];
+      --sizes[1 - ss];
+      grown.push_back(vv);
+    }
+  }
+} // ... ensure_side_sizes(...)
+
+inline void recursive_bisection(const Graph& graph, const std::vector<size_t>& vertices, const size_t numParts,
+                                const size_t firstLabel, const double imbalance, std::mt19937& random,
+                                std::vector<size_t>& labels)
+{
+  if (numParts == 1) {
+    for (const size_t vv : vertices)
+      labels[vv] = firstLabel;
+    return;
+  }
+  const size_t numParts0   = numParts / 2;
+  std::vector<size_t> side = multilevel_bisection(graph, double(numParts0) / double(numParts), imbalance, random);
+  const size_t minSizes[2] = {numParts0, numParts - numParts0};
+  ensure_side_sizes(graph, side, minSizes);
+  for (size_t ss = 0; ss < 2; ++ss) {
+    std::vector<size_t> subVertices;
+    std::vector<size_t> globalVertices;
+    for (size_t vv = 0; vv < graph.size(); ++vv)
+      if (side[vv] == ss) {
+        subVertices.push_back(vv);
+        globalVertices.push_back(vertices[vv]);
+      }
+    recursive_bisection(induced_subgraph(graph, subVertices),
+                        globalVertices,
+                        ss == 0 ? numParts0 : numParts - numParts0,
+                        ss == 0 ? firstLabel : firstLabel + numParts0,
+                        imbalance,
+                        random,
+                        labels);
+  }
+} // ... recursive_bisection(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Partitions the vertices of graph into numParts parts of (up to the factor 1 + imbalance) equal weight with a
+ *          small edge cut, by multilevel recursive bisection.
+ *
+ *          Each bisection coarsens the graph by contracting heavy edge matchings, bisects the coarsest graph by greedy
+ *          graph growing and projects the bisection back, refining it on each level by Fiduccia-Mattheyses boundary
+ *          refinement. Finally, the k-way labeling is refined as a whole by refine_partition(), which may move
+ *          vertices across the interfaces of different bisections but never disconnects a part. Connected parts are
+ *          not guaranteed, though: a bisection may split a connected graph into a disconnected side. The result is
+ *          deterministic for a given seed (and standard library).
+ *  \return the part of each vertex
+ */
+inline std::vector<size_t> multilevel_partition(const Graph& graph, const size_t numParts,
+                                                const double imbalance = 0.03, const unsigned int seed = 0)
+{
+  if (numParts == 0 || numParts > graph.size())
+    DUNE_THROW(Dune::RangeError,
+               "can not partition a graph with " << graph.size() << " vertices into " << numParts << " parts!");
+  std::mt19937 random(seed);
+  // the imbalance compounds over the levels of the recursion
+  const double levels         = std::ceil(std::log2(double(numParts)));
+  const double levelImbalance = (levels > 0) ? std::pow(1.0 + imbalance, 1.0 / levels) - 1.0 : imbalance;
+  std::vector<size_t> labels(graph.size(), 0);
+  std::vector<size_t> vertices(graph.size());
+  std::iota(vertices.begin(), vertices.end(), size_t(0));
+  internal::recursive_bisection(graph, vertices, numParts, 0, levelImbalance, random, labels);
+  refine_partition(graph, labels, numParts, imbalance);
+  return labels;
+} // ... multilevel_partition(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_MULTILEVEL_HH
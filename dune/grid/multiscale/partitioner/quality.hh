@@ -0,0 +1,382 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_QUALITY_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_QUALITY_HH
+
+#include <map>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/multiscale/default.hh>
+#include <dune/grid/multiscale/provider/interface.hh>
+
+#include "graph.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  Quality measures of a labeling of the dual graph, see quality().
+ *
+ *          Interfaces are measured in edge weight, i.e. in shared faces for a graph from dual_graph(). The aspect ratio
+ *          of a part is the ratio of the longest to the shortest side of the bounding box of its element centers
+ *          (widened by the mean element width of the part), 1 for a cube. The oversampling overhead is the number of
+ *          elements in all oversampled parts divided by the number of elements, minus one.
+ */
+struct Quality
+{
+  Quality()
+    : numParts(0)
+    , numElements(0)
+    , edgeCut(0)
+    , maxInterface(0)
+    , averageInterface(0)
+    , imbalance(1)
+    , maxNeighbors(0)
+    , averageNeighbors(0)
+    , maxAspectRatio(1)
+    , averageAspectRatio(1)
+    , oversamplingOverhead(0)
+  {
+  }
+
+  size_t numParts;
+  size_t numElements;
+  double edgeCut;
+  double maxInterface;
+  double averageInterface;
+  double imbalance;
+  size_t maxNeighbors;
+  double averageNeighbors;
+  double maxAspectRatio;
+  double averageAspectRatio;
+  double oversamplingOverhead;
+}; // struct Quality
+
+/**
+ *  \brief  The size of each interface: result[pp][nn] is the weight of all edges between parts pp and nn (so each
+ *          interface is contained twice and result[pp].size() is the number of neighbors of pp).
+ */
+inline std::vector<std::map<size_t, double>> interface_sizes(const Graph& graph, const std::vector<size_t>& labels,
+                                                             const size_t numParts)
+{
+  std::vector<std::map<size_t, double>> interfaces(numParts);
+  for (size_t vv = 0; vv < graph.size(); ++vv)
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii)
+      if (labels[graph.adjacency[ii]] != labels[vv])
+        interfaces[labels[vv]][labels[graph.adjacency[ii]]] += graph.edgeWeights[ii];
+  return interfaces;
+} // ... interface_sizes(...)
+
+/**
+ *  \brief  The number of vertices of each part after adding numLayers layers of graph neighbors.
+ *
+ *          The factory oversamples across vertices (see Factory::NeighborRecursionLevel), the dual graph only connects
+ *          elements sharing a face, so for a graph from dual_graph() this is a lower bound of the actual sizes.
+ */
+inline std::vector<size_t> oversampled_sizes(const Graph& graph, const std::vector<size_t>& labels,
+                                             const size_t numParts, const size_t numLayers)
+{
+  std::vector<std::vector<size_t>> members(numParts);
+  for (size_t vv = 0; vv < graph.size(); ++vv)
+    members[labels[vv]].push_back(vv);
+  std::vector<size_t> sizes(numParts, 0);
+  std::vector<size_t> marker(graph.size(), std::numeric_limits<size_t>::max());
+  std::vector<size_t> layer;
+  std::vector<size_t> nextLayer;
+  for (size_t pp = 0; pp < numParts; ++pp) {
+    layer = members[pp];
+    for (const size_t vv : layer)
+      marker[vv] = pp;
+    sizes[pp] = layer.size();
+    for (size_t ll = 0; ll < numLayers && !layer.empty(); ++ll) {
+      nextLayer.clear();
+      for (const size_t vv : layer)
+        for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii)
+          if (marker[graph.adjacency[ii]] != pp) {
+            marker[graph.adjacency[ii]] = pp;
+            nextLayer.push_back(graph.adjacency[ii]);
+          }
+      sizes[pp] += nextLayer.size();
+      std::swap(layer, nextLayer);
+    }
+  }
+  return sizes;
+} // ... oversampled_sizes(...)
+
+//! the aspect ratio of each part (1 for empty parts), see Quality
+template <int dimWorld>
+std::vector<double> aspect_ratios(const std::vector<size_t>& labels, const size_t numParts,
+                                  const std::vector<FieldVector<double, dimWorld>>& centers,
+                                  const std::vector<double>& volumes)
+{
+  if (centers.size() != labels.size() || volumes.size() != labels.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "centers has size " << centers.size() << ", volumes has size " << volumes.size() << ", there are "
+                                   << labels.size()
+                                   << " elements!");
+  typedef FieldVector<double, dimWorld> PointType;
+  std::vector<PointType> lower(numParts, PointType(std::numeric_limits<double>::max()));
+  std::vector<PointType> upper(numParts, PointType(std::numeric_limits<double>::lowest()));
+  std::vector<double> partVolumes(numParts, 0.0);
+  std::vector<size_t> partSizes(numParts, 0);
+  for (size_t ee = 0; ee < labels.size(); ++ee) {
+    const size_t pp = labels[ee];
+    for (int dd = 0; dd < dimWorld; ++dd) {
+      lower[pp][dd] = std::min(lower[pp][dd], centers[ee][dd]);
+      upper[pp][dd] = std::max(upper[pp][dd], centers[ee][dd]);
+    }
+    partVolumes[pp] += volumes[ee];
+    ++partSizes[pp];
+  }
+  std::vector<double> ratios(numParts, 1.0);
+  for (size_t pp = 0; pp < numParts; ++pp) {
+    if (partSizes[pp] == 0)
+      continue;
+    // the centers of a layer of elements span nothing in its normal direction, so add the width of an element
+    const double width = std::pow(partVolumes[pp] / double(partSizes[pp]), 1.0 / double(dimWorld));
+    double shortest    = std::numeric_limits<double>::max();
+    double longest     = 0;
+    for (int dd = 0; dd < dimWorld; ++dd) {
+      shortest = std::min(shortest, upper[pp][dd] - lower[pp][dd] + width);
+      longest  = std::max(longest, upper[pp][dd] - lower[pp][dd] + width);
+    }
+    if (shortest > 0)
+      ratios[pp] = longest / shortest;
+  }
+  return ratios;
+} // ... aspect_ratios(...)
+
+namespace internal {
+
+//! quality() for the given interface sizes (see interface_sizes()), from which the edge cut is derived, too
+template <int dimWorld>
+Quality quality(const Graph& graph, const std::vector<size_t>& labels, const size_t numParts,
+                const std::vector<std::map<size_t, double>>& interfaces,
+                const std::vector<FieldVector<double, dimWorld>>& centers, const std::vector<double>& volumes,
+                const size_t numLayers)
+{
+  if (labels.size() != graph.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the graph has " << graph.size() << " vertices!");
+  Quality result;
+  result.numParts    = numParts;
+  result.numElements = graph.size();
+  if (numParts == 0 || graph.size() == 0)
+    return result;
+  result.imbalance     = imbalance(graph, labels, numParts);
+  size_t numInterfaces = 0;
+  for (size_t pp = 0; pp < numParts; ++pp) {
+    result.maxNeighbors = std::max(result.maxNeighbors, interfaces[pp].size());
+    numInterfaces += interfaces[pp].size();
+    for (const auto& element : interfaces[pp]) {
+      result.maxInterface = std::max(result.maxInterface, element.second);
+      result.edgeCut += element.second;
+    }
+  }
+  // each interface is contained twice
+  result.edgeCut /= 2.0;
+  result.averageNeighbors = double(numInterfaces) / double(numParts);
+  result.averageInterface = numInterfaces > 0 ? 2.0 * result.edgeCut / double(numInterfaces) : 0.0;
+  const std::vector<double> ratios = aspect_ratios(labels, numParts, centers, volumes);
+  result.maxAspectRatio            = *std::max_element(ratios.begin(), ratios.end());
+  result.averageAspectRatio        = std::accumulate(ratios.begin(), ratios.end(), 0.0) / double(numParts);
+  const std::vector<size_t> sizes  = oversampled_sizes(graph, labels, numParts, numLayers);
+  result.oversamplingOverhead =
+      double(std::accumulate(sizes.begin(), sizes.end(), size_t(0))) / double(graph.size()) - 1.0;
+  return result;
+} // ... quality(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Computes all measures of Quality from the dual graph and per element data, without touching the grid.
+ *  \param  centers   the center of each element in the numbering of the graph (e.g. from element_centers())
+ *  \param  volumes   the volume of each element in the numbering of the graph
+ *  \param  numLayers the oversampling layers for the estimated oversampling overhead, see oversampled_sizes()
+ */
+template <int dimWorld>
+Quality quality(const Graph& graph, const std::vector<size_t>& labels, const size_t numParts,
+                const std::vector<FieldVector<double, dimWorld>>& centers, const std::vector<double>& volumes,
+                const size_t numLayers = 1)
+{
+  if (labels.size() != graph.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the graph has " << graph.size() << " vertices!");
+  return internal::quality(
+      graph, labels, numParts, interface_sizes(graph, labels, numParts), centers, volumes, numLayers);
+} // ... quality(...)
+
+#if HAVE_DUNE_FEM
+
+namespace internal {
+
+/**
+ *  \brief  The dual graph of the global grid part of a multiscale grid together with the subdomain, the center and the
+ *          volume of each element, all numbered by element row (the index in the global index set, offset per
+ *          geometry type as in FaceTable), and the interface sizes (see interface_sizes()). Computed in one walk over
+ *          the elements and their intersections.
+ *
+ *          If the multiscale grid has a face table, the interfaces are counted from its coupling faces (and from the
+ *          intersections of mixed faces only), so they agree with what the multiscale grid couples.
+ */
+template <class GridType>
+struct ElementData
+{
+  static const int dimWorld = GridType::dimensionworld;
+  typedef typename Default<GridType>::FaceTableType FaceTableType;
+
+  explicit ElementData(const Default<GridType>& msGrid)
+  {
+    static const unsigned int dim = GridType::dimension;
+    const auto globalGridPart     = msGrid.globalGridPart();
+    const auto& indexSet          = globalGridPart.indexSet();
+    std::vector<size_t> geometryTypeOffsets(GlobalGeometryTypeIndex::size(dim), 0);
+    size_t numElements = 0;
+    for (const auto& geometryType : indexSet.geomTypes(0)) {
+      geometryTypeOffsets[GlobalGeometryTypeIndex::index(geometryType)] = numElements;
+      numElements += indexSet.size(geometryType);
+    }
+    const auto row = [&](const typename Default<GridType>::EntityType& element) {
+      return geometryTypeOffsets[GlobalGeometryTypeIndex::index(element.type())] + indexSet.index(element);
+    };
+    const bool hasFaceTable = msGrid.hasFaceTable();
+    labels.resize(numElements);
+    if (hasFaceTable)
+      interfaces.resize(msGrid.size());
+    centers.resize(numElements);
+    volumes.resize(numElements);
+    graph.vertexWeights.assign(numElements, 1.0);
+    graph.offsets.assign(numElements + 1, 0);
+    // the neighbors of each element in the order of the walk, sorted by row afterwards
+    std::vector<size_t> walkRows;
+    std::vector<size_t> walkNeighbors;
+    std::vector<double> walkWeights;
+    walkRows.reserve(numElements);
+    std::vector<size_t> neighbors;
+    const auto itEnd = globalGridPart.template end<0>();
+    for (auto it = globalGridPart.template begin<0>(); it != itEnd; ++it) {
+      const auto& element = *it;
+      const size_t ee     = row(element);
+      const auto geometry = element.geometry();
+      const auto center   = geometry.center();
+      // the face table has the subdomain of each row at hand, subdomainOf() searches a map
+      labels[ee]  = msGrid.hasFaceTable() ? msGrid.faceTable().subdomain(ee) : msGrid.subdomainOf(element);
+      volumes[ee] = geometry.volume();
+      for (int dd = 0; dd < dimWorld; ++dd)
+        centers[ee][dd] = center[dd];
+      if (hasFaceTable) {
+        const auto& faceTable = msGrid.faceTable();
+        for (size_t ff = 0; ff < FaceTableType::maxFaces; ++ff)
+          if (faceTable.kind(ee, ff) == FaceTableType::coupling)
+            interfaces[labels[ee]][faceTable.neighbor(ee, ff)] += 1.0;
+      }
+      neighbors.clear();
+      const auto intersectionItEnd = globalGridPart.iend(element);
+      for (auto intersectionIt = globalGridPart.ibegin(element); intersectionIt != intersectionItEnd;
+           ++intersectionIt) {
+        const auto& intersection = *intersectionIt;
+        if (intersection.neighbor()) {
+          const auto neighborPtr = intersection.outside();
+          const size_t neighbor  = row(*neighborPtr);
+          neighbors.push_back(neighbor);
+          if (hasFaceTable && msGrid.faceTable().kind(ee, intersection.indexInInside()) == FaceTableType::mixed) {
+            const size_t neighborSubdomain = msGrid.faceTable().subdomain(neighbor);
+            if (neighborSubdomain != labels[ee])
+              interfaces[labels[ee]][neighborSubdomain] += 1.0;
+          }
+        }
+      }
+      std::sort(neighbors.begin(), neighbors.end());
+      walkRows.push_back(ee);
+      for (size_t ii = 0; ii < neighbors.size(); ++ii) {
+        if (ii > 0 && neighbors[ii] == neighbors[ii - 1])
+          walkWeights.back() += 1.0;
+        else {
+          walkNeighbors.push_back(neighbors[ii]);
+          walkWeights.push_back(1.0);
+          ++graph.offsets[ee + 1];
+        }
+      }
+    }
+    for (size_t ee = 0; ee < numElements; ++ee)
+      graph.offsets[ee + 1] += graph.offsets[ee];
+    graph.adjacency.resize(walkNeighbors.size());
+    graph.edgeWeights.resize(walkWeights.size());
+    size_t source = 0;
+    for (const size_t ee : walkRows) {
+      const size_t count = graph.degree(ee);
+      std::copy(walkNeighbors.begin() + source, walkNeighbors.begin() + source + count,
+                graph.adjacency.begin() + graph.offsets[ee]);
+      std::copy(walkWeights.begin() + source, walkWeights.begin() + source + count,
+                graph.edgeWeights.begin() + graph.offsets[ee]);
+      source += count;
+    }
+    if (!hasFaceTable)
+      interfaces = interface_sizes(graph, labels, msGrid.size());
+  } // ElementData(...)
+
+  Graph graph;
+  std::vector<size_t> labels;
+  std::vector<FieldVector<double, dimWorld>> centers;
+  std::vector<double> volumes;
+  std::vector<std::map<size_t, double>> interfaces;
+}; // struct ElementData
+
+} // namespace internal
+
+/**
+ *  \brief  Computes all measures of Quality of a multiscale grid.
+ *
+ *          The dual graph, the subdomain, the center and the volume of each element and the interfaces (from the face
+ *          table, if msGrid has one) are computed in one walk over the grid upon the first call and attached to msGrid
+ *          (see Default::attached()), so later calls for the same multiscale grid (or a copy of it) do not touch the
+ *          grid. If msGrid has oversampled local grid parts, the oversampling overhead is taken from their sizes, else
+ *          it is estimated for numLayers layers.
+ */
+template <class GridType>
+Quality quality(const Default<GridType>& msGrid, const size_t numLayers = 1)
+{
+  typedef internal::ElementData<GridType> ElementDataType;
+  const ElementDataType& data =
+      msGrid.template attached<ElementDataType>([&]() { return std::make_shared<ElementDataType>(msGrid); });
+  Quality result =
+      internal::quality(data.graph, data.labels, msGrid.size(), data.interfaces, data.centers, data.volumes, numLayers);
+  if (msGrid.oversampling()) {
+    size_t oversampledSize = 0;
+    for (size_t ss = 0; ss < msGrid.size(); ++ss)
+      oversampledSize += msGrid.localGridPart(ss, true).indexSet().size(0);
+    result.oversamplingOverhead = double(oversampledSize) / double(data.labels.size()) - 1.0;
+  }
+  return result;
+} // ... quality(...)
+
+//! the Quality of the multiscale grid of provider
+template <class GridType>
+Quality quality(const ProviderInterface<GridType>& provider, const size_t numLayers = 1)
+{
+  return quality(*provider.ms_grid(), numLayers);
+}
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_QUALITY_HH
@@ -0,0 +1,217 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_REFINEMENT_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_REFINEMENT_HH
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+//! what refine_partition() did
+struct RefinementStatistics
+{
+  RefinementStatistics()
+    : cutBefore(0)
+    , cutAfter(0)
+    , moves(0)
+    , restored(false)
+  {
+  }
+
+  double cutBefore;
+  double cutAfter;
+  //! the number of moves of a vertex to another part
+  size_t moves;
+  //! true, if the refinement disconnected a part and the original labeling was restored
+  bool restored;
+}; // struct RefinementStatistics
+
+namespace internal {
+
+/**
+ *  \brief  Decides cheaply whether a part stays connected if a vertex is removed: its neighbors in the part have to be
+ *          reachable from each other within the part, by a search which visits at most maxVisits vertices (if the
+ *          search gives up, the removal is considered unsafe).
+ */
+class LocalConnectivity
+{
+public:
+  LocalConnectivity(const Graph& graph, const size_t maxVisits = 64)
+    : graph_(graph)
+    , maxVisits_(maxVisits)
+    , stamps_(graph.size(), 0)
+    , stamp_(0)
+  {
+  }
+
+  bool staysConnected(const std::vector<size_t>& labels, const size_t vertex)
+  {
+    const size_t part = labels[vertex];
+    ++stamp_;
+    size_t toReach = 0;
+    size_t start   = vertex;
+    // mark the neighbors to reach with stamp_, visited vertices get stamp_ + 1
+    for (size_t ii = graph_.offsets[vertex]; ii < graph_.offsets[vertex + 1]; ++ii) {
+      const size_t neighbor = graph_.adjacency[ii];
+      if (labels[neighbor] == part) {
+        stamps_[neighbor] = stamp_;
+        start             = neighbor;
+        ++toReach;
+      }
+    }
+    if (toReach <= 1) {
+      ++stamp_;
+      return true;
+    }
+    const size_t visitedStamp = ++stamp_;
+    stack_.clear();
+    stack_.push_back(start);
+    stamps_[start] = visitedStamp;
+    --toReach;
+    size_t visits = 0;
+    while (!stack_.empty() && toReach > 0 && visits < maxVisits_) {
+      const size_t vv = stack_.back();
+      stack_.pop_back();
+      ++visits;
+      for (size_t ii = graph_.offsets[vv]; ii < graph_.offsets[vv + 1]; ++ii) {
+        const size_t neighbor = graph_.adjacency[ii];
+        if (neighbor == vertex || labels[neighbor] != part || stamps_[neighbor] == visitedStamp)
+          continue;
+        if (stamps_[neighbor] == visitedStamp - 1)
+          --toReach;
+        stamps_[neighbor] = visitedStamp;
+        stack_.push_back(neighbor);
+      }
+    }
+    return toReach == 0;
+  } // ... staysConnected(...)
+
+private:
+  const Graph& graph_;
+  const size_t maxVisits_;
+  std::vector<size_t> stamps_;
+  size_t stamp_;
+  std::vector<size_t> stack_;
+}; // class LocalConnectivity
+
+} // namespace internal
+
+/**
+ *  \brief  Reduces the edge cut of a labeling by greedy k-way boundary refinement: in each pass, the boundary vertices
+ *          are visited by decreasing gain and moved to the neighboring part which reduces the cut the most, as long as
+ *          no part gets heavier than (1 + imbalance) * totalWeight / numParts and the part left behind stays connected.
+ *
+ *          In contrast to Fiduccia-Mattheyses (see internal::refine_bisection), moves which increase the cut are never
+ *          done and never rolled back, so the refinement stops in the first local minimum. It is cheap and never makes
+ *          a labeling worse, which is what a final polish after a partitioner (or of a given labeling) needs.
+ *
+ *          Moves without gain are only done if they improve the balance. Connectivity is checked locally for each move
+ *          (see internal::LocalConnectivity) and globally at the end: if any part has more components than before, the
+ *          original labeling is restored.
+ */
+inline RefinementStatistics refine_partition(const Graph& graph, std::vector<size_t>& labels, const size_t numParts,
+                                             const double imbalance = 0.03, const size_t maxPasses = 8)
+{
+  if (labels.size() != graph.size())
+    DUNE_THROW(Dune::InvalidStateException,
+               "labels has size " << labels.size() << ", the graph has " << graph.size() << " vertices!");
+  RefinementStatistics statistics;
+  statistics.cutBefore = edge_cut(graph, labels);
+  statistics.cutAfter  = statistics.cutBefore;
+  if (numParts < 2)
+    return statistics;
+  const std::vector<size_t> original         = labels;
+  const std::vector<size_t> componentsBefore = components(graph, labels, numParts);
+  std::vector<double> weights                = part_weights(graph, labels, numParts);
+  std::vector<size_t> sizes(numParts, 0);
+  for (const size_t label : labels)
+    ++sizes[label];
+  const double maxWeight = graph.totalWeight() / double(numParts) * (1.0 + imbalance);
+  internal::LocalConnectivity connectivity(graph);
+  // the connection of a vertex to each neighboring part, reset after each use
+  std::vector<double> connection(numParts, 0.0);
+  std::vector<size_t> neighborParts;
+  // finds the best move of vv, returns (gain, target part), target part is numParts if there is no valid move
+  const auto bestMove = [&](const size_t vv) {
+    const size_t own = labels[vv];
+    neighborParts.clear();
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii) {
+      const size_t part = labels[graph.adjacency[ii]];
+      if (connection[part] == 0.0 && part != own)
+        neighborParts.push_back(part);
+      connection[part] += graph.edgeWeights[ii];
+    }
+    std::pair<double, size_t> best(-std::numeric_limits<double>::max(), numParts);
+    for (const size_t part : neighborParts) {
+      const double gain = connection[part] - connection[own];
+      if (weights[part] + graph.vertexWeights[vv] > maxWeight)
+        continue;
+      if (gain < 0 || (gain == 0 && weights[part] + graph.vertexWeights[vv] >= weights[own]))
+        continue;
+      if (gain > best.first)
+        best = std::make_pair(gain, part);
+    }
+    for (size_t ii = graph.offsets[vv]; ii < graph.offsets[vv + 1]; ++ii)
+      connection[labels[graph.adjacency[ii]]] = 0.0;
+    return best;
+  };
+  std::vector<std::pair<double, size_t>> candidates;
+  for (size_t pass = 0; pass < maxPasses; ++pass) {
+    candidates.clear();
+    for (size_t vv = 0; vv < graph.size(); ++vv) {
+      const std::pair<double, size_t> move = bestMove(vv);
+      if (move.second < numParts)
+        candidates.push_back(std::make_pair(-move.first, vv));
+    }
+    std::sort(candidates.begin(), candidates.end());
+    size_t passMoves = 0;
+    for (const auto& candidate : candidates) {
+      const size_t vv = candidate.second;
+      // earlier moves may have changed the gain
+      const std::pair<double, size_t> move = bestMove(vv);
+      const size_t own                     = labels[vv];
+      if (move.second == numParts || sizes[own] == 1 || !connectivity.staysConnected(labels, vv))
+        continue;
+      labels[vv] = move.second;
+      weights[own] -= graph.vertexWeights[vv];
+      weights[move.second] += graph.vertexWeights[vv];
+      --sizes[own];
+      ++sizes[move.second];
+      statistics.cutAfter -= move.first;
+      ++passMoves;
+    }
+    statistics.moves += passMoves;
+    if (passMoves == 0)
+      break;
+  } // for (size_t pass = 0; pass < maxPasses; ++pass)
+  const std::vector<size_t> componentsAfter = components(graph, labels, numParts);
+  for (size_t pp = 0; pp < numParts; ++pp)
+    if (componentsAfter[pp] > componentsBefore[pp]) {
+      labels              = original;
+      statistics.cutAfter = statistics.cutBefore;
+      statistics.moves    = 0;
+      statistics.restored = true;
+      break;
+    }
+  return statistics;
+} // ... refine_partition(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_REFINEMENT_HH
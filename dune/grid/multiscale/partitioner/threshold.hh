@@ -0,0 +1,94 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PARTITIONER_THRESHOLD_HH
+#define DUNE_GRID_MULTISCALE_PARTITIONER_THRESHOLD_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include <dune/common/version.hh>
+
+#include <dune/grid/multiscale/parallel.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Partitioner {
+
+/**
+ *  \brief  Evaluates a scalar localizable function once at the center of each element of gridPart.
+ *
+ *          The entity seeds are collected during the grid walk, then the function is evaluated on num_threads threads
+ *          (0 means default_num_threads()). Only opt in to more than one thread if the local functions are safe to
+ *          create and evaluate concurrently, which is not true for all functions.
+ *  \return the value at the center of each element, in the order of the walk
+ */
+template <class GridPartType, class FunctionType>
+std::vector<double> evaluate_at_centers(const GridPartType& gridPart, const FunctionType& function,
+                                        const size_t num_threads = 1)
+{
+  typedef typename GridPartType::GridType GridType;
+  typedef typename GridType::template Codim<0>::EntitySeed EntitySeedType;
+  const GridType& grid = gridPart.grid();
+  std::vector<EntitySeedType> seeds;
+  seeds.reserve(gridPart.indexSet().size(0));
+  const auto itEnd = gridPart.template end<0>();
+  for (auto it = gridPart.template begin<0>(); it != itEnd; ++it)
+    seeds.push_back(it->seed());
+  std::vector<double> values(seeds.size());
+  parallel_for(0,
+               seeds.size(),
+               [&](const size_t ii) {
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 4)
+                 const auto entity = grid.entity(seeds[ii]);
+#else
+                 const auto entityPtr = grid.entityPointer(seeds[ii]);
+                 const auto& entity   = *entityPtr;
+#endif
+                 const auto geometry = entity.geometry();
+                 values[ii]          = function.local_function(entity)->evaluate(geometry.local(geometry.center()))[0];
+               },
+               num_threads);
+  return values;
+} // ... evaluate_at_centers(...)
+
+/**
+ *  \brief  The band of each value between the (sorted) thresholds: band 0 holds the values below thresholds[0],
+ *          band ii those in [thresholds[ii - 1], thresholds[ii]) and band thresholds.size() those from the last
+ *          threshold on.
+ */
+inline std::vector<size_t> threshold_bands(const std::vector<double>& values, std::vector<double> thresholds)
+{
+  std::sort(thresholds.begin(), thresholds.end());
+  std::vector<size_t> bands(values.size());
+  for (size_t ii = 0; ii < values.size(); ++ii)
+    bands[ii] = size_t(std::upper_bound(thresholds.begin(), thresholds.end(), values[ii]) - thresholds.begin());
+  return bands;
+} // ... threshold_bands(...)
+
+//! renumbers labels contiguously from 0, keeping their order
+inline std::vector<size_t> compact_labels(const std::vector<size_t>& labels)
+{
+  const size_t numLabels = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+  std::vector<size_t> numbers(numLabels, 0);
+  for (const size_t label : labels)
+    numbers[label] = 1;
+  size_t next = 0;
+  for (size_t ll = 0; ll < numLabels; ++ll)
+    numbers[ll] = numbers[ll] ? next++ : std::numeric_limits<size_t>::max();
+  std::vector<size_t> compact(labels.size());
+  for (size_t ii = 0; ii < labels.size(); ++ii)
+    compact[ii] = numbers[labels[ii]];
+  return compact;
+} // ... compact_labels(...)
+
+} // namespace Partitioner
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PARTITIONER_THRESHOLD_HH
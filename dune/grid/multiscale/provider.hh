@@ -13,6 +13,11 @@
 
 #include "provider/interface.hh"
 #include "provider/cube.hh"
+#include "provider/multilevel.hh"
+#include "provider/geometric.hh"
+#include "provider/labelfile.hh"
+#include "provider/labelimage.hh"
+#include "provider/functionbased.hh"
 
 namespace Dune {
 namespace grid {
@@ -35,12 +40,33 @@ protected:
   } // ... call_create(...)
 
 public:
-  static std::vector<std::string> available() { return {Providers::Cube<GridType>::static_id()}; } // ... available(...)
+  static std::vector<std::string> available()
+  {
+    return {Providers::Cube<GridType>::static_id(),
+            Providers::Multilevel<GridType>::static_id(),
+            Providers::CoordinateBisection<GridType>::static_id(),
+            Providers::Hilbert<GridType>::static_id(),
+            Providers::LabelFile<GridType>::static_id(),
+            Providers::LabelImage<GridType>::static_id(),
+            Providers::Functionbased<GridType>::static_id()};
+  } // ... available(...)
 
   static Stuff::Common::Configuration default_config(const std::string type, const std::string sub_name = "")
   {
     if (type == Providers::Cube<GridType>::static_id())
       return Providers::Cube<GridType>::default_config(sub_name);
+    else if (type == Providers::Multilevel<GridType>::static_id())
+      return Providers::Multilevel<GridType>::default_config(sub_name);
+    else if (type == Providers::CoordinateBisection<GridType>::static_id())
+      return Providers::CoordinateBisection<GridType>::default_config(sub_name);
+    else if (type == Providers::Hilbert<GridType>::static_id())
+      return Providers::Hilbert<GridType>::default_config(sub_name);
+    else if (type == Providers::LabelFile<GridType>::static_id())
+      return Providers::LabelFile<GridType>::default_config(sub_name);
+    else if (type == Providers::LabelImage<GridType>::static_id())
+      return Providers::LabelImage<GridType>::default_config(sub_name);
+    else if (type == Providers::Functionbased<GridType>::static_id())
+      return Providers::Functionbased<GridType>::default_config(sub_name);
     else
       DUNE_THROW(Stuff::Exceptions::wrong_input_given,
                  "'" << type << "' is not a valid " << InterfaceType::static_id() << "!");
@@ -56,6 +82,18 @@ public:
   {
     if (type == Providers::Cube<GridType>::static_id())
       return call_create<Providers::Cube<GridType>>(config);
+    else if (type == Providers::Multilevel<GridType>::static_id())
+      return call_create<Providers::Multilevel<GridType>>(config);
+    else if (type == Providers::CoordinateBisection<GridType>::static_id())
+      return call_create<Providers::CoordinateBisection<GridType>>(config);
+    else if (type == Providers::Hilbert<GridType>::static_id())
+      return call_create<Providers::Hilbert<GridType>>(config);
+    else if (type == Providers::LabelFile<GridType>::static_id())
+      return call_create<Providers::LabelFile<GridType>>(config);
+    else if (type == Providers::LabelImage<GridType>::static_id())
+      return call_create<Providers::LabelImage<GridType>>(config);
+    else if (type == Providers::Functionbased<GridType>::static_id())
+      return call_create<Providers::Functionbased<GridType>>(config);
     else
       DUNE_THROW(Stuff::Exceptions::wrong_input_given,
                  "'" << type << "' is not a valid " << InterfaceType::static_id() << "!");
@@ -0,0 +1,285 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_CACHE_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_CACHE_HH
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <typeinfo>
+#include <iterator>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parametertree.hh>
+
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/partitioner/labelfile.hh>
+
+#include "../provider.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+/**
+ *  \brief  Caches the providers created by MsGridProviders, for parameter studies which create the same multiscale
+ *          grid over and over.
+ *
+ *          Providers are identified by a canonical key: the grid type, the provider type and the configuration merged
+ *          into the default configuration of that provider, with the values stripped of redundant whitespace (so the
+ *          order of the keys and spelling out defaults does not matter).
+ *
+ *          - The last capacity providers are kept in memory and handed out as shared pointers (least recently used
+ *            ones are dropped first).
+ *          - If a directory is given, the labeling of each created multiscale grid is stored there as a label file
+ *            (see Partitioner::write_labels) under the hash of its key. In later runs the multiscale grid is then
+ *            recreated from that snapshot by Providers::LabelFile (on the same cube grid, with the same number of
+ *            oversampling layers) instead of by the partitioner. Snapshots which can not be read or written are
+ *            ignored.
+ *
+ *          \note  A provider recreated from a snapshot is a Providers::LabelFile, not an instance of the provider type
+ *                 which was asked for, so only its multiscale grid (and grid) may be relied upon: state of the original
+ *                 provider, like the refinement_statistics() of a refined labeling, is lost.
+ *
+ *          All methods may be called concurrently, the providers themselves are created outside the lock (so two
+ *          threads asking for the same key at the same time may both create it).
+ */
+template <class GridImp>
+class MsGridProviderCache
+{
+public:
+  typedef GridImp GridType;
+  typedef MsGridProviders<GridType> ProvidersType;
+  typedef typename ProvidersType::InterfaceType InterfaceType;
+
+  explicit MsGridProviderCache(const size_t capacity = 8, const std::string directory = "")
+    : capacity_(capacity)
+    , directory_(directory)
+    , hits_(0)
+    , snapshot_hits_(0)
+    , misses_(0)
+  {
+  }
+
+  std::shared_ptr<const InterfaceType> create(const Stuff::Common::Configuration& config)
+  {
+    return create(config.get<std::string>("type"), config);
+  }
+
+  std::shared_ptr<const InterfaceType>
+  create(const std::string& type, const Stuff::Common::Configuration config = Stuff::Common::Configuration())
+  {
+    const std::string key = canonical_key(type, config);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto result = entries_.find(key);
+      if (result != entries_.end()) {
+        ++hits_;
+        lru_.splice(lru_.begin(), lru_, result->second);
+        return result->second->second;
+      }
+    }
+    std::shared_ptr<const InterfaceType> provider = load_snapshot(key, type, config);
+    if (provider) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++snapshot_hits_;
+    } else {
+      provider = ProvidersType::create(type, config);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++misses_;
+      }
+      store_snapshot(key, *provider);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert(key, provider);
+    return provider;
+  } // ... create(...)
+
+  //! the canonical key of a configuration, see MsGridProviderCache
+  static std::string canonical_key(const std::string& type, const Stuff::Common::Configuration& config)
+  {
+    std::map<std::string, std::string> values;
+    flatten(ProvidersType::default_config(type), "", values);
+    flatten(config.has_sub(type) ? config.sub(type) : config, "", values);
+    values["type"] = type;
+    std::string key = "grid = " + std::string(typeid(GridType).name()) + "\n";
+    for (const auto& element : values)
+      key += element.first + " = " + element.second + "\n";
+    return key;
+  } // ... canonical_key(...)
+
+  //! the name of the snapshot of a key in the cache directory (without the directory)
+  static std::string snapshot_name(const std::string& key)
+  {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0')
+         << Partitioner::internal::fnv1a(key.data(), key.size());
+    return name.str();
+  }
+
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+  }
+
+  //! number of providers handed out from memory
+  size_t hits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+  }
+
+  //! number of providers recreated from a snapshot in the cache directory
+  size_t snapshot_hits() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_hits_;
+  }
+
+  //! number of providers created by MsGridProviders
+  size_t misses() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+  }
+
+  //! drops all providers held in memory (the snapshots on disk are kept)
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+  }
+
+private:
+  typedef std::list<std::pair<std::string, std::shared_ptr<const InterfaceType>>> LruType;
+
+  static void flatten(const ParameterTree& tree, const std::string& prefix, std::map<std::string, std::string>& values)
+  {
+    for (const auto& key : tree.getValueKeys()) {
+      // collapse whitespace, so that "[1  2]" and " [1 2]" are the same value
+      std::istringstream words(tree[key]);
+      std::string value;
+      for (std::string word; words >> word;)
+        value += (value.empty() ? "" : " ") + word;
+      values[prefix + key] = value;
+    }
+    for (const auto& key : tree.getSubKeys())
+      flatten(tree.sub(key), prefix + key + ".", values);
+  } // ... flatten(...)
+
+  //! has to be called with the mutex locked
+  void insert(const std::string& key, const std::shared_ptr<const InterfaceType>& provider)
+  {
+    if (capacity_ == 0 || entries_.count(key) > 0)
+      return;
+    lru_.emplace_front(key, provider);
+    entries_[key] = lru_.begin();
+    while (lru_.size() > capacity_) {
+      entries_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  } // ... insert(...)
+
+  /**
+   *  \return the Providers::LabelFile of the snapshot of key, or nullptr if there is none. The subdomains are not
+   *          checked for connectedness again: the provider which created the labeling decided whether they have to
+   *          be connected (e.g. Providers::Functionbased with connected = false or Providers::Multilevel do not).
+   */
+  std::shared_ptr<const InterfaceType> load_snapshot(const std::string& key, const std::string& type,
+                                                     const Stuff::Common::Configuration& config) const
+  {
+    if (directory_.empty())
+      return nullptr;
+    const std::string path = directory_ + "/" + snapshot_name(key);
+    // the key is stored next to the labels, so that a collision of the hashes is detected, and it is written last
+    // (see store_snapshot()), so it has to be checked first
+    std::ifstream key_file(path + ".key");
+    if (!key_file)
+      return nullptr;
+    const std::string stored_key((std::istreambuf_iterator<char>(key_file)), std::istreambuf_iterator<char>());
+    if (stored_key != key)
+      return nullptr;
+    const Stuff::Common::Configuration cfg         = config.has_sub(type) ? config.sub(type) : config;
+    const Stuff::Common::Configuration default_cfg = ProvidersType::default_config(type);
+    Stuff::Common::Configuration snapshot_config;
+    for (const std::string name : {"lower_left", "upper_right", "num_elements", "oversampling_layers"}) {
+      if (cfg.hasKey(name))
+        snapshot_config[name] = cfg.get<std::string>(name);
+      else if (default_cfg.hasKey(name))
+        snapshot_config[name] = default_cfg.get<std::string>(name);
+      else
+        return nullptr;
+    }
+    snapshot_config["filename"]         = path + ".labels";
+    snapshot_config["assert_connected"] = "false";
+    try {
+      return Providers::LabelFile<GridType>::create(snapshot_config);
+    } catch (Dune::Exception&) {
+      // e.g. a truncated file
+      return nullptr;
+    }
+  } // ... load_snapshot(...)
+
+  //! best effort, like load_snapshot(): a snapshot which can not be written is simply missing in the next run
+  void store_snapshot(const std::string& key, const InterfaceType& provider) const
+  {
+    if (directory_.empty())
+      return;
+    const std::string path = directory_ + "/" + snapshot_name(key);
+    // write to temporaries and rename, so that concurrent runs never see half written snapshots
+    const std::string tmp = path + "." + std::to_string(::getpid()) + "."
+                            + std::to_string(reinterpret_cast<std::uintptr_t>(this)) + ".tmp";
+    try {
+      Partitioner::write_labels(tmp + ".labels", *provider.ms_grid());
+      std::ofstream key_file(tmp + ".key", std::ios::trunc);
+      key_file << key;
+      key_file.close();
+      if (!key_file)
+        DUNE_THROW(Dune::IOError, "could not write '" << tmp << ".key'!");
+      // The two renames are not atomic as a pair, so a stale key (of a colliding hash) is removed first, the labels
+      // are moved next and the key last (and load_snapshot() checks the key first): a reader which finds the key
+      // also finds the matching labels, a reader which does not find it ignores the snapshot.
+      std::remove((path + ".key").c_str());
+      if (std::rename((tmp + ".labels").c_str(), (path + ".labels").c_str()) != 0)
+        DUNE_THROW(Dune::IOError, "could not move '" << tmp << ".labels' to '" << path << ".labels'!");
+      if (std::rename((tmp + ".key").c_str(), (path + ".key").c_str()) != 0)
+        DUNE_THROW(Dune::IOError, "could not move '" << tmp << ".key' to '" << path << ".key'!");
+    } catch (...) {
+      // e.g. a full disk or a read only directory, the provider is still valid
+      std::remove((tmp + ".labels").c_str());
+      std::remove((tmp + ".key").c_str());
+    }
+  } // ... store_snapshot(...)
+
+  const size_t capacity_;
+  const std::string directory_;
+  mutable std::mutex mutex_;
+  LruType lru_;
+  std::unordered_map<std::string, typename LruType::iterator> entries_;
+  size_t hits_;
+  size_t snapshot_hits_;
+  size_t misses_;
+}; // class MsGridProviderCache
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_CACHE_HH
@@ -12,6 +12,7 @@
 
 #include <dune/common/exceptions.hh>
 
+#include <dune/grid/common/capabilities.hh>
 #include <dune/grid/common/mcmgmapper.hh>
 #include <dune/grid/io/file/vtk/vtkwriter.hh>
 #include <dune/grid/io/file/dgfparser.hh>
@@ -36,6 +37,16 @@ namespace Providers {
 
 #if HAVE_DUNE_FEM
 
+/**
+ *  \brief  Partitions a cube grid into num_partitions[0] x ... x num_partitions[dim - 1] tensor product subdomains,
+ *          numbered lexicographically (the first coordinate running fastest).
+ *
+ *          The subdomain of each element is computed arithmetically from its center and all elements are added to the
+ *          factory at once (see Factory::Default::add(subdomains)). For Cartesian grids (see
+ *          Dune::Capabilities::isCartesian) the local indices are numbered in ascending order of the global ones, so
+ *          the subdomains are boxes in the global index space and the local index sets compute their lookups instead
+ *          of storing them (see Part::IndexSet::Local::IndexLookup).
+ */
 template <class GridImp>
 class Cube : public ProviderInterface<GridImp>
 {
@@ -60,6 +71,8 @@ public:
     config["num_elements"]        = "[8 8 8]";
     config["num_partitions"]      = "[2 2 2]";
     config["oversampling_layers"] = "0";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
     if (sub_name.empty())
       return config;
     else {
@@ -80,7 +93,9 @@ public:
         cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
         cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain),
         cfg.get("num_partitions", default_cfg.get<std::vector<size_t>>("num_partitions"), dimDomain),
-        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")));
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")));
   } // ... create(...)
 
   Cube(const DomainType lower_left = default_config().template get<DomainType>("lower_left"),
@@ -88,7 +103,9 @@ public:
        const std::vector<unsigned int> num_elements = default_config().template get<std::vector<unsigned int>>("num_elements"),
        const std::vector<size_t> num_partittions = default_config().template get<std::vector<size_t>>("num_partitions",
                                                                                              dimDomain),
-       const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers")/*,
+       const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+       const bool refine                    = default_config().template get<bool>("refine"),
+       const double refine_imbalance        = default_config().template get<double>("refine_imbalance")/*,
        std::ostream& out = DSC_LOG.devnull(), const std::string prefix = ""*/)
   {
     if (num_partittions.size() < dimDomain)
@@ -114,7 +131,7 @@ public:
       grd_ptr->globalRefine(1);
 #endif
     grid_ = grd_ptr;
-    setup(lower_left, upper_right, num_partittions, num_oversampling_layers/*, out, prefix*/);
+    setup(lower_left, upper_right, num_partittions, num_oversampling_layers, refine, refine_imbalance/*, out, prefix*/);
   }
 
   Cube(const std::shared_ptr<const GridType> grd,
@@ -122,7 +139,9 @@ public:
        const DomainType upper_right              = default_config().template get<DomainType>("upper_right"),
        const std::vector<size_t> num_partittions = default_config().template get<std::vector<size_t>>("num_partitions",
                                                                                              dimDomain),
-       const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers")/*,
+       const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+       const bool refine                    = default_config().template get<bool>("refine"),
+       const double refine_imbalance        = default_config().template get<double>("refine_imbalance")/*,
        std::ostream& out = DSC_LOG.devnull(), const std::string prefix = ""*/)
     : grid_(grd)
   {
@@ -137,7 +156,7 @@ public:
                                   << upper_right[ii]
                                   << "!)");
     }
-    setup(lower_left, upper_right, num_partittions, num_oversampling_layers/*, out, prefix*/);
+    setup(lower_left, upper_right, num_partittions, num_oversampling_layers, refine, refine_imbalance/*, out, prefix*/);
   }
 
   virtual const GridType& grid() const override { return *grid_; }
@@ -146,14 +165,18 @@ public:
 
   std::shared_ptr<const GridType> grid_ptr() const { return grid_; }
 
+  //! what the refinement of the partition did (see Factory::Default::refine()), all zero if it was not refined
+  const Partitioner::RefinementStatistics& refinement_statistics() const { return refinement_statistics_; }
+
   virtual std::unique_ptr<Stuff::Grid::ConstProviderInterface<GridType>> copy() const
   {
-    DUNE_THROW(NotImplemented, "");
+    DUNE_THROW(NotImplemented, "copying a " << static_id() << " provider!");
   }
 
 private:
   void setup(const DomainType& lower_left, const DomainType& upper_right, const std::vector<size_t>& num_partitions,
-             const size_t num_oversampling_layers/*, std::ostream& out = DSC_LOG.devnull(), const std::string prefix = ""*/)
+             const size_t num_oversampling_layers, const bool refine, const double refine_imbalance/*,
+             std::ostream& out = DSC_LOG.devnull(), const std::string prefix = ""*/)
   {
     typedef Dune::grid::Multiscale::Factory::Default<GridType> MsGridFactoryType;
 
@@ -171,37 +194,32 @@ private:
     // global grid part
 //    typedef typename MsGridType::GlobalGridPartType GridPartType;
     const auto global_grid_part = factory.globalGridPart();
-    // walk the grid
+    // walk the grid and decide on the subdomain of each element (in the order of the walk)
+    std::vector<size_t> subdomains;
+    subdomains.reserve(global_grid_part->indexSet().size(0));
     const auto entity_it_end = global_grid_part->template end<0>();
     for (auto entity_it = global_grid_part->template begin<0>(); entity_it != entity_it_end; ++entity_it) {
       // get center of entity
       const auto& entity = *entity_it;
       const auto center  = entity.geometry().center();
-//#ifndef NDEBUG
-//      const size_t entity_index = global_grid_part->indexSet().index(entity);
-//      Stuff::Common::print(center, "entity (" + Stuff::Common::toString(entity_index) + ")", out, prefix);
-//#endif // NDEBUG
-      // decide on the subdomain this entity shall belong to
-      std::vector<size_t> whichPartition(dimDomain, 0);
-      for (size_t dd = 0; dd < dimDomain; ++dd)
-        whichPartition[dd] =
-            (std::min((size_t)(std::floor(num_partitions[dd]
-                                          * ((center[dd] - lower_left[dd]) / (upper_right[dd] - lower_left[dd])))),
-                      num_partitions[dd] - 1));
+      // the partitions are numbered lexicographically, the first coordinate running fastest
       size_t subdomain = 0;
-      if (dimDomain == 1)
-        subdomain = whichPartition[0];
-      else if (dimDomain == 2)
-        subdomain = whichPartition[0] + whichPartition[1] * num_partitions[0];
-      else if (dimDomain == 3)
-        subdomain = whichPartition[0] + whichPartition[1] * num_partitions[0]
-                    + whichPartition[2] * num_partitions[1] * num_partitions[0];
-      else
-        DUNE_THROW(Dune::NotImplemented,
-                   "ERROR in " << static_id() << ": not implemented for grid dimDomains other than 1, 2 or 3!");
-      // add entity to subdomain
-      factory.add(entity, subdomain/*, prefix + "  ", out*/);
+      size_t stride    = 1;
+      for (size_t dd = 0; dd < dimDomain; ++dd) {
+        const size_t partition =
+            std::min(size_t(std::floor(num_partitions[dd]
+                                       * ((center[dd] - lower_left[dd]) / (upper_right[dd] - lower_left[dd])))),
+                     num_partitions[dd] - 1);
+        subdomain += partition * stride;
+        stride *= num_partitions[dd];
+      }
+      subdomains.push_back(subdomain);
     } // walk the grid
+    // add all entities at once
+    factory.add(subdomains, Dune::Capabilities::isCartesian<GridType>::v);
+    // reduce the interfaces, if requested
+    if (refine)
+      refinement_statistics_ = factory.refine(refine_imbalance);
     // finalize
     factory.finalize(num_oversampling_layers, neighbor_recursion_level/*, prefix + "  ", out*/);
     //    debug << std::flush;
@@ -211,6 +229,7 @@ private:
 
   std::shared_ptr<const GridType> grid_;
   std::shared_ptr<const MsGridType> ms_grid_;
+  Partitioner::RefinementStatistics refinement_statistics_;
 }; // class Cube
 
 #else // HAVE_DUNE_FEM
@@ -6,194 +6,150 @@
 #ifndef DUNE_GRID_MULTISCALE_PROVIDER_FUNCTIONBASED_HH
 #define DUNE_GRID_MULTISCALE_PROVIDER_FUNCTIONBASED_HH
 
-#ifdef HAVE_CMAKE_CONFIG
-#include "cmake_config.h"
-#elif defined(HAVE_CONFIG_H)
-#include <config.h>
-#endif // ifdef HAVE_CMAKE_CONFIG
-
+#include <string>
 #include <vector>
+#include <memory>
+#include <cstdint>
 
-#include <dune/common/exceptions.hh>
-#include <dune/common/shared_ptr.hh>
-
-#include <dune/grid/common/mcmgmapper.hh>
-#include <dune/grid/io/file/vtk/vtkwriter.hh>
-#include <dune/grid/sgrid.hh>
-
-#include <dune/stuff/grid/provider.hh>
-#include <dune/stuff/common/logging.hh>
+#include <dune/stuff/common/memory.hh>
 #include <dune/stuff/common/configuration.hh>
+#include <dune/stuff/functions/interfaces.hh>
 #include <dune/stuff/functions.hh>
 
-#include <dune/grid/multiscale/factory/default.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/labelimage.hh>
+#include <dune/grid/multiscale/partitioner/threshold.hh>
 
-#include "interface.hh"
+#include "labeled.hh"
 
 namespace Dune {
 namespace grid {
 namespace Multiscale {
-
-#if defined HAVE_CONFIG_H || defined HAVE_CMAKE_CONFIG
-template <class GridImp = Dune::GridSelector::GridType>
-#else
-template <class GridImp = Dune::SGrid<2, 2>>
-#endif
-class ProviderFunctionbased : public ProviderInterface<GridImp>
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Partitions the grid along level sets of a scalar function (e.g. a high contrast coefficient): the elements
+ *          are sorted into the bands between the given thresholds by the value of the function at their center.
+ *
+ *          The function is evaluated once per element, on one thread unless num_threads says otherwise (see
+ *          Partitioner::evaluate_at_centers). If connected is true (the default), each connected region of a band
+ *          becomes a subdomain, else each non-empty band (which may then consist of several regions).
+ */
+template <class GridImp>
+class Functionbased : public Labeled<GridImp>
 {
+  typedef Labeled<GridImp> BaseType;
+  typedef Functionbased<GridImp> ThisType;
+
 public:
-  typedef ProviderFunctionbased<GridImp> ThisType;
-  typedef Dune::Stuff::GridProviderInterface<GridImp> NonMultiscaleType;
-  typedef ProviderInterface<GridImp> InterfaceType;
-  typedef GridImp GridType;
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename BaseType::GlobalGridPartType GlobalGridPartType;
 
-  static const unsigned int dim = NonMultiscaleType::dim;
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
 
-  typedef typename NonMultiscaleType::ctype ctype;
-  typedef typename NonMultiscaleType::CoordinateType CoordinateType;
+  typedef typename GridType::template Codim<0>::Entity EntityType;
+  typedef typename GridType::ctype DomainFieldType;
   typedef double RangeFieldType;
-  // until now only implemented for scalar functions
-  typedef Dune::Stuff::FunctionInterface<ctype, dim, RangeFieldType, 1, 1> FunctionType;
-
-private:
-  typedef Dune::grid::Multiscale::Factory::Default<GridType> MsGridFactoryType;
-
-public:
-  typedef typename MsGridFactoryType::MsGridType MsGridType;
+  typedef Stuff::LocalizableFunctionInterface<EntityType, DomainFieldType, dimDomain, RangeFieldType, 1, 1>
+      FunctionType;
 
 private:
-  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+  typedef Stuff::FunctionsProvider<EntityType, DomainFieldType, dimDomain, RangeFieldType, 1, 1> FunctionsType;
 
 public:
-  static const std::string id() { return InterfaceType::id() + ".functionbased"; }
+  static std::string static_id() { return ProviderInterface<GridImp>::static_id() + ".functionbased"; }
 
-  ProviderFunctionbased(std::shared_ptr<const GridType> grid, std::shared_ptr<const FunctionType> function,
-                        std::vector<double> partitions)
-    : grid_(grid)
+  static Stuff::Common::Configuration default_config(const std::string sub_name = "")
   {
-    // prepare
-    MsGridFactoryType factory(grid);
-    factory.prepare();
-    // debug output
-    const std::string prefix              = "";
-    Dune::Stuff::Common::LogStream& debug = Dune::Stuff::Common::Logger().devnull();
-    // global grid part
-    typedef typename MsGridType::GlobalGridPartType GridPartType;
-    const Dune::shared_ptr<const GridPartType> gridPart = factory.globalGridPart();
-    // walk the grid
-    for (typename GridPartType::template Codim<0>::IteratorType it = gridPart->template begin<0>();
-         it != gridPart->template end<0>();
-         ++it) {
-      // get center of entity
-      const auto& entity          = *it;
-      const CoordinateType center = entity.geometry().center();
-      debug << prefix << "  entity (" << center << "):" << std::endl;
-      // decide on the subdomain this entity shall belong to
-      unsigned int subdomain = 0;
-      int size = partitions.size();
-      for (int ii = 1; ii < size; ii++) {
-        if (((function->evaluate(center)) > partitions[ii - 1]) && ((function->evaluate(center)) < partitions[ii])) {
-          subdomain = ii;
-        }
-      }
-      if ((function->evaluate(center)) > partitions[size - 1]) {
-        subdomain = size;
-      }
-      // add entity to subdomain
-      factory.add(entity, subdomain, prefix + "  ", debug);
-
-    } // walk the grid
-    const unsigned int numberOfSubdomains = partitions.size() + 1;
-    debug << prefix << "  the grid has " << numberOfSubdomains << " subdomains." << std::endl;
-    // finalize
-    factory.finalize(0, prefix + "  ", debug, false);
-    // debug << std::flush;
-
-    // be done with it
-    msGrid_ = factory.createMsGrid();
-  }
-
-  ProviderFunctionbased(const ThisType& other) : NonMultiscaleType(other), msGrid_(other.msGrid_) {}
-
-  static Dune::ParameterTree createSampleDescription(const std::string subName = "")
-  {
-    typedef Stuff::GridProviders<GridType> Providers;
-    typedef Stuff::Functions<ctype, dim, RangeFieldType, 1, 1> Functions;
-    Dune::ParameterTree description;
-    description["provider"]   = Providers::available()[0];
-    description["function"]   = Functions::available()[0];
-    description["partitions"] = "[0.5; 1.0]";
-    if (subName.empty())
-      return description;
+    Stuff::Common::Configuration config;
+    config["type"]                = static_id();
+    config["thresholds"]          = "[0.5]";
+    config["connected"]           = "true";
+    config["lower_left"]          = "[0.0 0.0 0.0]";
+    config["upper_right"]         = "[1.0 1.0 1.0]";
+    config["num_elements"]        = "[8 8 8]";
+    config["oversampling_layers"] = "0";
+    config["num_threads"]         = "1";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
+    config.add(FunctionsType::default_config(FunctionsType::available()[0]), "function");
+    if (sub_name.empty())
+      return config;
     else {
-      Dune::Stuff::Common::Configuration extendedDescription;
-      extendedDescription.add(description, subName);
-      return extendedDescription;
+      Stuff::Common::Configuration tmp;
+      tmp.add(config, sub_name);
+      return tmp;
     }
-  } // ... createSampleDescription(...)
+  } // ... default_config(...)
 
-  static ThisType* create(const Dune::ParameterTree& description, const std::string subName = id())
+  static std::unique_ptr<ThisType> create(const Stuff::Common::Configuration config = default_config(),
+                                          const std::string sub_name = static_id())
   {
-    // get correct paramTree
-    Dune::Stuff::Common::Configuration extendedParamTree;
-    if (description.hasSub(subName))
-      extendedParamTree = description.sub(subName);
-    else
-      extendedParamTree = description;
-
-    // get grid provider
-    NonMultiscaleType gridProvider;
-    if (extendedParamTree.hasKey("provider")) {
-      typedef Stuff::GridProviders<GridType> Providers;
-      gridProvider = extendedParamTree.get("provider", Providers::available()[0]);
-    } else {
-      DUNE_THROW(Dune::IOError, "Error: no key 'provider' given in " << id() << std::endl);
-    }
-    std::shared_ptr<GridType> grid(gridProvider->grid());
-    // get function
-    FunctionType function;
-    if (extendedParamTree.hasKey("function")) {
-      typedef Stuff::Functions<ctype, dim, RangeFieldType, 1, 1> Functions;
-      gridProvider = extendedParamTree.get("function", Functions::available()[0]);
-    } else {
-      DUNE_THROW(Dune::IOError, "Error: no key 'function' given in " << id() << std::endl);
-    }
-    // get partitions
-    std::vector<RangeFieldType> partitions;
-    if (extendedParamTree.hasVector("partitions")) {
-      partitions = extendedParamTree.getVector<RangeFieldType>("partitions", 1);
-    } else if (extendedParamTree.hasKey("partitions")) {
-      partitions = std::vector<RangeFieldType>(1, extendedParamTree.get("partitions", 1u));
-    } else {
-      std::cout << "WARNING in " << id() << ": neither vector nor key 'partitions' given, defaulting to 1!"
-                << std::endl;
-      partitions = std::vector<RangeFieldType>(1, 1u);
-    }
-    return new ThisType(grid, function, partitions);
-  } // static ThisType createFromParamTree(const Dune::ParameterTree& paramTree, const std::string subName = id())
-
-  const ThisType& operator=(const ThisType& other)
+    const Stuff::Common::Configuration cfg          = config.has_sub(sub_name) ? config.sub(sub_name) : config;
+    const Stuff::Common::Configuration default_cfg  = default_config();
+    const Stuff::Common::Configuration function_cfg = cfg.has_sub("function") ? cfg.sub("function")
+                                                                              : default_cfg.sub("function");
+    const std::shared_ptr<const FunctionType> function(
+        FunctionsType::create(function_cfg.get<std::string>("type"), function_cfg).release());
+    return Stuff::Common::make_unique<ThisType>(
+        BaseType::create_cube_grid(
+            cfg.get("lower_left", default_cfg.get<DomainType>("lower_left"), dimDomain),
+            cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
+            cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain)),
+        function,
+        cfg.get("thresholds", default_cfg.get<std::vector<RangeFieldType>>("thresholds")),
+        cfg.get("connected", default_cfg.get<bool>("connected")),
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        cfg.get("num_threads", default_cfg.get<size_t>("num_threads")),
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")));
+  } // ... create(...)
+
+  Functionbased(const std::shared_ptr<const GridType> grd, const std::shared_ptr<const FunctionType> function,
+                const std::vector<RangeFieldType> thresholds, const bool connected = true,
+                const size_t num_oversampling_layers = 0, const size_t num_threads = 1, const bool refine = false,
+                const double refine_imbalance = 0.03)
+    : BaseType(grd)
+    , function_(function)
   {
-    if (this != &other) {
-      NonMultiscaleType::operator=(other);
-      msGrid_                    = other.msGrid();
-    }
-    return this;
-  } // ThisType& operator=(ThisType& other)
+    this->setup(
+        [&](const GlobalGridPartType& global_grid_part) -> std::vector<size_t> {
+          const std::vector<size_t> bands = Partitioner::threshold_bands(
+              Partitioner::evaluate_at_centers(global_grid_part, *function_, num_threads), thresholds);
+          if (!connected)
+            return Partitioner::compact_labels(bands);
+          return Partitioner::connected_regions(Partitioner::dual_graph(global_grid_part),
+                                                std::vector<std::uint64_t>(bands.begin(), bands.end()));
+        },
+        num_oversampling_layers,
+        connected,
+        refine,
+        refine_imbalance);
+  } // Functionbased(...)
+
+  const FunctionType& function() const { return *function_; }
 
-  virtual const Dune::shared_ptr<const GridType> grid() const { return grid_; }
+private:
+  const std::shared_ptr<const FunctionType> function_;
+}; // class Functionbased
 
-  virtual const Dune::shared_ptr<const MsGridType> msGrid() const { return msGrid_; }
+#else // HAVE_DUNE_FEM
 
-  using InterfaceType::visualize;
+template <class GridImp>
+class Functionbased
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
 
-private:
-  Dune::shared_ptr<const GridType> grid_;
-  Dune::shared_ptr<const MsGridType> msGrid_;
-}; // class ProviderFunctionbased
+#endif // HAVE_DUNE_FEM
 
+} // namespace Providers
 } // namespace Multiscale
-} // namespace Grid
+} // namespace grid
 } // namespace Dune
 
 #endif // DUNE_GRID_MULTISCALE_PROVIDER_FUNCTIONBASED_HH
@@ -0,0 +1,190 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_GEOMETRIC_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_GEOMETRIC_HH
+
+#include <vector>
+#include <memory>
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/partitioner/geometric.hh>
+
+#include "labeled.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+namespace internal {
+
+/**
+ *  \brief  Common part of the providers which partition the element centers, PartitionerType::partition(centers,
+ *          num_partitions, weights, num_threads) has to return the subdomain of each element.
+ */
+template <class GridImp, class PartitionerType>
+class Geometric : public Labeled<GridImp>
+{
+  typedef Labeled<GridImp> BaseType;
+  typedef Geometric<GridImp, PartitionerType> ThisType;
+
+public:
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename BaseType::GlobalGridPartType GlobalGridPartType;
+
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
+
+  static std::string static_id() { return ProviderInterface<GridImp>::static_id() + "." + PartitionerType::id(); }
+
+  static Stuff::Common::Configuration default_config(const std::string sub_name = "")
+  {
+    Stuff::Common::Configuration config;
+    config["type"]                = static_id();
+    config["lower_left"]          = "[0.0 0.0 0.0]";
+    config["upper_right"]         = "[1.0 1.0 1.0]";
+    config["num_elements"]        = "[8 8 8]";
+    config["num_partitions"]      = "8";
+    config["oversampling_layers"] = "0";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
+    if (sub_name.empty())
+      return config;
+    else {
+      Stuff::Common::Configuration tmp;
+      tmp.add(config, sub_name);
+      return tmp;
+    }
+  } // ... default_config(...)
+
+  static std::unique_ptr<ThisType> create(const Stuff::Common::Configuration config = default_config(),
+                                          const std::string sub_name = static_id())
+  {
+    const Stuff::Common::Configuration cfg         = config.has_sub(sub_name) ? config.sub(sub_name) : config;
+    const Stuff::Common::Configuration default_cfg = default_config();
+    return Stuff::Common::make_unique<ThisType>(
+        cfg.get("lower_left", default_cfg.get<DomainType>("lower_left"), dimDomain),
+        cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
+        cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain),
+        cfg.get("num_partitions", default_cfg.get<size_t>("num_partitions")),
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")));
+  } // ... create(...)
+
+  Geometric(const DomainType lower_left = default_config().template get<DomainType>("lower_left"),
+            const DomainType upper_right = default_config().template get<DomainType>("upper_right"),
+            const std::vector<unsigned int> num_elements =
+                default_config().template get<std::vector<unsigned int>>("num_elements"),
+            const size_t num_partitions          = default_config().template get<size_t>("num_partitions"),
+            const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+            const bool refine                    = default_config().template get<bool>("refine"),
+            const double refine_imbalance        = default_config().template get<double>("refine_imbalance"))
+    : BaseType(BaseType::create_cube_grid(lower_left, upper_right, num_elements))
+  {
+    partition(std::vector<double>(), num_partitions, num_oversampling_layers, 0, refine, refine_imbalance);
+  }
+
+  /**
+   *  \param  weights one weight per element in the order of the walk over the global grid part, all 1 if empty
+   */
+  Geometric(const std::shared_ptr<const GridType> grd,
+            const size_t num_partitions          = default_config().template get<size_t>("num_partitions"),
+            const std::vector<double>& weights   = std::vector<double>(),
+            const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+            const size_t num_threads             = 0,
+            const bool refine                    = default_config().template get<bool>("refine"),
+            const double refine_imbalance        = default_config().template get<double>("refine_imbalance"))
+    : BaseType(grd)
+  {
+    partition(weights, num_partitions, num_oversampling_layers, num_threads, refine, refine_imbalance);
+  }
+
+private:
+  void partition(const std::vector<double>& weights, const size_t num_partitions,
+                 const size_t num_oversampling_layers, const size_t num_threads, const bool refine,
+                 const double refine_imbalance)
+  {
+    this->setup(
+        [&](const GlobalGridPartType& global_grid_part) {
+          return PartitionerType::partition(
+              Partitioner::element_centers(global_grid_part), num_partitions, weights, num_threads);
+        },
+        num_oversampling_layers,
+        true,
+        refine,
+        refine_imbalance);
+  } // ... partition(...)
+}; // class Geometric
+
+struct CoordinateBisectionPartitioner
+{
+  static std::string id() { return "coordinate_bisection"; }
+
+  template <int dim>
+  static std::vector<size_t> partition(const std::vector<FieldVector<double, dim>>& centers,
+                                       const size_t num_partitions, const std::vector<double>& weights,
+                                       const size_t num_threads)
+  {
+    return Partitioner::recursive_coordinate_bisection(centers, num_partitions, weights, num_threads);
+  }
+}; // struct CoordinateBisectionPartitioner
+
+struct HilbertPartitioner
+{
+  static std::string id() { return "hilbert"; }
+
+  template <int dim>
+  static std::vector<size_t> partition(const std::vector<FieldVector<double, dim>>& centers,
+                                       const size_t num_partitions, const std::vector<double>& weights,
+                                       const size_t num_threads)
+  {
+    return Partitioner::hilbert_partition(centers, num_partitions, weights, num_threads);
+  }
+}; // struct HilbertPartitioner
+
+} // namespace internal
+
+/**
+ *  \brief  Partitions the grid by recursive coordinate bisection of the element centers into num_partitions subdomains
+ *          of equal weight, see Partitioner::recursive_coordinate_bisection.
+ */
+template <class GridImp>
+using CoordinateBisection = internal::Geometric<GridImp, internal::CoordinateBisectionPartitioner>;
+
+/**
+ *  \brief  Partitions the grid by cutting the Hilbert curve ordering of the element centers into num_partitions pieces
+ *          of equal weight, see Partitioner::hilbert_partition.
+ */
+template <class GridImp>
+using Hilbert = internal::Geometric<GridImp, internal::HilbertPartitioner>;
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class CoordinateBisection
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+template <class GridImp>
+class Hilbert
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Providers
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_GEOMETRIC_HH
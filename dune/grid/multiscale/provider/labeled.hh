@@ -0,0 +1,150 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_LABELED_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_LABELED_HH
+
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include <dune/common/exceptions.hh>
+
+#if HAVE_ALUGRID
+#include <dune/grid/alugrid.hh>
+#endif
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/factory/default.hh>
+
+#include "interface.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Creates the multiscale grid from a labeling of the elements, i.e. the subdomain of each element in the order
+ *          of the walk over the global grid part (see Factory::Default::add(subdomains)).
+ *
+ *          Also serves as base for all providers which compute such a labeling (from the geometry, a graph, a file,
+ *          ...): they only have to call setup() with a functor computing it.
+ */
+template <class GridImp>
+class Labeled : public ProviderInterface<GridImp>
+{
+  typedef ProviderInterface<GridImp> BaseType;
+
+public:
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
+
+  static std::string static_id() { return BaseType::static_id() + ".labeled"; }
+
+  Labeled(const std::shared_ptr<const GridType> grd, const std::vector<size_t>& subdomains,
+          const size_t num_oversampling_layers = 0, const bool refine = false, const double refine_imbalance = 0.03)
+    : grid_(grd)
+  {
+    setup([&](const GlobalGridPartType& /*global_grid_part*/) { return subdomains; },
+          num_oversampling_layers,
+          true,
+          refine,
+          refine_imbalance);
+  }
+
+  virtual const GridType& grid() const override { return *grid_; }
+
+  virtual const std::shared_ptr<const MsGridType>& ms_grid() const override { return ms_grid_; }
+
+  std::shared_ptr<const GridType> grid_ptr() const { return grid_; }
+
+  //! what the refinement of the labeling did (see Factory::Default::refine()), all zero if it was not refined
+  const Partitioner::RefinementStatistics& refinement_statistics() const { return refinement_statistics_; }
+
+  virtual std::unique_ptr<Stuff::Grid::ConstProviderInterface<GridType>> copy() const
+  {
+    DUNE_THROW(NotImplemented, "copying a " << static_id() << " provider (the labeling is not stored)!");
+  }
+
+protected:
+  //! setup() has to be called by the derived class
+  explicit Labeled(const std::shared_ptr<const GridType> grd)
+    : grid_(grd)
+  {
+  }
+
+  //! the same grid Cube creates
+  static std::shared_ptr<const GridType> create_cube_grid(const DomainType& lower_left, const DomainType& upper_right,
+                                                          const std::vector<unsigned int>& num_elements)
+  {
+    for (size_t ii = 0; ii < dimDomain; ++ii) {
+      if (lower_left[ii] >= upper_right[ii])
+        DUNE_THROW(Dune::RangeError,
+                   lower_left[ii] << " = lower_left[" << ii << "] has to be smaller than upper_right[" << ii << "] = "
+                                  << upper_right[ii]
+                                  << "!)");
+    }
+    typedef Dune::Stuff::Grid::Providers::Cube<GridType> CubeGridProvider;
+    auto grd_ptr = CubeGridProvider(lower_left, upper_right, num_elements).grid_ptr();
+#if HAVE_ALUGRID
+    if (std::is_same<GridType, ALUGrid<2, 2, simplex, conforming>>::value)
+      grd_ptr->globalRefine(1);
+#endif
+    return grd_ptr;
+  } // ... create_cube_grid(...)
+
+  /**
+   *  \param  labeling          functor, labeling(global_grid_part) has to return the subdomain of each element in
+   *                            the order of the walk over global_grid_part
+   *  \param  assert_connected  whether finalize() shall check that each subdomain is connected
+   *  \param  refine            whether to reduce the interfaces of the labeling by Factory::Default::refine(), keeping
+   *                            the imbalance below refine_imbalance (see refinement_statistics())
+   */
+  template <class LabelingType>
+  void setup(const LabelingType& labeling, const size_t num_oversampling_layers, const bool assert_connected = true,
+             const bool refine = false, const double refine_imbalance = 0.03)
+  {
+    typedef Dune::grid::Multiscale::Factory::Default<GridType> MsGridFactoryType;
+    const size_t neighbor_recursion_level = Factory::NeighborRecursionLevel<GridType>::compute();
+    MsGridFactoryType factory(grid_);
+    factory.prepare();
+    const auto global_grid_part = factory.globalGridPart();
+    factory.add(labeling(*global_grid_part));
+    if (refine)
+      refinement_statistics_ = factory.refine(refine_imbalance);
+    factory.finalize(num_oversampling_layers, neighbor_recursion_level, assert_connected);
+    ms_grid_ = factory.createMsGrid();
+  } // ... setup(...)
+
+private:
+  std::shared_ptr<const GridType> grid_;
+  std::shared_ptr<const MsGridType> ms_grid_;
+  Partitioner::RefinementStatistics refinement_statistics_;
+}; // class Labeled
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class Labeled
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Providers
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_LABELED_HH
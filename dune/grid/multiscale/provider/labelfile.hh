@@ -0,0 +1,142 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_LABELFILE_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_LABELFILE_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/partitioner/labelfile.hh>
+
+#include "labeled.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Reads the subdomain of each element from a label file (see Partitioner::read_labels for the format), e.g.
+ *          computed offline by an external partitioner.
+ *
+ *          Use Partitioner::write_labels(filename, ms_grid) to store the labeling of any multiscale grid in this
+ *          format, to reuse an expensive partition in later runs. Unless assert_connected is false, each subdomain of
+ *          the file has to be connected.
+ */
+template <class GridImp>
+class LabelFile : public Labeled<GridImp>
+{
+  typedef Labeled<GridImp> BaseType;
+  typedef LabelFile<GridImp> ThisType;
+
+public:
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename BaseType::GlobalGridPartType GlobalGridPartType;
+
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
+
+  static std::string static_id() { return ProviderInterface<GridImp>::static_id() + ".label_file"; }
+
+  static Stuff::Common::Configuration default_config(const std::string sub_name = "")
+  {
+    Stuff::Common::Configuration config;
+    config["type"]                = static_id();
+    config["filename"]            = "labels.bin";
+    config["lower_left"]          = "[0.0 0.0 0.0]";
+    config["upper_right"]         = "[1.0 1.0 1.0]";
+    config["num_elements"]        = "[8 8 8]";
+    config["oversampling_layers"] = "0";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
+    config["assert_connected"]    = "true";
+    if (sub_name.empty())
+      return config;
+    else {
+      Stuff::Common::Configuration tmp;
+      tmp.add(config, sub_name);
+      return tmp;
+    }
+  } // ... default_config(...)
+
+  static std::unique_ptr<ThisType> create(const Stuff::Common::Configuration config = default_config(),
+                                          const std::string sub_name = static_id())
+  {
+    const Stuff::Common::Configuration cfg         = config.has_sub(sub_name) ? config.sub(sub_name) : config;
+    const Stuff::Common::Configuration default_cfg = default_config();
+    return Stuff::Common::make_unique<ThisType>(
+        cfg.get("filename", default_cfg.get<std::string>("filename")),
+        cfg.get("lower_left", default_cfg.get<DomainType>("lower_left"), dimDomain),
+        cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
+        cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain),
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")),
+        cfg.get("assert_connected", default_cfg.get<bool>("assert_connected")));
+  } // ... create(...)
+
+  LabelFile(const std::string filename = default_config().template get<std::string>("filename"),
+            const DomainType lower_left = default_config().template get<DomainType>("lower_left"),
+            const DomainType upper_right = default_config().template get<DomainType>("upper_right"),
+            const std::vector<unsigned int> num_elements =
+                default_config().template get<std::vector<unsigned int>>("num_elements"),
+            const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+            const bool refine                    = default_config().template get<bool>("refine"),
+            const double refine_imbalance        = default_config().template get<double>("refine_imbalance"),
+            const bool assert_connected          = default_config().template get<bool>("assert_connected"))
+    : BaseType(BaseType::create_cube_grid(lower_left, upper_right, num_elements))
+  {
+    read(filename, num_oversampling_layers, refine, refine_imbalance, assert_connected);
+  }
+
+  LabelFile(const std::shared_ptr<const GridType> grd, const std::string filename,
+            const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+            const bool refine                    = default_config().template get<bool>("refine"),
+            const double refine_imbalance        = default_config().template get<double>("refine_imbalance"),
+            const bool assert_connected          = default_config().template get<bool>("assert_connected"))
+    : BaseType(grd)
+  {
+    read(filename, num_oversampling_layers, refine, refine_imbalance, assert_connected);
+  }
+
+private:
+  void read(const std::string& filename, const size_t num_oversampling_layers, const bool refine,
+            const double refine_imbalance, const bool assert_connected)
+  {
+    this->setup(
+        [&](const GlobalGridPartType& global_grid_part) {
+          return Partitioner::read_labels(filename, global_grid_part);
+        },
+        num_oversampling_layers,
+        assert_connected,
+        refine,
+        refine_imbalance);
+  }
+}; // class LabelFile
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class LabelFile
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Providers
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_LABELFILE_HH
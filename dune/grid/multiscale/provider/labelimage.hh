@@ -0,0 +1,153 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_LABELIMAGE_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_LABELIMAGE_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/labelimage.hh>
+
+#include "labeled.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Takes the subdomains from a raw label volume (e.g. grains and channels segmented from a micro-CT image), see
+ *          Partitioner::LabelImage.
+ *
+ *          Each element gets the label of the voxel at its center (or the majority of sub_samples^dim samples), each
+ *          connected region of equally labeled elements becomes a subdomain and subdomains with less than
+ *          min_elements elements are merged into their strongest connected neighbor.
+ */
+template <class GridImp>
+class LabelImage : public Labeled<GridImp>
+{
+  typedef Labeled<GridImp> BaseType;
+  typedef LabelImage<GridImp> ThisType;
+
+public:
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename BaseType::GlobalGridPartType GlobalGridPartType;
+
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
+
+  static std::string static_id() { return ProviderInterface<GridImp>::static_id() + ".label_image"; }
+
+  static Stuff::Common::Configuration default_config(const std::string sub_name = "")
+  {
+    Stuff::Common::Configuration config;
+    config["type"]                = static_id();
+    config["filename"]            = "labels.raw";
+    config["image_size"]          = "[64 64 64]";
+    config["voxel_bytes"]         = "1";
+    config["header_bytes"]        = "0";
+    config["image_lower_left"]    = "[0.0 0.0 0.0]";
+    config["image_upper_right"]   = "[1.0 1.0 1.0]";
+    config["sub_samples"]         = "1";
+    config["min_elements"]        = "1";
+    config["lower_left"]          = "[0.0 0.0 0.0]";
+    config["upper_right"]         = "[1.0 1.0 1.0]";
+    config["num_elements"]        = "[8 8 8]";
+    config["oversampling_layers"] = "0";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
+    if (sub_name.empty())
+      return config;
+    else {
+      Stuff::Common::Configuration tmp;
+      tmp.add(config, sub_name);
+      return tmp;
+    }
+  } // ... default_config(...)
+
+  static std::unique_ptr<ThisType> create(const Stuff::Common::Configuration config = default_config(),
+                                          const std::string sub_name = static_id())
+  {
+    const Stuff::Common::Configuration cfg         = config.has_sub(sub_name) ? config.sub(sub_name) : config;
+    const Stuff::Common::Configuration default_cfg = default_config();
+    const auto grd = BaseType::create_cube_grid(
+        cfg.get("lower_left", default_cfg.get<DomainType>("lower_left"), dimDomain),
+        cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
+        cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain));
+    return Stuff::Common::make_unique<ThisType>(
+        grd,
+        cfg.get("filename", default_cfg.get<std::string>("filename")),
+        cfg.get("image_size", default_cfg.get<std::vector<size_t>>("image_size")),
+        cfg.get("image_lower_left", default_cfg.get<std::vector<double>>("image_lower_left")),
+        cfg.get("image_upper_right", default_cfg.get<std::vector<double>>("image_upper_right")),
+        cfg.get("voxel_bytes", default_cfg.get<size_t>("voxel_bytes")),
+        cfg.get("header_bytes", default_cfg.get<size_t>("header_bytes")),
+        cfg.get("sub_samples", default_cfg.get<size_t>("sub_samples")),
+        cfg.get("min_elements", default_cfg.get<size_t>("min_elements")),
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        0,
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")));
+  } // ... create(...)
+
+  /**
+   *  \param  image_size        number of voxels in each direction (x running fastest in the file)
+   *  \param  image_lower_left  the box covered by the image, in the coordinates of the grid
+   */
+  LabelImage(const std::shared_ptr<const GridType> grd, const std::string filename,
+             const std::vector<size_t> image_size, const std::vector<double> image_lower_left,
+             const std::vector<double> image_upper_right, const size_t voxel_bytes = 1, const size_t header_bytes = 0,
+             const size_t sub_samples = 1, const size_t min_elements = 1, const size_t num_oversampling_layers = 0,
+             const size_t num_threads = 0, const bool refine = false, const double refine_imbalance = 0.03)
+    : BaseType(grd)
+  {
+    FieldVector<double, 3> lower_left(0.0);
+    FieldVector<double, 3> upper_right(0.0);
+    for (size_t dd = 0; dd < std::min(size_t(3), image_lower_left.size()); ++dd)
+      lower_left[dd] = image_lower_left[dd];
+    for (size_t dd = 0; dd < std::min(size_t(3), image_upper_right.size()); ++dd)
+      upper_right[dd] = image_upper_right[dd];
+    const Partitioner::LabelImage image(filename, image_size, lower_left, upper_right, voxel_bytes, header_bytes);
+    this->setup(
+        [&](const GlobalGridPartType& global_grid_part) -> std::vector<size_t> {
+          const auto values  = Partitioner::sample_label_image(image, global_grid_part, sub_samples, num_threads);
+          const auto graph   = Partitioner::dual_graph(global_grid_part);
+          const auto regions = Partitioner::connected_regions(graph, values);
+          return Partitioner::merge_small_parts(graph, regions, min_elements);
+        },
+        num_oversampling_layers,
+        true,
+        refine,
+        refine_imbalance);
+  } // LabelImage(...)
+}; // class LabelImage
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class LabelImage
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Providers
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_LABELIMAGE_HH
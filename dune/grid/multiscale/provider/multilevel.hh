@@ -0,0 +1,159 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_PROVIDER_MULTILEVEL_HH
+#define DUNE_GRID_MULTISCALE_PROVIDER_MULTILEVEL_HH
+
+#include <vector>
+#include <memory>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/stuff/common/memory.hh>
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/multilevel.hh>
+
+#include "labeled.hh"
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+namespace Providers {
+
+#if HAVE_DUNE_FEM
+
+/**
+ *  \brief  Partitions the dual graph of the grid (see Partitioner::dual_graph) into num_partitions subdomains of equal
+ *          weight with small interfaces, see Partitioner::multilevel_partition.
+ *
+ *          In contrast to Cube, this works for unstructured and locally refined grids. The element weights (e.g. the
+ *          polynomial degree or the cost of evaluating the coefficients) are given in the order of the walk over the
+ *          global grid part. The subdomains are not checked for connectedness, since multilevel_partition does not
+ *          guarantee it.
+ */
+template <class GridImp>
+class Multilevel : public Labeled<GridImp>
+{
+  typedef Labeled<GridImp> BaseType;
+  typedef Multilevel<GridImp> ThisType;
+
+public:
+  typedef typename BaseType::GridType GridType;
+  typedef typename BaseType::MsGridType MsGridType;
+  typedef typename BaseType::GlobalGridPartType GlobalGridPartType;
+
+  static const unsigned int dimDomain = BaseType::dimDomain;
+  typedef typename BaseType::DomainType DomainType;
+
+  static std::string static_id() { return ProviderInterface<GridImp>::static_id() + ".multilevel"; }
+
+  static Stuff::Common::Configuration default_config(const std::string sub_name = "")
+  {
+    Stuff::Common::Configuration config;
+    config["type"]                = static_id();
+    config["lower_left"]          = "[0.0 0.0 0.0]";
+    config["upper_right"]         = "[1.0 1.0 1.0]";
+    config["num_elements"]        = "[8 8 8]";
+    config["num_partitions"]      = "8";
+    config["imbalance"]           = "0.03";
+    config["seed"]                = "0";
+    config["oversampling_layers"] = "0";
+    config["refine"]              = "false";
+    config["refine_imbalance"]    = "0.03";
+    if (sub_name.empty())
+      return config;
+    else {
+      Stuff::Common::Configuration tmp;
+      tmp.add(config, sub_name);
+      return tmp;
+    }
+  } // ... default_config(...)
+
+  static std::unique_ptr<ThisType> create(const Stuff::Common::Configuration config = default_config(),
+                                          const std::string sub_name = static_id())
+  {
+    const Stuff::Common::Configuration cfg         = config.has_sub(sub_name) ? config.sub(sub_name) : config;
+    const Stuff::Common::Configuration default_cfg = default_config();
+    return Stuff::Common::make_unique<ThisType>(
+        cfg.get("lower_left", default_cfg.get<DomainType>("lower_left"), dimDomain),
+        cfg.get("upper_right", default_cfg.get<DomainType>("upper_right"), dimDomain),
+        cfg.get("num_elements", default_cfg.get<std::vector<unsigned int>>("num_elements"), dimDomain),
+        cfg.get("num_partitions", default_cfg.get<size_t>("num_partitions")),
+        cfg.get("imbalance", default_cfg.get<double>("imbalance")),
+        cfg.get("seed", default_cfg.get<unsigned int>("seed")),
+        cfg.get("oversampling_layers", default_cfg.get<size_t>("oversampling_layers")),
+        cfg.get("refine", default_cfg.get<bool>("refine")),
+        cfg.get("refine_imbalance", default_cfg.get<double>("refine_imbalance")));
+  } // ... create(...)
+
+  Multilevel(const DomainType lower_left = default_config().template get<DomainType>("lower_left"),
+             const DomainType upper_right = default_config().template get<DomainType>("upper_right"),
+             const std::vector<unsigned int> num_elements =
+                 default_config().template get<std::vector<unsigned int>>("num_elements"),
+             const size_t num_partitions          = default_config().template get<size_t>("num_partitions"),
+             const double imbalance               = default_config().template get<double>("imbalance"),
+             const unsigned int seed              = default_config().template get<unsigned int>("seed"),
+             const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+             const bool refine                    = default_config().template get<bool>("refine"),
+             const double refine_imbalance        = default_config().template get<double>("refine_imbalance"))
+    : BaseType(BaseType::create_cube_grid(lower_left, upper_right, num_elements))
+  {
+    partition(
+        std::vector<double>(), num_partitions, imbalance, seed, num_oversampling_layers, refine, refine_imbalance);
+  }
+
+  /**
+   *  \param  weights one weight per element in the order of the walk over the global grid part, all 1 if empty
+   */
+  Multilevel(const std::shared_ptr<const GridType> grd,
+             const size_t num_partitions          = default_config().template get<size_t>("num_partitions"),
+             const std::vector<double>& weights   = std::vector<double>(),
+             const double imbalance               = default_config().template get<double>("imbalance"),
+             const unsigned int seed              = default_config().template get<unsigned int>("seed"),
+             const size_t num_oversampling_layers = default_config().template get<size_t>("oversampling_layers"),
+             const bool refine                    = default_config().template get<bool>("refine"),
+             const double refine_imbalance        = default_config().template get<double>("refine_imbalance"))
+    : BaseType(grd)
+  {
+    partition(weights, num_partitions, imbalance, seed, num_oversampling_layers, refine, refine_imbalance);
+  }
+
+private:
+  void partition(const std::vector<double>& weights, const size_t num_partitions, const double imbalance,
+                 const unsigned int seed, const size_t num_oversampling_layers, const bool refine,
+                 const double refine_imbalance)
+  {
+    if (imbalance < 0)
+      DUNE_THROW(Dune::RangeError, "imbalance has to be non-negative (is " << imbalance << ")!");
+    this->setup(
+        [&](const GlobalGridPartType& global_grid_part) {
+          return Partitioner::multilevel_partition(
+              Partitioner::dual_graph(global_grid_part, weights), num_partitions, imbalance, seed);
+        },
+        num_oversampling_layers,
+        false,
+        refine,
+        refine_imbalance);
+  } // ... partition(...)
+}; // class Multilevel
+
+#else // HAVE_DUNE_FEM
+
+template <class GridImp>
+class Multilevel
+{
+  static_assert(AlwaysFalse<GridImp>::value, "Your are missing dune-fem!");
+};
+
+#endif // HAVE_DUNE_FEM
+
+} // namespace Providers
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_PROVIDER_MULTILEVEL_HH
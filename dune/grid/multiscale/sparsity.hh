@@ -0,0 +1,283 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_SPARSITY_HH
+#define DUNE_GRID_MULTISCALE_SPARSITY_HH
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+/**
+ *  \brief  Describes where the degrees of freedom of a discretization live: blockSize DoFs on each codim entity (e.g.
+ *          codim = dimension, blockSize = 1 for continuous P1 and codim = 0, blockSize = k for DG).
+ *
+ *          If faceCoupling is true, all DoFs of elements sharing a face are coupled within a local grid part (as for DG
+ *          fluxes), otherwise only the DoFs of the same element are.
+ */
+struct DofLayout
+{
+  DofLayout(const unsigned int cc = 0, const size_t bs = 1, const bool fc = false)
+    : codim(cc)
+    , blockSize(bs)
+    , faceCoupling(fc)
+  {
+  }
+
+  unsigned int codim;
+  size_t blockSize;
+  bool faceCoupling;
+}; // struct DofLayout
+
+/**
+ *  \brief  A sparsity pattern in compressed row storage: the columns of row rr are columns[offsets[rr]] to
+ *          columns[offsets[rr + 1] - 1], sorted ascending.
+ */
+struct SparsityPattern
+{
+  SparsityPattern()
+    : rows(0)
+    , cols(0)
+    , offsets(1, 0)
+  {
+  }
+
+  size_t nonZeros() const { return columns.size(); }
+
+  size_t rows;
+  size_t cols;
+  std::vector<size_t> offsets;
+  std::vector<size_t> columns;
+}; // struct SparsityPattern
+
+namespace internal {
+
+//! inverts a compressed row relation: element -> entities becomes entity -> elements
+template <class IndexType>
+void invert_rows(const std::vector<size_t>& offsets, const std::vector<IndexType>& indices, const size_t numEntities,
+                 std::vector<size_t>& invertedOffsets, std::vector<IndexType>& invertedIndices)
+{
+  const size_t numElements = offsets.size() - 1;
+  invertedOffsets.assign(numEntities + 1, 0);
+  for (size_t ii = 0; ii < indices.size(); ++ii)
+    ++invertedOffsets[indices[ii] + 1];
+  for (size_t ee = 0; ee < numEntities; ++ee)
+    invertedOffsets[ee + 1] += invertedOffsets[ee];
+  invertedIndices.resize(indices.size());
+  std::vector<size_t> position(invertedOffsets.begin(), invertedOffsets.end() - 1);
+  for (size_t ee = 0; ee < numElements; ++ee)
+    for (size_t ii = offsets[ee]; ii < offsets[ee + 1]; ++ii)
+      invertedIndices[position[indices[ii]]++] = IndexType(ee);
+} // ... invert_rows(...)
+
+//! expands a pattern on entities to one on DoFs, each entity carrying blockSize DoFs
+inline void expand_blocks(SparsityPattern& pattern, const size_t blockSize)
+{
+  if (blockSize == 1)
+    return;
+  SparsityPattern expanded;
+  expanded.rows = pattern.rows * blockSize;
+  expanded.cols = pattern.cols * blockSize;
+  expanded.offsets.assign(expanded.rows + 1, 0);
+  expanded.columns.reserve(pattern.columns.size() * blockSize * blockSize);
+  for (size_t rr = 0; rr < pattern.rows; ++rr)
+    for (size_t bb = 0; bb < blockSize; ++bb) {
+      for (size_t ii = pattern.offsets[rr]; ii < pattern.offsets[rr + 1]; ++ii)
+        for (size_t cc = 0; cc < blockSize; ++cc)
+          expanded.columns.push_back(pattern.columns[ii] * blockSize + cc);
+      expanded.offsets[rr * blockSize + bb + 1] = expanded.columns.size();
+    }
+  std::swap(pattern, expanded);
+} // ... expand_blocks(...)
+
+/**
+ *  \brief  Assembles a pattern from row -> column contributions, given as (row, column) pairs, which may contain
+ *          duplicates.
+ */
+inline SparsityPattern compress(const size_t rows, const size_t cols, std::vector<std::pair<size_t, size_t>>& entries)
+{
+  std::sort(entries.begin(), entries.end());
+  entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+  SparsityPattern pattern;
+  pattern.rows = rows;
+  pattern.cols = cols;
+  pattern.offsets.assign(rows + 1, 0);
+  pattern.columns.resize(entries.size());
+  for (size_t ii = 0; ii < entries.size(); ++ii) {
+    ++pattern.offsets[entries[ii].first + 1];
+    pattern.columns[ii] = entries[ii].second;
+  }
+  for (size_t rr = 0; rr < rows; ++rr)
+    pattern.offsets[rr + 1] += pattern.offsets[rr];
+  return pattern;
+} // ... compress(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Computes the pattern of an operator on a local grid part, rows and columns are given by the local indices
+ *          of the codim entities (times blockSize), see DofLayout.
+ */
+template <class LocalGridPartType>
+SparsityPattern local_sparsity_pattern(const LocalGridPartType& localGridPart, const DofLayout& layout)
+{
+  const auto& connectivity = localGridPart.indexSet().connectivity();
+  typedef typename std::decay<decltype(connectivity)>::type::IndexType IndexType;
+  const std::vector<size_t>& offsets    = connectivity.offsets(layout.codim);
+  const std::vector<IndexType>& indices = connectivity.indices(layout.codim);
+  const size_t numElements = offsets.size() - 1;
+  const size_t numEntities = localGridPart.indexSet().size(layout.codim);
+  // entity -> elements
+  std::vector<size_t> entityOffsets;
+  std::vector<IndexType> entityElements;
+  internal::invert_rows(offsets, indices, numEntities, entityOffsets, entityElements);
+  // element -> face neighbors
+  std::vector<size_t> neighborOffsets(numElements + 1, 0);
+  std::vector<IndexType> neighbors;
+  if (layout.faceCoupling) {
+    std::vector<size_t> faceOffsets;
+    std::vector<IndexType> faceElements;
+    const std::vector<size_t>& elementFaceOffsets    = connectivity.offsets(1);
+    const std::vector<IndexType>& elementFaceIndices = connectivity.indices(1);
+    internal::invert_rows(
+        elementFaceOffsets, elementFaceIndices, localGridPart.indexSet().size(1), faceOffsets, faceElements);
+    for (size_t ee = 0; ee < numElements; ++ee) {
+      for (size_t ii = elementFaceOffsets[ee]; ii < elementFaceOffsets[ee + 1]; ++ii) {
+        const IndexType face = elementFaceIndices[ii];
+        for (size_t jj = faceOffsets[face]; jj < faceOffsets[face + 1]; ++jj)
+          if (size_t(faceElements[jj]) != ee)
+            neighbors.push_back(faceElements[jj]);
+      }
+      neighborOffsets[ee + 1] = neighbors.size();
+    }
+  }
+  // collect the columns of each row, marker[cc] == rr if column cc is already in row rr
+  SparsityPattern pattern;
+  pattern.rows = numEntities;
+  pattern.cols = numEntities;
+  pattern.offsets.assign(numEntities + 1, 0);
+  std::vector<size_t> marker(numEntities, std::numeric_limits<size_t>::max());
+  const auto addElement = [&](const size_t rr, const size_t element) {
+    for (size_t ii = offsets[element]; ii < offsets[element + 1]; ++ii) {
+      const size_t cc = indices[ii];
+      if (marker[cc] != rr) {
+        marker[cc] = rr;
+        pattern.columns.push_back(cc);
+      }
+    }
+  };
+  for (size_t rr = 0; rr < numEntities; ++rr) {
+    for (size_t ii = entityOffsets[rr]; ii < entityOffsets[rr + 1]; ++ii) {
+      const size_t element = entityElements[ii];
+      addElement(rr, element);
+      for (size_t jj = neighborOffsets[element]; jj < neighborOffsets[element + 1]; ++jj)
+        addElement(rr, neighbors[jj]);
+    }
+    std::sort(pattern.columns.begin() + pattern.offsets[rr], pattern.columns.end());
+    pattern.offsets[rr + 1] = pattern.columns.size();
+  }
+  internal::expand_blocks(pattern, layout.blockSize);
+  return pattern;
+} // ... local_sparsity_pattern(...)
+
+/**
+ *  \brief  Computes the pattern of a coupling operator (as for DG fluxes), rows are given by the DoFs of the inside
+ *          local grid part and columns by the DoFs of the outside local grid part, using the face pairs of the
+ *          coupling.
+ */
+template <class CouplingGridPartType>
+SparsityPattern coupling_sparsity_pattern(const CouplingGridPartType& couplingGridPart, const DofLayout& layout)
+{
+  const auto& insideIndexSet         = couplingGridPart.inside()->indexSet();
+  const auto& outsideIndexSet        = couplingGridPart.outside()->indexSet();
+  const auto& insideConnectivity     = insideIndexSet.connectivity();
+  const auto& outsideConnectivity    = outsideIndexSet.connectivity();
+  const unsigned int codim           = layout.codim;
+  std::vector<std::pair<size_t, size_t>> entries;
+  for (const auto& facePair : couplingGridPart.facePairs()) {
+    const auto* insideBegin  = insideConnectivity.begin(facePair.insideLocal, codim);
+    const auto* insideEnd    = insideBegin + insideConnectivity.size(facePair.insideLocal, codim);
+    const auto* outsideBegin = outsideConnectivity.begin(facePair.outsideLocal, codim);
+    const auto* outsideEnd   = outsideBegin + outsideConnectivity.size(facePair.outsideLocal, codim);
+    for (auto row = insideBegin; row != insideEnd; ++row)
+      for (auto col = outsideBegin; col != outsideEnd; ++col)
+        entries.push_back(std::make_pair(size_t(*row), size_t(*col)));
+  }
+  SparsityPattern pattern = internal::compress(insideIndexSet.size(codim), outsideIndexSet.size(codim), entries);
+  internal::expand_blocks(pattern, layout.blockSize);
+  return pattern;
+} // ... coupling_sparsity_pattern(...)
+
+/**
+ *  \brief  Computes the pattern of a boundary operator, in the local numbering of the inside local grid part: all DoFs
+ *          of each element at the domain boundary are coupled.
+ *  \note   Walks the boundary grid part, prefer the variant using the FaceTable of the multiscale grid if there is one.
+ */
+template <class BoundaryGridPartType>
+SparsityPattern boundary_sparsity_pattern(const BoundaryGridPartType& boundaryGridPart, const DofLayout& layout)
+{
+  const auto& insideIndexSet     = boundaryGridPart.inside()->indexSet();
+  const auto& insideConnectivity = insideIndexSet.connectivity();
+  const unsigned int codim       = layout.codim;
+  std::vector<std::pair<size_t, size_t>> entries;
+  const auto itEnd = boundaryGridPart.template end<0>();
+  for (auto it = boundaryGridPart.template begin<0>(); it != itEnd; ++it) {
+    const auto element = insideIndexSet.index(*it);
+    const auto* begin  = insideConnectivity.begin(element, codim);
+    const auto* end    = begin + insideConnectivity.size(element, codim);
+    for (auto row = begin; row != end; ++row)
+      for (auto col = begin; col != end; ++col)
+        entries.push_back(std::make_pair(size_t(*row), size_t(*col)));
+  }
+  SparsityPattern pattern = internal::compress(insideIndexSet.size(codim), insideIndexSet.size(codim), entries);
+  internal::expand_blocks(pattern, layout.blockSize);
+  return pattern;
+} // ... boundary_sparsity_pattern(...)
+
+/**
+ *  \brief  Computes the same pattern as above for a local grid part, but from the boundary faces in the FaceTable of
+ *          its multiscale grid and the connectivity of the local grid part: only the rows of the table belonging to the
+ *          elements of the local grid part are visited, neither the grid nor its intersections.
+ */
+template <class LocalGridPartType, class FaceTableType>
+SparsityPattern boundary_sparsity_pattern(const LocalGridPartType& localGridPart, const FaceTableType& faceTable,
+                                          const DofLayout& layout)
+{
+  const auto& indexSet     = localGridPart.indexSet();
+  const auto& connectivity = indexSet.connectivity();
+  const unsigned int codim = layout.codim;
+  std::vector<std::pair<size_t, size_t>> entries;
+  // the local elements by geometry type, each as (global index, local index)
+  for (const auto& geometryTypeAndIndices : *indexSet.data()->indexContainer()) {
+    const auto& geometryType = geometryTypeAndIndices.first;
+    if (geometryType.dim() != FaceTableType::dimension)
+      continue;
+    for (const auto& globalAndLocal : geometryTypeAndIndices.second) {
+      const unsigned char* kinds = faceTable.kinds(faceTable.element(geometryType, globalAndLocal.first));
+      if (std::find(kinds, kinds + FaceTableType::maxFaces, FaceTableType::boundary) == kinds + FaceTableType::maxFaces)
+        continue;
+      const auto* begin = connectivity.begin(globalAndLocal.second, codim);
+      const auto* end   = begin + connectivity.size(globalAndLocal.second, codim);
+      for (auto row = begin; row != end; ++row)
+        for (auto col = begin; col != end; ++col)
+          entries.push_back(std::make_pair(size_t(*row), size_t(*col)));
+    }
+  }
+  SparsityPattern pattern = internal::compress(indexSet.size(codim), indexSet.size(codim), entries);
+  internal::expand_blocks(pattern, layout.blockSize);
+  return pattern;
+} // ... boundary_sparsity_pattern(...)
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_SPARSITY_HH
@@ -0,0 +1,280 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_MULTISCALE_TRANSFER_HH
+#define DUNE_GRID_MULTISCALE_TRANSFER_HH
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cassert>
+
+#include <dune/grid/multiscale/parallel.hh>
+
+namespace Dune {
+namespace grid {
+namespace Multiscale {
+
+/**
+ *  \brief  Restricts a global vector to a local grid part: local[ii*blockSize + kk] = global[gg*blockSize + kk], where
+ *          gg is the global index of the codim entity with local index ii.
+ *
+ *          Works for any local grid part providing IndexSet::Local::IndexBased::globalIndices(codim), the vector types
+ *          only have to provide operator[] and size().
+ *  \note   This and the other transfer kernels are plain loops over the index map, the indirect accesses to the global
+ *          vector are not vectorized.
+ */
+template <class LocalGridPartType, class GlobalVectorType, class LocalVectorType>
+void gather(const LocalGridPartType& localGridPart, const unsigned int codim, const GlobalVectorType& global,
+            LocalVectorType& local, const size_t blockSize = 1)
+{
+  const auto& globalIndices = localGridPart.indexSet().globalIndices(codim);
+  const size_t size = globalIndices.size();
+  assert(local.size() >= size * blockSize && "Given local vector is too small!");
+  if (blockSize == 1) {
+    for (size_t ii = 0; ii < size; ++ii)
+      local[ii] = global[globalIndices[ii]];
+  } else {
+    for (size_t ii = 0; ii < size; ++ii)
+      for (size_t kk = 0; kk < blockSize; ++kk)
+        local[ii * blockSize + kk] = global[globalIndices[ii] * blockSize + kk];
+  }
+} // ... gather(...)
+
+/**
+ *  \brief  Prolongs a local vector to the global one: global[gg*blockSize + kk] = local[ii*blockSize + kk] (see
+ *          gather() for the notation), all other entries of global are left untouched.
+ */
+template <class LocalGridPartType, class LocalVectorType, class GlobalVectorType>
+void scatter(const LocalGridPartType& localGridPart, const unsigned int codim, const LocalVectorType& local,
+             GlobalVectorType& global, const size_t blockSize = 1)
+{
+  const auto& globalIndices = localGridPart.indexSet().globalIndices(codim);
+  const size_t size = globalIndices.size();
+  assert(local.size() >= size * blockSize && "Given local vector is too small!");
+  if (blockSize == 1) {
+    for (size_t ii = 0; ii < size; ++ii)
+      global[globalIndices[ii]] = local[ii];
+  } else {
+    for (size_t ii = 0; ii < size; ++ii)
+      for (size_t kk = 0; kk < blockSize; ++kk)
+        global[globalIndices[ii] * blockSize + kk] = local[ii * blockSize + kk];
+  }
+} // ... scatter(...)
+
+/**
+ *  \brief  Adds a local vector to the global one: global[gg*blockSize + kk] += local[ii*blockSize + kk] (see gather()
+ *          for the notation).
+ */
+template <class LocalGridPartType, class LocalVectorType, class GlobalVectorType>
+void scatter_add(const LocalGridPartType& localGridPart, const unsigned int codim, const LocalVectorType& local,
+                 GlobalVectorType& global, const size_t blockSize = 1)
+{
+  const auto& globalIndices = localGridPart.indexSet().globalIndices(codim);
+  const size_t size = globalIndices.size();
+  assert(local.size() >= size * blockSize && "Given local vector is too small!");
+  if (blockSize == 1) {
+    for (size_t ii = 0; ii < size; ++ii)
+      global[globalIndices[ii]] += local[ii];
+  } else {
+    for (size_t ii = 0; ii < size; ++ii)
+      for (size_t kk = 0; kk < blockSize; ++kk)
+        global[globalIndices[ii] * blockSize + kk] += local[ii * blockSize + kk];
+  }
+} // ... scatter_add(...)
+
+/**
+ *  \brief  Restricts a global vector to all (oversampled, if requested) local grid parts of a multiscale grid, in
+ *          parallel across the subdomains, if num_threads > 1.
+ *  \param  locals has to contain one (correctly sized) vector per subdomain
+ *  \param  num_threads the number of threads, which are started anew upon each call (0 means
+ *          default_num_threads()), only pays off for large vectors
+ */
+template <class MsGridType, class GlobalVectorType, class LocalVectorType>
+void gather_all(const MsGridType& msGrid, const unsigned int codim, const GlobalVectorType& global,
+                std::vector<LocalVectorType>& locals, const size_t blockSize = 1, const bool oversampling = false,
+                const size_t num_threads = 1)
+{
+  assert(locals.size() == msGrid.size());
+  parallel_for(0,
+               msGrid.size(),
+               [&](const size_t subdomain) {
+                 gather(msGrid.localGridPart(subdomain, oversampling), codim, global, locals[subdomain], blockSize);
+               },
+               num_threads);
+} // ... gather_all(...)
+
+namespace internal {
+
+struct Assign
+{
+  template <class TargetType, class SourceType>
+  void operator()(TargetType& target, const SourceType& source) const
+  {
+    target = source;
+  }
+};
+
+struct Add
+{
+  template <class TargetType, class SourceType>
+  void operator()(TargetType& target, const SourceType& source) const
+  {
+    target += source;
+  }
+};
+
+/**
+ *  \brief  The inverse of the local to global index maps of all (oversampled) local grid parts of a multiscale grid for
+ *          one codim, in compressed row storage: global index gg is contained in the local grid parts
+ *          subdomains[offsets[gg]] to subdomains[offsets[gg + 1] - 1] (in increasing order) with the local indices
+ *          localIndices[offsets[gg]] to localIndices[offsets[gg + 1] - 1].
+ */
+struct InverseIndexMap
+{
+  InverseIndexMap()
+    : offsets(1, 0)
+  {
+  }
+
+  //! the number of global indices (one more than the largest one contained in any local grid part)
+  size_t size() const { return offsets.size() - 1; }
+
+  std::vector<size_t> offsets;
+  std::vector<size_t> subdomains;
+  std::vector<size_t> localIndices;
+}; // struct InverseIndexMap
+
+template <class MsGridType>
+InverseIndexMap inverse_index_map(const MsGridType& msGrid, const unsigned int codim, const bool oversampling)
+{
+  typedef typename MsGridType::LocalGridPartType LocalGridPartType;
+  std::vector<LocalGridPartType> localGridParts;
+  localGridParts.reserve(msGrid.size());
+  for (size_t subdomain = 0; subdomain < msGrid.size(); ++subdomain)
+    localGridParts.push_back(msGrid.localGridPart(subdomain, oversampling));
+  InverseIndexMap inverse;
+  for (const auto& localGridPart : localGridParts)
+    for (const size_t globalIndex : localGridPart.indexSet().globalIndices(codim)) {
+      if (globalIndex + 2 > inverse.offsets.size())
+        inverse.offsets.resize(globalIndex + 2, 0);
+      ++inverse.offsets[globalIndex + 1];
+    }
+  for (size_t gg = 0; gg < inverse.size(); ++gg)
+    inverse.offsets[gg + 1] += inverse.offsets[gg];
+  inverse.subdomains.resize(inverse.offsets.back());
+  inverse.localIndices.resize(inverse.offsets.back());
+  // walking the subdomains in order keeps them sorted within each row
+  std::vector<size_t> next(inverse.offsets.begin(), inverse.offsets.end() - 1);
+  for (size_t subdomain = 0; subdomain < localGridParts.size(); ++subdomain) {
+    const auto& globalIndices = localGridParts[subdomain].indexSet().globalIndices(codim);
+    for (size_t ii = 0; ii < globalIndices.size(); ++ii) {
+      const size_t position          = next[globalIndices[ii]]++;
+      inverse.subdomains[position]   = subdomain;
+      inverse.localIndices[position] = ii;
+    }
+  }
+  return inverse;
+} // ... inverse_index_map(...)
+
+/**
+ *  \brief  The InverseIndexMap of each codim (with and without oversampling) of a multiscale grid, each built upon
+ *          first use. Meant to be attached to the multiscale grid (see Default::attached()), which is thus not stored.
+ */
+template <class MsGridType>
+class InverseIndexMaps
+{
+public:
+  static const unsigned int dimension = MsGridType::dimension;
+
+  InverseIndexMaps()
+    : built_(2 * (dimension + 1))
+    , maps_(2 * (dimension + 1))
+  {
+  }
+
+  const InverseIndexMap& get(const MsGridType& msGrid, const unsigned int codim, const bool oversampling) const
+  {
+    assert(codim <= dimension);
+    const size_t key = 2 * codim + (oversampling ? 1 : 0);
+    std::call_once(built_[key], [&]() { maps_[key] = inverse_index_map(msGrid, codim, oversampling); });
+    return maps_[key];
+  }
+
+private:
+  mutable std::vector<std::once_flag> built_;
+  mutable std::vector<InverseIndexMap> maps_;
+}; // class InverseIndexMaps
+
+/**
+ *  \brief  Since the local grid parts share entities (at least of codim > 0 or if oversampled), writing to the global
+ *          vector is not parallelized across subdomains but across disjoint ranges of global indices: each thread
+ *          only walks the rows of its range in the InverseIndexMap (built once per codim and oversampling and attached
+ *          to msGrid). The subdomains of each row are applied in increasing order, so the result is deterministic.
+ */
+template <class MsGridType, class GlobalVectorType, class LocalVectorType, class OperationType>
+void parallel_prolong(const MsGridType& msGrid, const unsigned int codim, const std::vector<LocalVectorType>& locals,
+                      GlobalVectorType& global, const size_t blockSize, const bool oversampling,
+                      const size_t num_threads, const OperationType& operation)
+{
+  assert(locals.size() == msGrid.size());
+  typedef InverseIndexMaps<MsGridType> InverseIndexMapsType;
+  const InverseIndexMap& inverse =
+      msGrid.template attached<InverseIndexMapsType>([]() { return std::make_shared<InverseIndexMapsType>(); })
+          .get(msGrid, codim, oversampling);
+#ifndef NDEBUG
+  for (size_t subdomain = 0; subdomain < msGrid.size(); ++subdomain) {
+    const auto localGridPart = msGrid.localGridPart(subdomain, oversampling);
+    assert(locals[subdomain].size() >= localGridPart.indexSet().globalIndices(codim).size() * blockSize
+           && "Given local vector is too small!");
+  }
+#endif
+  assert(global.size() >= inverse.size() * blockSize && "Given global vector is too small!");
+  parallel_for_chunks(0,
+                      inverse.size(),
+                      [&](const size_t begin, const size_t end, const size_t /*thread*/) {
+                        for (size_t gg = begin; gg < end; ++gg)
+                          for (size_t ii = inverse.offsets[gg]; ii < inverse.offsets[gg + 1]; ++ii) {
+                            const LocalVectorType& local = locals[inverse.subdomains[ii]];
+                            const size_t localIndex      = inverse.localIndices[ii];
+                            for (size_t kk = 0; kk < blockSize; ++kk)
+                              operation(global[gg * blockSize + kk], local[localIndex * blockSize + kk]);
+                          }
+                      },
+                      num_threads);
+} // ... parallel_prolong(...)
+
+} // namespace internal
+
+/**
+ *  \brief  Prolongs all local vectors to the global one (see scatter()), optionally in parallel (see gather_all()).
+ *          Where local grid parts overlap, the value of the subdomain with the largest number wins.
+ */
+template <class MsGridType, class LocalVectorType, class GlobalVectorType>
+void scatter_all(const MsGridType& msGrid, const unsigned int codim, const std::vector<LocalVectorType>& locals,
+                 GlobalVectorType& global, const size_t blockSize = 1, const bool oversampling = false,
+                 const size_t num_threads = 1)
+{
+  internal::parallel_prolong(
+      msGrid, codim, locals, global, blockSize, oversampling, num_threads, internal::Assign());
+} // ... scatter_all(...)
+
+/**
+ *  \brief  Adds all local vectors to the global one (see scatter_add()), optionally in parallel (see gather_all()).
+ */
+template <class MsGridType, class LocalVectorType, class GlobalVectorType>
+void scatter_add_all(const MsGridType& msGrid, const unsigned int codim, const std::vector<LocalVectorType>& locals,
+                     GlobalVectorType& global, const size_t blockSize = 1, const bool oversampling = false,
+                     const size_t num_threads = 1)
+{
+  internal::parallel_prolong(
+      msGrid, codim, locals, global, blockSize, oversampling, num_threads, internal::Add());
+} // ... scatter_add_all(...)
+
+} // namespace Multiscale
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_MULTISCALE_TRANSFER_HH
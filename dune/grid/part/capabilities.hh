@@ -0,0 +1,40 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_CAPABILITIES_HH
+#define DUNE_GRID_PART_CAPABILITIES_HH
+
+#if HAVE_DUNE_FEM
+#include <dune/fem/gridpart/common/capabilities.hh>
+#endif
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Capabilities {
+
+/**
+ *  \brief  True, if all entities of one codim of the grid part have the same GeometryType (as for YaspGrid, SGrid or
+ *          a pure simplex ALUGrid).
+ *
+ *          The local index sets and iterators use this to drop their per GeometryType lookups at compile time. Without
+ *          dune-fem we can not know and assume the general case.
+ */
+template <class GridPartType>
+struct hasSingleGeometryType
+{
+#if HAVE_DUNE_FEM
+  static const bool v = Fem::GridPartCapabilities::hasSingleGeometryType<GridPartType>::v;
+#else
+  static const bool v = false;
+#endif
+};
+
+} // namespace Capabilities
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_CAPABILITIES_HH
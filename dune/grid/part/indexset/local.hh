@@ -7,8 +7,15 @@
 #define DUNE_GRID_MULTISCALE_gridPart_INDEXSET_LOCAL_HH
 
 #include <map>
+#include <array>
+#include <algorithm>
+#include <mutex>
+#include <memory>
 #include <vector>
+#include <limits>
 #include <sstream>
+#include <typeinfo>
+#include <typeindex>
 
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -16,6 +23,12 @@
 #include <dune/common/shared_ptr.hh>
 
 #include <dune/geometry/type.hh>
+#include <dune/geometry/typeindex.hh>
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/part/capabilities.hh>
+#include <dune/grid/part/storage.hh>
+#include <dune/grid/part/iterator/local/indexbased.hh>
 
 namespace Dune {
 namespace grid {
@@ -23,8 +36,473 @@ namespace Part {
 namespace IndexSet {
 namespace Local {
 
+/**
+ *  \brief  Maps the global indices of all entities of one GeometryType to their local indices in O(1).
+ *
+ *          If the global indices form a box of up to three dimensions, i.e. first + i0 + i1*s1 + i2*s2 for all
+ *          i0 < e0, i1 < e1 and i2 < e2, and the local indices are ascending in the global ones (as for a tensor
+ *          product subdomain of a Cartesian grid, see Multiscale::Providers::Cube), the local index is computed from
+ *          the global one and nothing is stored per entity. Otherwise, if the local entities cover a large part of the
+ *          global index range (i.e. for big subdomains), the local indices are stored in a dense array which is indexed
+ *          by the global index. Otherwise the global indices are stored in a sorted array (together with the
+ *          corresponding local indices), which is searched by a branchless binary search. All indices are stored as
+ *          Storage::Index< IndexType >::type.
+ */
+template <class IndexImp>
+class IndexLookup
+{
+public:
+  typedef IndexImp IndexType;
+
+  typedef typename Storage::Index<IndexType>::type StoredIndexType;
+
+  //! returned by find() if the given global index is not contained
+  static const IndexType invalid;
+
+  //! the dense layout is chosen, if at least every denseRatio'th index of the global index range is contained
+  static const size_t denseRatio = 4;
+
+  IndexLookup()
+    : dense_(false)
+    , strided_(false)
+    , size_(0)
+    , first_(0)
+    , base_(0)
+    , extents_()
+    , strides_()
+  {
+  }
+
+  /**
+   *  \param indexMap a sorted map (i.e. std::map) from global to local indices
+   */
+  template <class IndexMapType>
+  explicit IndexLookup(const IndexMapType& indexMap)
+    : dense_(false)
+    , strided_(false)
+    , size_(boost::numeric_cast<IndexType>(indexMap.size()))
+    , first_(0)
+    , base_(0)
+    , extents_()
+    , strides_()
+  {
+    if (indexMap.empty())
+      return;
+    strided_ = detectStrides(indexMap);
+    if (strided_)
+      return;
+    const size_t extent = size_t(indexMap.rbegin()->first) + 1;
+    dense_ = (indexMap.size() * denseRatio >= extent);
+    if (dense_) {
+      values_.resize(extent, storedInvalid());
+      for (typename IndexMapType::const_iterator it = indexMap.begin(); it != indexMap.end(); ++it)
+        values_[it->first] = Storage::store<StoredIndexType>(it->second);
+    } else {
+      keys_.reserve(indexMap.size());
+      values_.reserve(indexMap.size());
+      for (typename IndexMapType::const_iterator it = indexMap.begin(); it != indexMap.end(); ++it) {
+        keys_.push_back(Storage::store<StoredIndexType>(it->first));
+        values_.push_back(Storage::store<StoredIndexType>(it->second));
+      }
+    }
+  } // IndexLookup(...)
+
+  bool dense() const { return dense_; }
+
+  //! true, if the local indices are computed from the global ones
+  bool strided() const { return strided_; }
+
+  IndexType size() const { return size_; }
+
+  //! \return the local index, or invalid if globalIndex is not contained
+  IndexType find(const IndexType& globalIndex) const
+  {
+    if (strided_) {
+      if (size_t(globalIndex) < first_)
+        return invalid;
+      const size_t offset = size_t(globalIndex) - first_;
+      const size_t i2     = offset / strides_[2];
+      const size_t i1     = (offset % strides_[2]) / strides_[1];
+      const size_t i0     = (offset % strides_[2]) % strides_[1];
+      if (i0 >= extents_[0] || i1 >= extents_[1] || i2 >= extents_[2])
+        return invalid;
+      return IndexType(base_ + i0 + extents_[0] * (i1 + extents_[1] * i2));
+    }
+    if (dense_)
+      return (size_t(globalIndex) < values_.size()) ? unpack(values_[globalIndex]) : invalid;
+    if (keys_.empty())
+      return invalid;
+    // branchless binary search for the last key not greater than globalIndex
+    const StoredIndexType* base = &keys_[0];
+    size_t length = keys_.size();
+    while (length > 1) {
+      const size_t half = length / 2;
+      base              = (base[half] <= globalIndex) ? base + half : base;
+      length -= half;
+    }
+    return (*base == globalIndex) ? unpack(values_[base - &keys_[0]]) : invalid;
+  } // ... find(...)
+
+  bool contains(const IndexType& globalIndex) const { return find(globalIndex) != invalid; }
+
+private:
+  static StoredIndexType storedInvalid() { return std::numeric_limits<StoredIndexType>::max(); }
+
+  //! sets first_, base_, extents_ and strides_ and returns true, if indexMap has the strided layout
+  template <class IndexMapType>
+  bool detectStrides(const IndexMapType& indexMap)
+  {
+    const size_t size = indexMap.size();
+    const size_t base = size_t(indexMap.begin()->second);
+    std::vector<size_t> keys;
+    keys.reserve(size);
+    for (typename IndexMapType::const_iterator it = indexMap.begin(); it != indexMap.end(); ++it) {
+      if (size_t(it->second) != base + keys.size())
+        return false;
+      keys.push_back(size_t(it->first));
+    }
+    // the extents and strides of the box, the first rows and layers decide
+    const size_t first = keys[0];
+    std::array<size_t, 3> extents = {{1, 1, 1}};
+    std::array<size_t, 3> strides = {{1, 1, 1}};
+    while (extents[0] < size && keys[extents[0]] == first + extents[0])
+      ++extents[0];
+    strides[1] = (extents[0] < size) ? keys[extents[0]] - first : extents[0];
+    while (extents[0] * extents[1] < size && keys[extents[0] * extents[1]] == first + extents[1] * strides[1])
+      ++extents[1];
+    const size_t layer = extents[0] * extents[1];
+    if (size % layer != 0)
+      return false;
+    extents[2] = size / layer;
+    strides[2] = (layer < size) ? keys[layer] - first : strides[1] * extents[1];
+    // all global indices have to be in the box
+    for (size_t jj = 0; jj < size; ++jj) {
+      const size_t expected =
+          first + jj % extents[0] + ((jj / extents[0]) % extents[1]) * strides[1] + (jj / layer) * strides[2];
+      if (keys[jj] != expected)
+        return false;
+    }
+    first_   = first;
+    base_    = base;
+    extents_ = extents;
+    strides_ = strides;
+    return true;
+  } // ... detectStrides(...)
+
+  static IndexType unpack(const StoredIndexType& value)
+  {
+    return (value == storedInvalid()) ? invalid : IndexType(value);
+  }
+
+  bool dense_;
+  bool strided_;
+  IndexType size_;
+  size_t first_;
+  size_t base_;
+  std::array<size_t, 3> extents_;
+  std::array<size_t, 3> strides_;
+  std::vector<StoredIndexType> keys_;
+  std::vector<StoredIndexType> values_;
+}; // class IndexLookup
+
+template <class IndexImp>
+const IndexImp IndexLookup<IndexImp>::invalid = std::numeric_limits<IndexImp>::max();
+
+/**
+ *  \brief  Maximal number of codim subentities of an element of dimension dim (attained by the cube).
+ */
+template <int dim, int codim>
+struct MaxSubEntities
+{
+  static_assert(0 <= codim && codim <= dim, "Invalid codim!");
+  static const size_t value = MaxSubEntities<dim - 1, codim - 1>::value * 2 * dim / codim;
+};
+
+template <int dim>
+struct MaxSubEntities<dim, 0>
+{
+  static const size_t value = 1;
+};
+
+/**
+ *  \brief  Local subentity indices of all elements of a local index set, stored as compressed rows for each codim.
+ *
+ *          The subentity indices of the element with local index e are indices(codim)[offsets(codim)[e]] to
+ *          indices(codim)[offsets(codim)[e + 1] - 1], in the order of the reference element.
+ */
+template <class IndexImp, int dim>
+class Connectivity
+{
+public:
+  typedef IndexImp IndexType;
+
+  Connectivity()
+    : offsets_(dim + 1)
+    , indices_(dim + 1)
+  {
+  }
+
+  const std::vector<size_t>& offsets(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    return offsets_[codim];
+  }
+
+  std::vector<size_t>& offsets(const unsigned int codim)
+  {
+    assert(codim <= dim);
+    return offsets_[codim];
+  }
+
+  const std::vector<IndexType>& indices(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    return indices_[codim];
+  }
+
+  std::vector<IndexType>& indices(const unsigned int codim)
+  {
+    assert(codim <= dim);
+    return indices_[codim];
+  }
+
+  size_t size(const IndexType& element, const unsigned int codim) const
+  {
+    return offsets_[codim][element + 1] - offsets_[codim][element];
+  }
+
+  const IndexType* begin(const IndexType& element, const unsigned int codim) const
+  {
+    return &indices_[codim][0] + offsets_[codim][element];
+  }
+
+private:
+  std::vector<std::vector<size_t>> offsets_;
+  std::vector<std::vector<IndexType>> indices_;
+}; // class Connectivity
+
+/**
+ *  \brief  The immutable data of an IndexBased index set, derived once from the index container and shared by all
+ *          copies of the index set (and thus of the local grid part).
+ */
+template <class IndexImp, int dim>
+class IndexBasedData
+{
+public:
+  typedef IndexImp IndexType;
+
+  typedef Dune::GeometryType GeometryType;
+
+  //! the indices are stored as Storage::Index< IndexType >::type
+  typedef typename Storage::Index<IndexType>::type StoredIndexType;
+
+  typedef std::map<GeometryType, std::map<StoredIndexType, StoredIndexType>> IndexContainerType;
+
+  typedef IndexLookup<IndexType> IndexLookupType;
+
+  //! stores its indices as Storage::Index< IndexType >::type
+  typedef Connectivity<typename Storage::Index<IndexType>::type, dim> ConnectivityType;
+
+  //! maps a local index (of one codim) to the corresponding global one
+  typedef std::vector<typename Storage::Index<IndexType>::type> GlobalIndicesType;
+
+  explicit IndexBasedData(const Dune::shared_ptr<const IndexContainerType> indexContainer)
+    : indexContainer_(indexContainer)
+    , sizeByCodim_(dim + 1, IndexType(0))
+    , geometryTypesByCodim_(dim + 1)
+    , lookups_(GlobalGeometryTypeIndex::size(dim))
+    , lookupsByCodim_(dim + 1, &emptyLookup_)
+    , globalIndices_(dim + 1)
+  {
+    // get geometry types, compute sizes and build the lookups
+    for (typename IndexContainerType::const_iterator iterator = indexContainer_->begin();
+         iterator != indexContainer_->end();
+         ++iterator) {
+      const GeometryType& geometryType = iterator->first;
+      const unsigned int codim = dim - geometryType.dim();
+      assert(codim <= dim);
+      geometryTypesByCodim_[codim].push_back(geometryType);
+      lookups_[GlobalGeometryTypeIndex::index(geometryType)] = IndexLookupType(iterator->second);
+      sizeByCodim_[codim] += boost::numeric_cast<IndexType>(iterator->second.size());
+    }
+    for (unsigned int codim = 0; codim <= dim; ++codim)
+      if (geometryTypesByCodim_[codim].size() == 1)
+        lookupsByCodim_[codim] = &lookups_[GlobalGeometryTypeIndex::index(geometryTypesByCodim_[codim][0])];
+    // invert the index maps
+    for (unsigned int codim = 0; codim <= dim; ++codim)
+      globalIndices_[codim].resize(sizeByCodim_[codim]);
+    for (typename IndexContainerType::const_iterator iterator = indexContainer_->begin();
+         iterator != indexContainer_->end();
+         ++iterator) {
+      GlobalIndicesType& globalIndices = globalIndices_[dim - iterator->first.dim()];
+      for (typename IndexContainerType::mapped_type::const_iterator it = iterator->second.begin();
+           it != iterator->second.end();
+           ++it)
+        globalIndices[it->second] = Storage::store<typename GlobalIndicesType::value_type>(it->first);
+    }
+  } // IndexBasedData(...)
+
+  IndexBasedData(const IndexBasedData& other) = delete;
+
+  IndexBasedData& operator=(const IndexBasedData& other) = delete;
+
+  const Dune::shared_ptr<const IndexContainerType>& indexContainer() const { return indexContainer_; }
+
+  IndexType size(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    return sizeByCodim_[codim];
+  }
+
+  const std::vector<GeometryType>& geometryTypes(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    return geometryTypesByCodim_[codim];
+  }
+
+  const IndexLookupType& lookup(const GeometryType& geometryType) const
+  {
+    assert(GlobalGeometryTypeIndex::index(geometryType) < lookups_.size());
+    return lookups_[GlobalGeometryTypeIndex::index(geometryType)];
+  }
+
+  /**
+   *  \brief The lookup of the only GeometryType of the given codim.
+   *  \note  Only meaningful if there is at most one GeometryType of this codim (an empty lookup is returned if there is
+   *        none), see geometryTypes().
+   */
+  const IndexLookupType& lookup(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    assert(geometryTypesByCodim_[codim].size() <= 1);
+    return *lookupsByCodim_[codim];
+  }
+
+  const GlobalIndicesType& globalIndices(const unsigned int codim) const
+  {
+    assert(codim <= dim);
+    return globalIndices_[codim];
+  }
+
+  /**
+   *  \brief Returns the connectivity, which is computed by builder(connectivity) upon the first call (thread safe).
+   */
+  template <class BuilderType>
+  const ConnectivityType& connectivity(const BuilderType& builder) const
+  {
+    std::call_once(connectivityBuilt_, [&]() { builder(connectivity_); });
+    return connectivity_;
+  }
+
+  /**
+   *  \brief Returns the object of type T attached to this data, which is created by builder() (returning a
+   *         std::shared_ptr< T >) upon the first call (thread safe).
+   *
+   *         This allows grid parts to share further lazily computed data (as a GeometryCache) between all their copies,
+   *         although this class does not know their types. Keep the returned reference instead of calling this in a
+   *         hot loop, each call locks a mutex.
+   */
+  template <class T, class BuilderType>
+  const T& attached(const BuilderType& builder) const
+  {
+    std::shared_ptr<AttachedSlot> slot;
+    {
+      std::lock_guard<std::mutex> lock(attachedMutex_);
+      std::shared_ptr<AttachedSlot>& entry = attached_[std::type_index(typeid(T))];
+      if (!entry)
+        entry = std::make_shared<AttachedSlot>();
+      slot = entry;
+    }
+    // the builder is called without holding the lock, so it may itself use attached() for other types
+    std::call_once(slot->built, [&]() {
+      const std::shared_ptr<const T> object = builder();
+      slot->object = object;
+    });
+    return *static_cast<const T*>(slot->object.get());
+  } // ... attached(...)
+
+private:
+  struct AttachedSlot
+  {
+    std::once_flag built;
+    std::shared_ptr<const void> object;
+  };
+
+  const Dune::shared_ptr<const IndexContainerType> indexContainer_;
+  std::vector<IndexType> sizeByCodim_;
+  std::vector<std::vector<GeometryType>> geometryTypesByCodim_;
+  std::vector<IndexLookupType> lookups_;
+  const IndexLookupType emptyLookup_;
+  std::vector<const IndexLookupType*> lookupsByCodim_;
+  std::vector<GlobalIndicesType> globalIndices_;
+  mutable std::once_flag connectivityBuilt_;
+  mutable ConnectivityType connectivity_;
+  mutable std::mutex attachedMutex_;
+  mutable std::map<std::type_index, std::shared_ptr<AttachedSlot>> attached_;
+}; // class IndexBasedData
+
+namespace internal {
+
+/**
+ *  \brief  Selects the lookup of an entity (or of a subentity) of an IndexBasedData by the GeometryType of the entity.
+ */
+template <bool singleGeometryType>
+struct LookupSelector
+{
+  template <class DataType, class EntityType>
+  static const typename DataType::IndexLookupType& entity(const DataType& data, const EntityType& entity)
+  {
+    return data.lookup(entity.type());
+  }
+
+  //! \tparam entityDim dimension of the entity the subentity belongs to
+  template <class ctype, int entityDim, class DataType, class EntityType>
+  static const typename DataType::IndexLookupType* subEntity(const DataType& data, const EntityType& entity,
+                                                            const int i, const unsigned int codim,
+                                                            const unsigned int subCodim)
+  {
+    // if there is only one geometry type of the subentities codimension, we can skip the reference element
+    const std::vector<GeometryType>& geometryTypes = data.geometryTypes(subCodim);
+    if (geometryTypes.size() == 0)
+      return nullptr;
+    if (geometryTypes.size() == 1)
+      return &data.lookup(geometryTypes[0]);
+    const GeometryType subEntityType =
+        ReferenceElements<ctype, entityDim>::general(entity.type()).type(i, boost::numeric_cast<int>(codim));
+    return &data.lookup(subEntityType);
+  } // ... subEntity(...)
+}; // struct LookupSelector
+
+/**
+ *  \brief  All entities of one codim share the same GeometryType, so the lookups are selected by codim only.
+ */
+template <>
+struct LookupSelector<true>
+{
+  template <class DataType, class EntityType>
+  static const typename DataType::IndexLookupType& entity(const DataType& data, const EntityType& /*entity*/)
+  {
+    return data.lookup(static_cast<unsigned int>(EntityType::codimension));
+  }
+
+  template <class ctype, int entityDim, class DataType, class EntityType>
+  static const typename DataType::IndexLookupType* subEntity(const DataType& data, const EntityType& /*entity*/,
+                                                            const int /*i*/, const unsigned int /*codim*/,
+                                                            const unsigned int subCodim)
+  {
+    return &data.lookup(subCodim);
+  }
+}; // struct LookupSelector< true >
+
+} // namespace internal
+
 /**
  *  \brief      Given a Dune::IndexSet and a set of entity indices, provides an index set on those entities only.
+ *
+ *              All lookups (index(), subIndex() and contains()) are O(1), see IndexLookup. All data derived from the
+ *              index container is held in an IndexBasedData, so copying this index set is O(1). If the global grid
+ *              part has a single GeometryType per codim (see Capabilities::hasSingleGeometryType), the lookups are
+ *              selected by codim at compile time, without inspecting the GeometryType of the entities.
  *  \todo       Replace GlobalGridPartImp by Interface!
  *  \todo       Document!
  */
@@ -48,31 +526,40 @@ public:
 
   static const unsigned int dimension = GridType::dimension;
 
-  typedef std::map<GeometryType, std::map<IndexType, IndexType>> IndexContainerType;
+  typedef IndexBasedData<IndexType, dimension> DataType;
+
+  typedef typename DataType::IndexContainerType IndexContainerType;
+
+  typedef typename GridType::template Codim<0>::Entity ElementType;
+
+  typedef typename DataType::ConnectivityType ConnectivityType;
+
+  typedef typename DataType::GlobalIndicesType GlobalIndicesType;
+
+  static const bool singleGeometryType = Capabilities::hasSingleGeometryType<GlobalGridPartType>::v;
 
 private:
-  typedef std::map<IndexType, IndexType> Indices_MapType;
+  typedef typename DataType::IndexLookupType IndexLookupType;
+
+  typedef internal::LookupSelector<singleGeometryType> LookupSelectorType;
 
 public:
   IndexBased(const GlobalGridPartType& globalGridPart, const Dune::shared_ptr<const IndexContainerType> indexContainer)
     : BaseType(globalGridPart.indexSet())
-    , indexContainer_(indexContainer)
-    , sizeByCodim_(dimension + 1, IndexType(0))
-    , geometryTypesByCodim_(dimension + 1)
+    , globalGridPart_(&globalGridPart)
+    , data_(std::make_shared<DataType>(indexContainer))
   {
-    // get geometry types and compute sizes
-    for (typename IndexContainerType::const_iterator iterator = indexContainer_->begin();
-         iterator != indexContainer_->end();
-         ++iterator) {
-      const GeometryType& geometryType = iterator->first;
-      const IndexType size             = boost::numeric_cast<IndexType>(iterator->second.size());
-      const unsigned int codim = dimension - geometryType.dim();
-      geometryTypesByCodim_[codim].push_back(geometryType);
-      sizeByGeometryType_.insert(std::pair<GeometryType, IndexType>(geometryType, size));
-      assert(codim <= dimension);
-      sizeByCodim_[codim] += size;
-    }
-  } // IndexBased(const GridPartType& localGridPart)
+  }
+
+  //! does not touch data, so this is O(1)
+  IndexBased(const GlobalGridPartType& globalGridPart, const std::shared_ptr<const DataType> data)
+    : BaseType(globalGridPart.indexSet())
+    , globalGridPart_(&globalGridPart)
+    , data_(data)
+  {
+  }
+
+  const std::shared_ptr<const DataType>& data() const { return data_; }
 
   template <int cc>
   IndexType index(const typename GridType::template Codim<cc>::Entity& entity) const
@@ -91,26 +578,9 @@ public:
   {
     // get the global subindex
     const IndexType& globalSubIndex = BaseType::template subIndex<cc>(entity, i, codim);
-    const int subCodim = cc + codim;
-    assert(0 <= subCodim && subCodim <= int(dimension) && "This should not happen, we have a bad codimension");
-    const unsigned int subDim = dimension - subCodim;
-    // loop over all geometry types
-    for (typename IndexContainerType::const_iterator it = indexContainer_->begin(); it != indexContainer_->end();
-         ++it) {
-      // check if geometry type has correct dimension
-      const GeometryType& geometryType = it->first;
-      if (geometryType.dim() == subDim) {
-        // get the index map
-        const std::map<IndexType, IndexType>& indexMap = it->second;
-        // search for the global index
-        const typename std::map<IndexType, IndexType>::const_iterator result = indexMap.find(globalSubIndex);
-        if (result != indexMap.end()) {
-          // return the corresponding local index
-          const IndexType localSubIndex = result->second;
-          return localSubIndex;
-        } // search for the global index
-      }   // check if geometry type has correct dimension
-    }     // loop over all geometry types
+    const IndexType localSubIndex = findLocalSubIndex<dimension - cc>(entity, globalSubIndex, i, codim);
+    if (localSubIndex != IndexLookupType::invalid)
+      return localSubIndex;
     // if we came this far we did not find it
     std::stringstream msg;
     msg << std::endl
@@ -127,26 +597,10 @@ public:
   {
     // get the global subindex
     const IndexType& globalSubIndex = BaseType::subIndex(entity, i, codim);
-    const int subCodim = EntityType::codimension + codim;
-    assert(0 <= subCodim && subCodim <= int(dimension) && "This should not happen, we have a bad codimension");
-    const unsigned int subDim = dimension - subCodim;
-    // loop over all geometry types
-    for (typename IndexContainerType::const_iterator it = indexContainer_->begin(); it != indexContainer_->end();
-         ++it) {
-      // check if geometry type has correct dimension
-      const GeometryType& geometryType = it->first;
-      if (geometryType.dim() == subDim) {
-        // get the index map
-        const std::map<IndexType, IndexType>& indexMap = it->second;
-        // search for the global index
-        const typename std::map<IndexType, IndexType>::const_iterator result = indexMap.find(globalSubIndex);
-        if (result != indexMap.end()) {
-          // return the corresponding local index
-          const IndexType localSubIndex = result->second;
-          return localSubIndex;
-        } // search for the global index
-      }   // check if geometry type has correct dimension
-    }     // loop over all geometry types
+    const IndexType localSubIndex =
+        findLocalSubIndex<dimension - EntityType::codimension>(entity, globalSubIndex, i, codim);
+    if (localSubIndex != IndexLookupType::invalid)
+      return localSubIndex;
     // if we came this far we did not find it
     std::stringstream msg;
     msg << std::endl
@@ -156,87 +610,164 @@ public:
     DUNE_THROW(Dune::InvalidStateException, msg.str());
   } // IndexType subIndex(const EntityType& entity, int i, unsigned int codim) const
 
-  const std::vector<GeometryType>& geomTypes(int codim) const { return geometryTypesByCodim_[codim]; }
+  /**
+   *  \brief Local indices of all codim subentities of all elements.
+   *  \note  Computed (in a thread safe manner) upon the first call by walking the elements of this index set once (see
+   *        Iterator::Local::IndexBased), shared by all copies of this index set.
+   */
+  const ConnectivityType& connectivity() const
+  {
+    return data_->connectivity([&](ConnectivityType& connectivity) { this->buildConnectivity(connectivity); });
+  }
+
+  /**
+   *  \brief  Fills indices with the local indices of all codim subentities of element (which is equivalent to calling
+   *          subIndex(element, i, codim) for all i).
+   *  \return the number of subentities
+   */
+  template <size_t N>
+  size_t subIndices(const ElementType& element, const unsigned int codim, std::array<IndexType, N>& indices) const
+  {
+    const ConnectivityType& conn = connectivity();
+    const IndexType localIndex   = getIndex(element);
+    const size_t count = conn.size(localIndex, codim);
+    assert(count <= N && "Given array is too small, use MaxSubEntities!");
+    std::copy(conn.begin(localIndex, codim), conn.begin(localIndex, codim) + count, indices.begin());
+    return count;
+  } // ... subIndices(...)
+
+  /**
+   *  \brief  Fills indices with the local indices of all codim subentities of all given elements (given by their
+   *          local index), indices[ii*stride + jj] is the jj'th subindex of elements[ii].
+   *
+   *          Rows of elements with less than stride subentities are padded with IndexLookup< IndexType >::invalid.
+   *  \return stride, which is maxSubEntities(codim)
+   */
+  template <class ElementIndicesType>
+  size_t subIndices(const ElementIndicesType& elements, const unsigned int codim, std::vector<IndexType>& indices) const
+  {
+    const ConnectivityType& conn = connectivity();
+    const size_t stride          = maxSubEntities(codim);
+    indices.assign(elements.size() * stride, IndexLookupType::invalid);
+    size_t row = 0;
+    for (typename ElementIndicesType::const_iterator it = elements.begin(); it != elements.end(); ++it, ++row) {
+      const size_t count = conn.size(*it, codim);
+      std::copy(conn.begin(*it, codim), conn.begin(*it, codim) + count, indices.begin() + row * stride);
+    }
+    return stride;
+  } // ... subIndices(...)
 
-  IndexType size(GeometryType type) const
+  //! runtime version of MaxSubEntities
+  static size_t maxSubEntities(const unsigned int codim)
   {
-    assert(sizeByGeometryType_.find(type) != sizeByGeometryType_.end());
-    return sizeByGeometryType_.find(type)->second;
+    assert(codim <= dimension);
+    size_t result = 1;
+    for (unsigned int ii = 0; ii < codim; ++ii)
+      result = result * 2 * (dimension - ii) / (ii + 1);
+    return result;
   }
 
+  /**
+   *  \brief Global index of each local codim index, i.e. globalIndices(codim)[index(entity)] is the index of entity in
+   *        the global index set.
+   *  \note  Since global indices are only unique per GeometryType, this is only meaningful for grids with one
+   *        GeometryType per codim.
+   */
+  const GlobalIndicesType& globalIndices(const unsigned int codim) const { return data_->globalIndices(codim); }
+
+  const std::vector<GeometryType>& geomTypes(int codim) const { return data_->geometryTypes(codim); }
+
+  IndexType size(GeometryType type) const { return lookup(type).size(); }
+
   IndexType size(int codim) const
   {
     assert(0 <= codim);
     assert(codim <= int(dimension));
-    return sizeByCodim_[codim];
+    return data_->size(codim);
   }
 
   template <class EntityType>
   bool contains(const EntityType& entity) const
   {
-    // check if we have an index map for this GeometryType
-    const GeometryType& geometryType                           = entity.type();
-    const typename IndexContainerType::const_iterator indexMap = indexContainer_->find(geometryType);
-    if (indexMap != indexContainer_->end()) {
-      // check if this entity is listen in the map
-      const IndexType globalIndex = BaseType::index(entity);
-      if (indexMap->second.find(globalIndex) != indexMap->second.end())
-        return true;
-      else
-        return false;
-    } else
-      return false;
-  } // bool contains(const EntityType& entity) const
+    return LookupSelectorType::entity(*data_, entity).contains(BaseType::index(entity));
+  }
 
 private:
-  //! \todo This method can be optimized by the use of assert()s instead of if()s and throw()s!
+  const IndexLookupType& lookup(const GeometryType& geometryType) const { return data_->lookup(geometryType); }
+
   template <class EntityType>
   IndexType getIndex(const EntityType& entity) const
   {
-    // check if we have an index map for this GeometryType
-    const GeometryType& geometryType                           = entity.type();
-    const typename IndexContainerType::const_iterator indexMap = indexContainer_->find(geometryType);
-    if (indexMap != indexContainer_->end()) {
-      // check if this entity is listen in the map
-      const IndexType globalIndex                              = BaseType::index(entity);
-      const typename Indices_MapType::const_iterator indexPair = indexMap->second.find(globalIndex);
-      if (indexPair != indexMap->second.end())
-        return indexPair->second;
-      else
-        DUNE_THROW(Dune::InvalidStateException, "Given entity not contained in index set!");
-    } else
-      DUNE_THROW(Dune::InvalidStateException, "Given geometry not contained in index set!");
+    const IndexType localIndex = LookupSelectorType::entity(*data_, entity).find(BaseType::index(entity));
+    if (localIndex == IndexLookupType::invalid)
+      DUNE_THROW(Dune::InvalidStateException, "Given entity not contained in index set!");
+    return localIndex;
   } // IndexType getIndex(const EntityType& entity) const
 
-  IndexType findLocalIndex(const IndexType& globalIndex) const
-  {
-    // find the map with this global index and return the local one
-    for (typename IndexContainerType::const_iterator it = indexContainer_->begin(); it != indexContainer_->end();
-         ++it) {
-      const Indices_MapType& indicesMap                        = it->second;
-      const typename Indices_MapType::const_iterator indexPair = indicesMap.find(globalIndex);
-      if (indexPair != indicesMap.end())
-        return indexPair->second;
-      else {
-        std::cerr << std::endl
-                  << "Error in indexContainer_[" << it->first << "]: globalIndex " << globalIndex << " not found!"
-                  << std::endl;
-        std::cerr << "  ";
-        for (typename Indices_MapType::const_iterator indexIt = indicesMap.begin(); indexIt != indicesMap.end();
-             ++indexIt) {
-          std::cerr << "(" << indexIt->first << "/" << indexIt->second << "), ";
-        }
-        std::cerr << std::endl;
+  //! \tparam entityDim dimension of the entity the subentity belongs to
+  template <int entityDim, class EntityType>
+  IndexType findLocalSubIndex(const EntityType& entity, const IndexType& globalSubIndex, const int i,
+                              const unsigned int codim) const
+  {
+    const int subCodim = int(dimension) - entityDim + int(codim);
+    assert(0 <= subCodim && subCodim <= int(dimension) && "This should not happen, we have a bad codimension");
+    const IndexLookupType* subLookup = LookupSelectorType::template subEntity<typename GridType::ctype, entityDim>(
+        *data_, entity, i, codim, subCodim);
+    return subLookup ? subLookup->find(globalSubIndex) : IndexLookupType::invalid;
+  } // ... findLocalSubIndex(...)
+
+  void buildConnectivity(ConnectivityType& connectivity) const
+  {
+    typedef typename GridType::ctype ctype;
+    typedef typename ConnectivityType::IndexType StoredIndexType;
+    const size_t numElements = size(0);
+    typedef Iterator::Local::IndexBased<GlobalGridPartType, 0, All_Partition> ElementIteratorType;
+    // walk our elements and collect their subindices (in the order of the walk)
+    std::vector<IndexType> order;
+    order.reserve(numElements);
+    std::vector<std::vector<StoredIndexType>> walkIndices(dimension + 1);
+    for (unsigned int codim = 1; codim <= dimension; ++codim)
+      connectivity.offsets(codim).assign(numElements + 1, 0);
+    const ElementIteratorType entityItEnd(*globalGridPart_, data_, true);
+    for (ElementIteratorType entityIt(*globalGridPart_, data_); entityIt != entityItEnd; ++entityIt) {
+      const auto& entity         = *entityIt;
+      const IndexType localIndex = getIndex(entity);
+      order.push_back(localIndex);
+      const auto& referenceElement = ReferenceElements<ctype, dimension>::general(entity.type());
+      for (unsigned int codim = 1; codim <= dimension; ++codim) {
+        const int count = referenceElement.size(codim);
+        connectivity.offsets(codim)[localIndex + 1] = count;
+        for (int ii = 0; ii < count; ++ii)
+          walkIndices[codim].push_back(Storage::store<StoredIndexType>(subIndex(entity, ii, codim)));
       }
-    } // find the map with this global index and return the local one
-    // we should not come this far
-    DUNE_THROW(Dune::InvalidStateException, "Given entity not contained in index set!");
-  } // IndexType findLocalIndex(const IndexType& globalIndex) const
+    } // walk our elements and collect their subindices
+    assert(order.size() == numElements);
+    // codim 0 is trivial
+    connectivity.offsets(0).resize(numElements + 1);
+    connectivity.indices(0).resize(numElements);
+    for (size_t ii = 0; ii < numElements; ++ii) {
+      connectivity.offsets(0)[ii] = ii;
+      connectivity.indices(0)[ii] = Storage::store<StoredIndexType>(ii);
+    }
+    connectivity.offsets(0)[numElements] = numElements;
+    // sort the others by local element index
+    for (unsigned int codim = 1; codim <= dimension; ++codim) {
+      std::vector<size_t>& offsets = connectivity.offsets(codim);
+      for (size_t ii = 0; ii < numElements; ++ii)
+        offsets[ii + 1] += offsets[ii];
+      std::vector<StoredIndexType>& indices = connectivity.indices(codim);
+      indices.resize(offsets[numElements]);
+      typename std::vector<StoredIndexType>::const_iterator source = walkIndices[codim].begin();
+      for (size_t ii = 0; ii < order.size(); ++ii) {
+        const size_t count = offsets[order[ii] + 1] - offsets[order[ii]];
+        std::copy(source, source + count, indices.begin() + offsets[order[ii]]);
+        source += count;
+      }
+    } // sort the others by local element index
+  } // ... buildConnectivity(...)
 
-  const Dune::shared_ptr<const IndexContainerType> indexContainer_;
-  std::vector<IndexType> sizeByCodim_;
-  std::vector<std::vector<GeometryType>> geometryTypesByCodim_;
-  std::map<GeometryType, IndexType> sizeByGeometryType_;
+  const GlobalGridPartType* globalGridPart_;
+  std::shared_ptr<const DataType> data_;
 }; // class IndexBased
 
 template <class GlobalGridPartType>
@@ -12,6 +12,8 @@
 
 #include <dune/common/shared_ptr.hh>
 
+#include <dune/grid/part/storage.hh>
+
 namespace Dune {
 
 namespace grid {
@@ -38,7 +40,8 @@ public:
 
   typedef typename GlobalGridPartType::IndexSetType::IndexType IndexType;
 
-  typedef std::vector<int> IndexContainerType;
+  //! local indices of the intersections, see Storage
+  typedef std::vector<Storage::FaceType> IndexContainerType;
 
   Local(const GlobalGridPartType& globalGridPart, const EntityType& entity, const IndexContainerType& indexContainer,
         const bool end = false)
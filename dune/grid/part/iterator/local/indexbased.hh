@@ -7,11 +7,10 @@
 #define DUNE_GRID_PART_ITERATOR_CODIM0_HH
 
 // system
-#include <map>
+#include <memory>
 
 // dune-common
 #include <dune/common/exceptions.hh>
-#include <dune/common/shared_ptr.hh>
 
 // dune-geometry
 #include <dune/geometry/type.hh>
@@ -19,14 +18,85 @@
 // dune-grid
 #include <dune/grid/common/grid.hh>
 
+// dune-grid-multiscale
+#include <dune/grid/part/capabilities.hh>
+
 namespace Dune {
 namespace grid {
 namespace Part {
+namespace IndexSet {
+namespace Local {
+
+// see dune/grid/part/indexset/local.hh, which includes this header
+template <class IndexImp, int dim>
+class IndexBasedData;
+
+namespace internal {
+
+template <bool singleGeometryType>
+struct LookupSelector;
+
+} // namespace internal
+} // namespace Local
+} // namespace IndexSet
 namespace Iterator {
 namespace Local {
+namespace internal {
+
+/**
+ *  \brief  Decides for the entities visited by IndexBased, if they belong to the local grid part, and keeps track of
+ *          how many of them are still to be visited.
+ *
+ *          The entities are looked up in the IndexLookup of their GeometryType (selected by
+ *          IndexSet::Local::internal::LookupSelector, i.e. by codim only if there is a single GeometryType per codim),
+ *          so each visit is O(1).
+ */
+template <class DataImp, bool singleGeometryType>
+class IndexBasedVisitor
+{
+public:
+  typedef DataImp DataType;
+  typedef typename DataType::IndexType IndexType;
+
+  IndexBasedVisitor()
+    : data_(nullptr)
+    , remaining_(0)
+  {
+  }
+
+  void init(const DataType& data, const unsigned int codim)
+  {
+    data_      = &data;
+    remaining_ = size_t(data.size(codim));
+  }
+
+  bool done() const { return remaining_ == 0; }
+
+  //! \return true, if entity (with the given global index) belongs to the local grid part
+  template <class EntityType>
+  bool visit(const EntityType& entity, const IndexType& index)
+  {
+    if (!LookupSelectorType::entity(*data_, entity).contains(index))
+      return false;
+    --remaining_;
+    return true;
+  } // ... visit(...)
+
+private:
+  typedef IndexSet::Local::internal::LookupSelector<singleGeometryType> LookupSelectorType;
+
+  const DataType* data_;
+  size_t remaining_;
+}; // class IndexBasedVisitor
+
+} // namespace internal
 
 /**
- *  \brief  Iterates over those entities of a grid part, the indices of which match predefined ones.
+ *  \brief  Iterates over those entities of a grid part, the indices of which are contained in the given
+ *          IndexSet::Local::IndexBasedData.
+ *  \note   If the grid part has a single GeometryType per codim (see Capabilities::hasSingleGeometryType), the
+ *          GeometryType of the visited entities is never inspected.
+ *  \note   The walk over the grid part stops as soon as all entities of the data have been visited.
  *  \todo   Replace GlobalGridPartImp with Interface< GlobalGridPartTraitsImp >!
  *  \todo   Document!
  */
@@ -44,40 +114,30 @@ public:
 
   typedef Dune::GeometryType GeometryType;
 
-private:
-  typedef std::map<IndexType, IndexType> IndexMapType;
-
-public:
-  typedef std::map<GeometryType, std::map<IndexType, IndexType>> IndexContainerType;
+  typedef IndexSet::Local::IndexBasedData<IndexType, GlobalGridPartType::GridType::dimension> DataType;
 
   typedef typename BaseType::Entity Entity;
 
-  IndexBased(const GlobalGridPartType& globalGridPart, const Dune::shared_ptr<const IndexContainerType> indexContainer,
-             const bool end = false)
+  static const bool singleGeometryType = Capabilities::hasSingleGeometryType<GlobalGridPartType>::v;
+
+private:
+  typedef internal::IndexBasedVisitor<DataType, singleGeometryType> VisitorType;
+
+public:
+  IndexBased(const GlobalGridPartType& globalGridPart, const std::shared_ptr<const DataType> data, const bool end = false)
     : BaseType(end ? globalGridPart.template end<codim, pitype>() : globalGridPart.template begin<codim, pitype>())
     , globalGridPart_(globalGridPart)
-    , indexContainer_(indexContainer)
-    , workAtAll_(0)
+    , data_(data)
   {
     if (!end) {
-      // loop over all GeometryTypes
-      for (typename IndexContainerType::const_iterator iterator = indexContainer_->begin();
-           iterator != indexContainer_->end();
-           ++iterator) {
-        // treat only the codim 0 ones
-        if (iterator->first.dim() == (GlobalGridPartType::GridType::dimension - codim)) {
-          ++workAtAll_;
-          last_.insert(std::make_pair(iterator->first, iterator->second.rbegin()->first));
-          end_.insert(std::make_pair(iterator->first, iterator->second.end()));
-        } // treat only the codim 0 ones
-      }   // loop over all GeometryTypes
+      visitor_.init(*data_, codim);
       forward();
-    } // if (!end)
-  }   // IndexBased
+    }
+  } // IndexBased
 
   ThisType& operator++()
   {
-    if (workAtAll_ > 0) {
+    if (!visitor_.done()) {
       BaseType::operator++();
       forward();
     } else
@@ -89,30 +149,17 @@ private:
   //! iterates forward until we find the next entity that belongs to the local grid part
   void forward()
   {
-    bool found = false;
-    while (!found && (workAtAll_ > 0)) {
-      const Entity& entity                                 = BaseType::operator*();
-      const IndexType& index                               = globalGridPart_.indexSet().index(entity);
-      const GeometryType& geometryType                     = entity.type();
-      typename IndexContainerType::const_iterator indexMap = indexContainer_->find(geometryType);
-      if (indexMap != indexContainer_->end()) {
-        const typename IndexMapType::const_iterator result = indexMap->second.find(index);
-        if ((result != end_.find(geometryType)->second)) {
-          found = true;
-          if (result->first == last_.find(geometryType)->second)
-            --workAtAll_;
-        } else
-          BaseType::operator++();
-      } else
-        BaseType::operator++();
+    while (!visitor_.done()) {
+      const Entity& entity = BaseType::operator*();
+      if (visitor_.visit(entity, globalGridPart_.indexSet().index(entity)))
+        return;
+      BaseType::operator++();
     }
   } // void forward()
 
   const GlobalGridPartType& globalGridPart_;
-  const Dune::shared_ptr<const IndexContainerType> indexContainer_;
-  unsigned int workAtAll_;
-  std::map<GeometryType, IndexType> last_;
-  std::map<GeometryType, typename IndexMapType::const_iterator> end_;
+  const std::shared_ptr<const DataType> data_;
+  VisitorType visitor_;
 }; // class IndexBased
 
 } // namespace Local
@@ -0,0 +1,132 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_LOCAL_COLORING_HH
+#define DUNE_GRID_PART_LOCAL_COLORING_HH
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Local {
+
+/**
+ *  \brief  Coloring of the elements of a local grid part, such that no two elements of the same color share a codim
+ *          subentity (use codim = dimension for vertices, e.g. for continuous Lagrange spaces, and codim = 1 for faces,
+ *          e.g. for DG).
+ *
+ *          The elements of one color can thus be assembled concurrently without locking, e.g.
+ *            for (size_t cc = 0; cc < coloring.numColors(); ++cc)
+ *              parallel_for(0, coloring.size(cc), [&](const size_t ii) { assemble(coloring.begin(cc)[ii]); });
+ *          The elements of each color are stored contiguously, sorted by local index. The coloring is computed greedily
+ *          in the order of the local indices.
+ */
+template <class IndexImp, int codim>
+class ElementColoring
+{
+public:
+  typedef IndexImp IndexType;
+
+  template <class ConnectivityType>
+  explicit ElementColoring(const ConnectivityType& connectivity)
+  {
+    const std::vector<size_t>& offsets    = connectivity.offsets(codim);
+    const auto& indices                   = connectivity.indices(codim);
+    const size_t numElements = offsets.empty() ? 0 : offsets.size() - 1;
+    // invert the connectivity: subentity -> elements
+    size_t numSubEntities = 0;
+    for (size_t ii = 0; ii < indices.size(); ++ii)
+      numSubEntities = std::max(numSubEntities, size_t(indices[ii]) + 1);
+    std::vector<size_t> subEntityOffsets(numSubEntities + 1, 0);
+    for (size_t ii = 0; ii < indices.size(); ++ii)
+      ++subEntityOffsets[indices[ii] + 1];
+    for (size_t ss = 0; ss < numSubEntities; ++ss)
+      subEntityOffsets[ss + 1] += subEntityOffsets[ss];
+    std::vector<IndexType> subEntityElements(indices.size());
+    std::vector<size_t> position(subEntityOffsets.begin(), subEntityOffsets.end() - 1);
+    for (size_t ee = 0; ee < numElements; ++ee)
+      for (size_t ii = offsets[ee]; ii < offsets[ee + 1]; ++ii)
+        subEntityElements[position[indices[ii]]++] = boost::numeric_cast<IndexType>(ee);
+    // color greedily, forbidden[c] == ee means color c is used by a neighbor of ee
+    colors_.assign(numElements, 0);
+    std::vector<size_t> forbidden;
+    size_t numColors = 0;
+    for (size_t ee = 0; ee < numElements; ++ee) {
+      for (size_t ii = offsets[ee]; ii < offsets[ee + 1]; ++ii) {
+        const IndexType subEntity = indices[ii];
+        for (size_t jj = subEntityOffsets[subEntity]; jj < subEntityOffsets[subEntity + 1]; ++jj) {
+          const size_t neighbor = subEntityElements[jj];
+          if (neighbor < ee)
+            forbidden[colors_[neighbor]] = ee;
+        }
+      }
+      size_t color = 0;
+      while (color < numColors && forbidden[color] == ee)
+        ++color;
+      if (color == numColors) {
+        ++numColors;
+        forbidden.push_back(std::numeric_limits<size_t>::max());
+      }
+      colors_[ee] = boost::numeric_cast<unsigned int>(color);
+    }
+    // store the color classes contiguously
+    classOffsets_.assign(numColors + 1, 0);
+    for (size_t ee = 0; ee < numElements; ++ee)
+      ++classOffsets_[colors_[ee] + 1];
+    for (size_t cc = 0; cc < numColors; ++cc)
+      classOffsets_[cc + 1] += classOffsets_[cc];
+    classElements_.resize(numElements);
+    std::vector<size_t> classPosition(classOffsets_.begin(), classOffsets_.end() - 1);
+    for (size_t ee = 0; ee < numElements; ++ee)
+      classElements_[classPosition[colors_[ee]]++] = boost::numeric_cast<IndexType>(ee);
+  } // ElementColoring(...)
+
+  size_t numColors() const { return classOffsets_.size() - 1; }
+
+  //! the color of the element with the given local index
+  unsigned int color(const IndexType& element) const
+  {
+    assert(size_t(element) < colors_.size());
+    return colors_[element];
+  }
+
+  //! the number of elements of the given color
+  size_t size(const size_t color) const
+  {
+    assert(color < numColors());
+    return classOffsets_[color + 1] - classOffsets_[color];
+  }
+
+  //! local indices of the elements of the given color are [begin(color), end(color))
+  const IndexType* begin(const size_t color) const
+  {
+    assert(color < numColors());
+    return classElements_.data() + classOffsets_[color];
+  }
+
+  const IndexType* end(const size_t color) const
+  {
+    assert(color < numColors());
+    return classElements_.data() + classOffsets_[color + 1];
+  }
+
+private:
+  std::vector<unsigned int> colors_;
+  std::vector<size_t> classOffsets_;
+  std::vector<IndexType> classElements_;
+}; // class ElementColoring
+
+} // namespace Local
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_LOCAL_COLORING_HH
@@ -0,0 +1,216 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_LOCAL_ENTITYRANGE_HH
+#define DUNE_GRID_PART_LOCAL_ENTITYRANGE_HH
+
+#include <vector>
+#include <cassert>
+#include <iterator>
+#include <algorithm>
+
+#include <dune/common/version.hh>
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Local {
+
+/**
+ *  \brief  Random access range over all codim entities of a local grid part, ordered by their local index.
+ *
+ *          The range only stores one entity seed per entity, entities are created on demand. It can thus be split
+ *          arbitrarily among threads, e.g. by Dune::grid::Multiscale::parallel_for(0, range.size(), ...) or by a
+ *          parallel STL algorithm on [begin(), end()). range[ii] is the entity with local index ii.
+ *  \note   Before dune-grid 2.4, range[ii] returns an EntityPointer (since grid.entityPointer(seed) does), afterwards an
+ *          Entity.
+ *  \note   Since the entities are created on demand, dereferencing an Iterator yields a value, not a reference (as for
+ *          other proxy iterators), and operator-> returns a Pointer holding that value.
+ */
+template <class GridImp, int codim>
+class EntityRange
+{
+public:
+  typedef GridImp GridType;
+  typedef EntityRange<GridType, codim> ThisType;
+  typedef typename GridType::template Codim<codim>::Entity EntityType;
+  typedef typename GridType::template Codim<codim>::EntitySeed EntitySeedType;
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 4)
+  typedef EntityType ValueType;
+#else
+  typedef typename GridType::template Codim<codim>::EntityPointer ValueType;
+#endif
+
+  //! holds the value of an entity created on demand, so that it->foo() works
+  class Pointer
+  {
+  public:
+    explicit Pointer(const ValueType& value)
+      : value_(value)
+    {
+    }
+
+    const ValueType* operator->() const { return &value_; }
+
+  private:
+    const ValueType value_;
+  }; // class Pointer
+
+  class Iterator
+  {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename ThisType::ValueType value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename ThisType::Pointer pointer;
+    typedef value_type reference;
+
+    Iterator()
+      : range_(nullptr)
+      , index_(0)
+    {
+    }
+
+    Iterator(const ThisType& range, const size_t index)
+      : range_(&range)
+      , index_(index)
+    {
+    }
+
+    reference operator*() const { return (*range_)[index_]; }
+
+    pointer operator->() const { return pointer((*range_)[index_]); }
+
+    reference operator[](const difference_type nn) const { return (*range_)[index_ + nn]; }
+
+    //! the local index of the current entity
+    size_t index() const { return index_; }
+
+    Iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator tmp(*this);
+      ++index_;
+      return tmp;
+    }
+
+    Iterator& operator--()
+    {
+      --index_;
+      return *this;
+    }
+
+    Iterator operator--(int)
+    {
+      Iterator tmp(*this);
+      --index_;
+      return tmp;
+    }
+
+    Iterator& operator+=(const difference_type nn)
+    {
+      index_ += nn;
+      return *this;
+    }
+
+    Iterator& operator-=(const difference_type nn)
+    {
+      index_ -= nn;
+      return *this;
+    }
+
+    Iterator operator+(const difference_type nn) const { return Iterator(*range_, index_ + nn); }
+
+    friend Iterator operator+(const difference_type nn, const Iterator& it) { return it + nn; }
+
+    Iterator operator-(const difference_type nn) const { return Iterator(*range_, index_ - nn); }
+
+    difference_type operator-(const Iterator& other) const
+    {
+      return difference_type(index_) - difference_type(other.index_);
+    }
+
+    bool operator==(const Iterator& other) const { return index_ == other.index_; }
+    bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+    bool operator<(const Iterator& other) const { return index_ < other.index_; }
+    bool operator>(const Iterator& other) const { return index_ > other.index_; }
+    bool operator<=(const Iterator& other) const { return index_ <= other.index_; }
+    bool operator>=(const Iterator& other) const { return index_ >= other.index_; }
+
+  private:
+    const ThisType* range_;
+    size_t index_;
+  }; // class Iterator
+
+  typedef Iterator iterator;
+  typedef Iterator const_iterator;
+
+  /**
+   * \brief Collects the seeds of all codim entities of the given grid part, which has to provide begin< codim >(),
+   *        end< codim >() and indexSet() with consecutive indices per codim.
+   */
+  template <class GridPartType>
+  explicit EntityRange(const GridPartType& gridPart)
+    : grid_(gridPart.grid())
+  {
+    typedef std::pair<size_t, EntitySeedType> IndexAndSeedType;
+    std::vector<IndexAndSeedType> indicesAndSeeds;
+    indicesAndSeeds.reserve(gridPart.indexSet().size(codim));
+    const auto itEnd = gridPart.template end<codim>();
+    for (auto it = gridPart.template begin<codim>(); it != itEnd; ++it) {
+      const auto& entity = *it;
+      indicesAndSeeds.push_back(IndexAndSeedType(gridPart.indexSet().index(entity), entity.seed()));
+    }
+    std::sort(indicesAndSeeds.begin(),
+              indicesAndSeeds.end(),
+              [](const IndexAndSeedType& a, const IndexAndSeedType& b) { return a.first < b.first; });
+    seeds_.reserve(indicesAndSeeds.size());
+    for (size_t ii = 0; ii < indicesAndSeeds.size(); ++ii) {
+      assert(indicesAndSeeds[ii].first == ii && "The local indices have to be consecutive!");
+      seeds_.push_back(indicesAndSeeds[ii].second);
+    }
+  } // EntityRange(...)
+
+  size_t size() const { return seeds_.size(); }
+
+  bool empty() const { return seeds_.empty(); }
+
+  const EntitySeedType& seed(const size_t ii) const
+  {
+    assert(ii < seeds_.size());
+    return seeds_[ii];
+  }
+
+  const std::vector<EntitySeedType>& seeds() const { return seeds_; }
+
+  ValueType operator[](const size_t ii) const
+  {
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 4)
+    return grid_.entity(seed(ii));
+#else
+    return grid_.entityPointer(seed(ii));
+#endif
+  }
+
+  Iterator begin() const { return Iterator(*this, 0); }
+
+  Iterator end() const { return Iterator(*this, seeds_.size()); }
+
+private:
+  const GridType& grid_;
+  std::vector<EntitySeedType> seeds_;
+}; // class EntityRange
+
+} // namespace Local
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_LOCAL_ENTITYRANGE_HH
@@ -0,0 +1,95 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_LOCAL_FACEPAIRS_HH
+#define DUNE_GRID_PART_LOCAL_FACEPAIRS_HH
+
+#include <tuple>
+#include <vector>
+
+#include <dune/grid/part/local/geometrycache.hh>
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Local {
+
+/**
+ *  \brief  One intersection of a coupling, given by the local indices of both elements (in their respective local grid
+ *          parts) and the local indices of the intersection in both elements.
+ */
+template <class IndexImp>
+struct FacePair
+{
+  typedef IndexImp IndexType;
+
+  IndexType insideLocal;
+  int insideFace;
+  IndexType outsideLocal;
+  int outsideFace;
+
+  bool operator<(const FacePair& other) const
+  {
+    return std::tie(insideLocal, insideFace, outsideLocal, outsideFace)
+           < std::tie(other.insideLocal, other.insideFace, other.outsideLocal, other.outsideFace);
+  }
+}; // struct FacePair
+
+/**
+ *  \brief  Geometric data of the intersections of a face pair table (see FacePair), stored as structure of arrays in
+ *          the same order as the table.
+ *
+ *          centers(dd)[pp] is the dd'th coordinate of the center of the pp'th intersection, unitOuterNormals(dd)[pp] the
+ *          dd'th component of its unit outer normal (with respect to the inside element) at the center.
+ */
+template <class ctype, int dimworld>
+class FacePairGeometries
+{
+public:
+  typedef std::vector<ctype, AlignedAllocator<ctype>> ArrayType;
+
+  explicit FacePairGeometries(const size_t size)
+    : size_(size)
+    , centers_(dimworld * size_)
+    , unitOuterNormals_(dimworld * size_)
+    , volumes_(size_)
+  {
+  }
+
+  size_t size() const { return size_; }
+
+  const ctype* centers(const size_t component) const { return &centers_[component * size_]; }
+
+  const ctype* unitOuterNormals(const size_t component) const { return &unitOuterNormals_[component * size_]; }
+
+  const ctype* volumes() const { return &volumes_[0]; }
+
+  //! used to fill the data
+  template <class IntersectionType>
+  void set(const size_t pair, const IntersectionType& intersection)
+  {
+    const auto geometry = intersection.geometry();
+    const auto center   = geometry.center();
+    const auto normal   = intersection.centerUnitOuterNormal();
+    for (size_t dd = 0; dd < dimworld; ++dd) {
+      centers_[dd * size_ + pair]          = center[dd];
+      unitOuterNormals_[dd * size_ + pair] = normal[dd];
+    }
+    volumes_[pair] = geometry.volume();
+  } // ... set(...)
+
+private:
+  const size_t size_;
+  ArrayType centers_;
+  ArrayType unitOuterNormals_;
+  ArrayType volumes_;
+}; // class FacePairGeometries
+
+} // namespace Local
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_LOCAL_FACEPAIRS_HH
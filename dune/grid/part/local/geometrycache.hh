@@ -0,0 +1,236 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_LOCAL_GEOMETRYCACHE_HH
+#define DUNE_GRID_PART_LOCAL_GEOMETRYCACHE_HH
+
+#include <new>
+#include <limits>
+#include <vector>
+#include <cstdint>
+
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/part/indexset/local.hh>
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Local {
+
+/**
+ *  \brief  Minimal allocator returning memory aligned to alignment bytes.
+ */
+template <class T, size_t alignment = 64>
+class AlignedAllocator
+{
+public:
+  typedef T value_type;
+
+  template <class U>
+  struct rebind
+  {
+    typedef AlignedAllocator<U, alignment> other;
+  };
+
+  AlignedAllocator() {}
+
+  template <class U>
+  AlignedAllocator(const AlignedAllocator<U, alignment>& /*other*/)
+  {
+  }
+
+  T* allocate(const size_t n)
+  {
+    // store the pointer we got from new in front of the aligned block
+    char* const raw = static_cast<char*>(::operator new(n * sizeof(T) + alignment + sizeof(void*)));
+    const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(raw + sizeof(void*));
+    char* const aligned = raw + sizeof(void*) + ((alignment - first % alignment) % alignment);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<T*>(aligned);
+  }
+
+  void deallocate(T* ptr, const size_t /*n*/) { ::operator delete(reinterpret_cast<void**>(ptr)[-1]); }
+
+  template <class U>
+  bool operator==(const AlignedAllocator<U, alignment>& /*other*/) const
+  {
+    return true;
+  }
+
+  template <class U>
+  bool operator!=(const AlignedAllocator<U, alignment>& /*other*/) const
+  {
+    return false;
+  }
+}; // class AlignedAllocator
+
+/**
+ *  \brief  Geometric data of all elements of a local grid part, stored as structure of arrays indexed by the local
+ *          element index.
+ *
+ *          Each quantity is stored component wise: for instance, corners(ii, dd)[e] is the dd'th coordinate of the
+ *          ii'th corner of the element with local index e. Each of these arrays is aligned to 64 bytes and padded, so
+ *          that loops over all elements can be vectorized.
+ *
+ *          The Jacobians are evaluated at the element centers, they are exact for affine() grids only. The volume of a
+ *          face is the sum of the volumes of the intersections of the element with this face. If the data would exceed
+ *          the given memory budget, nothing is computed and available() returns false.
+ */
+template <class GridPartImp>
+class GeometryCache
+{
+public:
+  typedef GridPartImp GridPartType;
+  typedef typename GridPartType::GridType GridType;
+  typedef typename GridType::ctype ctype;
+
+  static const unsigned int dimension      = GridType::dimension;
+  static const unsigned int dimensionworld = GridType::dimensionworld;
+
+  static const size_t maxCorners = IndexSet::Local::MaxSubEntities<dimension, dimension>::value;
+  static const size_t maxFaces   = IndexSet::Local::MaxSubEntities<dimension, 1>::value;
+
+  //! 1 GiB
+  static const size_t defaultMemoryBudget = size_t(1) << 30;
+
+  typedef std::vector<ctype, AlignedAllocator<ctype>> ArrayType;
+
+  GeometryCache(const GridPartType& gridPart, const size_t memoryBudget = defaultMemoryBudget)
+    : size_(gridPart.indexSet().size(0))
+    , stride_(pad(size_))
+    , available_(false)
+    , affine_(true)
+  {
+    if (memory() > memoryBudget)
+      return;
+    corners_.assign(maxCorners * dimensionworld * stride_, std::numeric_limits<ctype>::quiet_NaN());
+    jacobianInverseTransposed_.assign(dimensionworld * dimension * stride_, ctype(0));
+    integrationElements_.assign(stride_, ctype(0));
+    volumes_.assign(stride_, ctype(0));
+    centers_.assign(dimensionworld * stride_, ctype(0));
+    unitOuterNormals_.assign(maxFaces * dimensionworld * stride_, ctype(0));
+    faceVolumes_.assign(maxFaces * stride_, ctype(0));
+    numCorners_.assign(size_, 0);
+    numFaces_.assign(size_, 0);
+    const auto entityItEnd = gridPart.template end<0>();
+    for (auto entityIt = gridPart.template begin<0>(); entityIt != entityItEnd; ++entityIt) {
+      const auto& entity      = *entityIt;
+      const size_t element    = gridPart.indexSet().index(entity);
+      const auto geometry     = entity.geometry();
+      const auto& refElement  = ReferenceElements<ctype, dimension>::general(entity.type());
+      const auto localCenter  = refElement.position(0, 0);
+      const auto center       = geometry.center();
+      const auto jacobianInvT = geometry.jacobianInverseTransposed(localCenter);
+      affine_ = affine_ && geometry.affine();
+      numCorners_[element] = static_cast<unsigned char>(geometry.corners());
+      for (int ii = 0; ii < geometry.corners(); ++ii) {
+        const auto corner = geometry.corner(ii);
+        for (size_t dd = 0; dd < dimensionworld; ++dd)
+          corners_[(ii * dimensionworld + dd) * stride_ + element] = corner[dd];
+      }
+      for (size_t rr = 0; rr < dimensionworld; ++rr)
+        for (size_t cc = 0; cc < dimension; ++cc)
+          jacobianInverseTransposed_[(rr * dimension + cc) * stride_ + element] = jacobianInvT[rr][cc];
+      integrationElements_[element] = geometry.integrationElement(localCenter);
+      volumes_[element]             = geometry.volume();
+      for (size_t dd = 0; dd < dimensionworld; ++dd)
+        centers_[dd * stride_ + element] = center[dd];
+      // faces
+      const int numFaces = refElement.size(1);
+      numFaces_[element] = static_cast<unsigned char>(numFaces);
+      for (int ii = 0; ii < numFaces; ++ii) {
+        FieldVector<ctype, dimensionworld> normal(0);
+        jacobianInvT.mv(refElement.integrationOuterNormal(ii), normal);
+        normal /= normal.two_norm();
+        for (size_t dd = 0; dd < dimensionworld; ++dd)
+          unitOuterNormals_[(ii * dimensionworld + dd) * stride_ + element] = normal[dd];
+      }
+      // a face may consist of several intersections on nonconforming grids
+      const auto intersectionItEnd = gridPart.iend(entity);
+      for (auto intersectionIt = gridPart.ibegin(entity); intersectionIt != intersectionItEnd; ++intersectionIt) {
+        const auto& intersection = *intersectionIt;
+        faceVolumes_[intersection.indexInInside() * stride_ + element] += intersection.geometry().volume();
+      }
+    }
+    available_ = true;
+  } // GeometryCache(...)
+
+  //! the number of bytes this cache needs (or would need)
+  size_t memory() const
+  {
+    const size_t perElement = maxCorners * dimensionworld + dimensionworld * dimension + 2 + dimensionworld
+                              + maxFaces * (dimensionworld + 1);
+    return perElement * stride_ * sizeof(ctype) + 2 * size_;
+  }
+
+  bool available() const { return available_; }
+
+  //! true, if all geometries are affine (and thus the cached Jacobians are exact)
+  bool affine() const { return affine_; }
+
+  //! the number of elements
+  size_t size() const { return size_; }
+
+  //! the padded length of each array
+  size_t stride() const { return stride_; }
+
+  size_t numCorners(const size_t element) const { return numCorners_[element]; }
+
+  size_t numFaces(const size_t element) const { return numFaces_[element]; }
+
+  const ctype* corners(const size_t corner, const size_t component) const
+  {
+    return &corners_[(corner * dimensionworld + component) * stride_];
+  }
+
+  const ctype* jacobianInverseTransposed(const size_t row, const size_t col) const
+  {
+    return &jacobianInverseTransposed_[(row * dimension + col) * stride_];
+  }
+
+  const ctype* integrationElements() const { return &integrationElements_[0]; }
+
+  const ctype* volumes() const { return &volumes_[0]; }
+
+  const ctype* centers(const size_t component) const { return &centers_[component * stride_]; }
+
+  const ctype* unitOuterNormals(const size_t face, const size_t component) const
+  {
+    return &unitOuterNormals_[(face * dimensionworld + component) * stride_];
+  }
+
+  const ctype* faceVolumes(const size_t face) const { return &faceVolumes_[face * stride_]; }
+
+private:
+  static size_t pad(const size_t size)
+  {
+    const size_t block = 64 / sizeof(ctype) > 0 ? 64 / sizeof(ctype) : 1;
+    return ((size + block - 1) / block) * block;
+  }
+
+  const size_t size_;
+  const size_t stride_;
+  bool available_;
+  bool affine_;
+  ArrayType corners_;
+  ArrayType jacobianInverseTransposed_;
+  ArrayType integrationElements_;
+  ArrayType volumes_;
+  ArrayType centers_;
+  ArrayType unitOuterNormals_;
+  ArrayType faceVolumes_;
+  std::vector<unsigned char> numCorners_;
+  std::vector<unsigned char> numFaces_;
+}; // class GeometryCache
+
+} // namespace Local
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_LOCAL_GEOMETRYCACHE_HH
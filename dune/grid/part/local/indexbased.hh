@@ -9,6 +9,8 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 #include <dune/common/exceptions.hh>
 
@@ -20,13 +22,24 @@
 #include <dune/fem/gridpart/common/gridpart.hh>
 #endif
 
+#include <dune/grid/part/storage.hh>
 #include <dune/grid/part/iterator/local/indexbased.hh>
 #include <dune/grid/part/iterator/intersection/local.hh>
 #include <dune/grid/part/iterator/intersection/wrapper.hh>
 #include <dune/grid/part/indexset/local.hh>
+#include <dune/grid/part/local/geometrycache.hh>
+#include <dune/grid/part/local/facepairs.hh>
+#include <dune/grid/part/local/entityrange.hh>
+#include <dune/grid/part/local/coloring.hh>
 
 namespace Dune {
 namespace grid {
+namespace Multiscale {
+
+template <class LocalGridPartImp>
+class Communication;
+
+} // namespace Multiscale
 namespace Part {
 namespace Local {
 namespace IndexBased {
@@ -90,28 +103,56 @@ public:
   typedef typename Traits::CollectiveCommunicationType CollectiveCommunicationType;
   typedef typename Traits::GlobalGridPartType GlobalGridPartType;
   typedef typename Traits::IndexSetType IndexSetType;
+  typedef typename IndexSetType::DataType IndexSetDataType;
   typedef typename Traits::IntersectionIteratorType IntersectionIteratorType;
   typedef typename IntersectionIteratorType::Intersection IntersectionType;
   typedef typename GridType::template Codim<0>::Entity EntityType;
+  typedef Local::GeometryCache<ThisType> GeometryCacheType;
 
   typedef typename IndexSetType::IndexType IndexType;
-  typedef std::map<IndexType, IndexType> IndexMapType;
+  //! the type indices are stored as, see Storage
+  typedef typename Storage::Index<IndexType>::type StoredIndexType;
+  typedef std::map<StoredIndexType, StoredIndexType> IndexMapType;
   typedef Dune::GeometryType GeometryType;
   //! container type for the indices
   typedef std::map<GeometryType, IndexMapType> IndexContainerType;
   //! container type for the boundary information
-  typedef std::map<IndexType, std::map<int, int>> BoundaryInfoContainerType;
+  typedef std::map<StoredIndexType, std::map<int, int>> BoundaryInfoContainerType;
+  //! see communicate()
+  typedef Multiscale::Communication<ThisType> CommunicationType;
 
   Const(const std::shared_ptr<const GlobalGridPartType> globalGridPart,
         const std::shared_ptr<const IndexContainerType> indexContainer,
         const std::shared_ptr<const BoundaryInfoContainerType> boundaryInfoContainer)
     : globalGridPart_(globalGridPart)
-    , indexContainer_(indexContainer)
     , boundaryInfoContainer_(boundaryInfoContainer)
-    , indexSet_(*globalGridPart_, indexContainer_)
+    , indexSet_(*globalGridPart_, indexContainer)
+    , subdomain_(0)
+  {
+  }
+
+  //! reuses the data of an existing index set, so this is O(1)
+  Const(const std::shared_ptr<const GlobalGridPartType> globalGridPart,
+        const std::shared_ptr<const IndexSetDataType> indexSetData,
+        const std::shared_ptr<const BoundaryInfoContainerType> boundaryInfoContainer)
+    : globalGridPart_(globalGridPart)
+    , boundaryInfoContainer_(boundaryInfoContainer)
+    , indexSet_(*globalGridPart_, indexSetData)
+    , subdomain_(0)
   {
   }
 
+  /**
+   *  \brief A copy of other which communicates as the given subdomain of communication, see communicate(). O(1), since
+   *         all data is shared with other.
+   */
+  Const(const ThisType& other, const size_t subdomain, const std::shared_ptr<const CommunicationType> communication)
+    : Const(other)
+  {
+    subdomain_     = subdomain;
+    communication_ = communication;
+  }
+
   Const(const ThisType& other) = default;
 
   Const(ThisType&& source) = default;
@@ -122,30 +163,71 @@ public:
 
   const GlobalGridPartType& globalGridPart() const { return *globalGridPart_; }
 
+  /**
+   *  \brief Returns a random access range over all codim entities of this grid part, ordered by their local index (see
+   *         EntityRange), which can be split among threads.
+   *
+   *         The range is built upon the first call (thread safe) and shared by all copies of this grid part.
+   */
+  template <int codim = 0>
+  const Local::EntityRange<GridType, codim>& entities() const
+  {
+    typedef Local::EntityRange<GridType, codim> EntityRangeType;
+    return indexSet_.data()->template attached<EntityRangeType>(
+        [&]() { return std::make_shared<EntityRangeType>(*this); });
+  }
+
+  /**
+   *  \brief Returns a coloring of the elements of this grid part, such that no two elements of one color share a codim
+   *         subentity (see ElementColoring), to be used for concurrent assembly.
+   *
+   *         The coloring is computed from indexSet().connectivity() upon the first call (thread safe) and shared by all
+   *         copies of this grid part.
+   */
+  template <int codim = GridType::dimension>
+  const Local::ElementColoring<IndexType, codim>& coloring() const
+  {
+    typedef Local::ElementColoring<IndexType, codim> ColoringType;
+    return indexSet_.data()->template attached<ColoringType>(
+        [&]() { return std::make_shared<ColoringType>(indexSet_.connectivity()); });
+  }
+
+  /**
+   *  \brief Returns the geometric data of all elements of this grid part, see GeometryCache.
+   *
+   *         The cache is built upon the first call (thread safe) and shared by all copies of this grid part. The memory
+   *         budget of the first call is used, check geometryCache().available() before using the data.
+   */
+  const GeometryCacheType& geometryCache(const size_t memoryBudget = GeometryCacheType::defaultMemoryBudget) const
+  {
+    return indexSet_.data()->template attached<GeometryCacheType>(
+        [&]() { return std::make_shared<GeometryCacheType>(*this, memoryBudget); });
+  }
+
   template <int codim>
   typename BaseTraits::template Codim<codim>::IteratorType begin() const
   {
-    return typename BaseTraits::template Codim<codim>::IteratorType(*globalGridPart_, indexContainer_);
+    return typename BaseTraits::template Codim<codim>::IteratorType(*globalGridPart_, indexSet_.data());
   }
 
   template <int codim, PartitionIteratorType pitype>
   typename BaseTraits::template Codim<codim>::template Partition<pitype>::IteratorType begin() const
   {
     return typename BaseTraits::template Codim<codim>::template Partition<pitype>::IteratorType(*globalGridPart_,
-                                                                                                indexContainer_);
+                                                                                                indexSet_.data());
   }
 
   template <int codim>
   typename BaseTraits::template Codim<codim>::IteratorType end() const
   {
-    return typename BaseTraits::template Codim<codim>::IteratorType(*globalGridPart_, indexContainer_, true);
+    return typename BaseTraits::template Codim<codim>::IteratorType(*globalGridPart_, indexSet_.data(), true);
   }
 
   template <int codim, PartitionIteratorType pitype>
   typename BaseTraits::template Codim<codim>::template Partition<pitype>::IteratorType end() const
   {
     return typename BaseTraits::template Codim<codim>::template Partition<pitype>::IteratorType(
-        *globalGridPart_, indexContainer_, true);
+        *globalGridPart_, indexSet_.data(), true);
   }
 
   IntersectionIteratorType ibegin(const EntityType& entity) const
@@ -188,22 +270,37 @@ public:
 
   int level() const { return globalGridPart_->level(); }
 
+  /**
+   *  \brief Exchanges the data of the entities this grid part shares with the other subdomains of its multiscale grid,
+   *         see Multiscale::Communication.
+   *
+   *         This is a collective operation: the grid parts of all subdomains have to call it with the same interface and
+   *         direction, each from its own thread, and all calls return once the data is exchanged. Otherwise all calls
+   *         throw, see Multiscale::Communication::communicate(subdomain, ...). Only the grid parts of a multiscale grid
+   *         which are communicated on (the oversampled ones, if there are any) can communicate, and only as long as
+   *         their multiscale grid exists.
+   */
   template <class DataHandleImp, class DataType>
-  void communicate(CommDataHandleIF<DataHandleImp, DataType>& /*data*/, InterfaceType /*iftype*/,
-                   CommunicationDirection /*dir*/) const
+  void communicate(CommDataHandleIF<DataHandleImp, DataType>& data, InterfaceType iftype,
+                   CommunicationDirection dir) const
   {
-    DUNE_THROW(Dune::NotImplemented,
-               "As long as I am not sure what this does or is used for I will not implement this!");
-    //    globalGridPart_->communicate(data,iftype,dir);
-  }
+    const std::shared_ptr<const CommunicationType> communication = communication_.lock();
+    if (!communication)
+      DUNE_THROW(Dune::InvalidStateException,
+                 "This local grid part does not belong to a communication (any more), use the grid parts of "
+                     << "Dune::grid::Multiscale::Default or its collective communicate() instead!");
+    communication->communicate(subdomain_, data, iftype, dir);
+  } // ... communicate(...)
 
   const CollectiveCommunicationType& comm() const { return grid().comm(); }
 
 private:
   const std::shared_ptr<const GlobalGridPartType> globalGridPart_;
-  const std::shared_ptr<const IndexContainerType> indexContainer_;
   const std::shared_ptr<const BoundaryInfoContainerType> boundaryInfoContainer_;
   const IndexSetType indexSet_;
+  size_t subdomain_;
+  //! weak, since the communication holds the grid parts it communicates on
+  std::weak_ptr<const CommunicationType> communication_;
 }; // class Const
 
 template <class GlobalGridPartImp>
@@ -249,7 +346,14 @@ public:
   typedef BaseType OutsideType;
 
   //! container type for the intersection information
-  typedef std::map<IndexType, std::vector<int>> IntersectionInfoContainerType;
+  typedef std::map<StoredIndexType, std::vector<Storage::FaceType>> IntersectionInfoContainerType;
+
+  typedef Local::FacePair<IndexType> FacePairType;
+
+  typedef std::vector<FacePairType> FacePairsType;
+
+  typedef Local::FacePairGeometries<typename BaseType::GridType::ctype, BaseType::GridType::dimensionworld>
+      FacePairGeometriesType;
 
   ConstCoupling(const std::shared_ptr<const GlobalGridPartType> globalGridPart,
                 const std::shared_ptr<const IndexContainerType> indexContainer,
@@ -293,7 +397,70 @@ public:
 
   std::shared_ptr<const InsideType> outside() const { return outside_; }
 
+  /**
+   *  \brief Returns one FacePair per intersection of this coupling, with local indices with respect to inside() and
+   *         outside(), sorted by the inside local index.
+   *
+   *         The table is built upon the first call (thread safe) and shared by all copies of this grid part.
+   */
+  const FacePairsType& facePairs() const
+  {
+    return this->indexSet().data()->template attached<FacePairsType>([&]() { return this->buildFacePairs(); });
+  }
+
+  //! geometric data of the intersections, in the order of facePairs() (built upon the first call, thread safe)
+  const FacePairGeometriesType& facePairGeometries() const
+  {
+    return this->indexSet().data()->template attached<FacePairGeometriesType>(
+        [&]() { return this->buildFacePairGeometries(); });
+  }
+
 private:
+  template <class FunctorType>
+  void walkCouplingIntersections(FunctorType functor) const
+  {
+    for (auto entityIt = this->template begin<0>(); entityIt != this->template end<0>(); ++entityIt) {
+      const EntityType& entity = *entityIt;
+      for (auto intersectionIt = ibegin(entity); intersectionIt != iend(entity); ++intersectionIt) {
+        const auto& intersection = *intersectionIt;
+        if (!intersection.neighbor())
+          continue;
+        const auto neighborPtr = intersection.outside();
+        const auto& neighbor   = *neighborPtr;
+        if (!outside_->indexSet().contains(neighbor))
+          continue;
+        FacePairType facePair;
+        facePair.insideLocal  = inside_->indexSet().index(entity);
+        facePair.insideFace   = intersection.indexInInside();
+        facePair.outsideLocal = outside_->indexSet().index(neighbor);
+        facePair.outsideFace  = intersection.indexInOutside();
+        functor(facePair, intersection);
+      }
+    }
+  } // ... walkCouplingIntersections(...)
+
+  std::shared_ptr<const FacePairsType> buildFacePairs() const
+  {
+    std::shared_ptr<FacePairsType> facePairs = std::make_shared<FacePairsType>();
+    walkCouplingIntersections([&](const FacePairType& facePair, const IntersectionType& /*intersection*/) {
+      facePairs->push_back(facePair);
+    });
+    std::sort(facePairs->begin(), facePairs->end());
+    return facePairs;
+  }
+
+  std::shared_ptr<const FacePairGeometriesType> buildFacePairGeometries() const
+  {
+    const FacePairsType& facePairs = this->facePairs();
+    std::shared_ptr<FacePairGeometriesType> geometries = std::make_shared<FacePairGeometriesType>(facePairs.size());
+    walkCouplingIntersections([&](const FacePairType& facePair, const IntersectionType& intersection) {
+      const auto position = std::lower_bound(facePairs.begin(), facePairs.end(), facePair);
+      assert(position != facePairs.end());
+      geometries->set(position - facePairs.begin(), intersection);
+    });
+    return geometries;
+  }
+
   const std::shared_ptr<const IntersectionInfoContainerType> intersectionContainer_;
   const std::shared_ptr<const InsideType> inside_;
   const std::shared_ptr<const OutsideType> outside_;
@@ -342,7 +509,7 @@ public:
   typedef BaseType OutsideType;
 
   //! container type for the intersection information
-  typedef std::map<IndexType, std::vector<int>> IntersectionInfoContainerType;
+  typedef std::map<StoredIndexType, std::vector<Storage::FaceType>> IntersectionInfoContainerType;
 
   ConstBoundary(const std::shared_ptr<const GlobalGridPartType> globalGridPart,
                 const std::shared_ptr<const IndexContainerType> indexContainer,
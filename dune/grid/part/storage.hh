@@ -0,0 +1,76 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#ifndef DUNE_GRID_PART_STORAGE_HH
+#define DUNE_GRID_PART_STORAGE_HH
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+/**
+ *  \brief  Define DUNE_GRID_MULTISCALE_COMPACT_INDICES to 1 to store indices and subdomain ids as 32 bit and local face
+ *          indices as 8 bit integers in all containers of the factory, the multiscale grid and the local index sets.
+ *
+ *          The interfaces still use the IndexType of the global grid part and size_t for subdomains, values are only
+ *          narrowed upon storing (which throws a boost::numeric::bad_numeric_cast if they do not fit).
+ */
+#ifndef DUNE_GRID_MULTISCALE_COMPACT_INDICES
+#define DUNE_GRID_MULTISCALE_COMPACT_INDICES 0
+#endif
+
+namespace Dune {
+namespace grid {
+namespace Part {
+namespace Storage {
+
+#if DUNE_GRID_MULTISCALE_COMPACT_INDICES
+
+//! the type used to store an index of type IndexType
+template <class IndexType>
+struct Index
+{
+  typedef typename std::conditional<(sizeof(IndexType) > sizeof(std::uint32_t)),
+                                    typename std::conditional<std::is_signed<IndexType>::value,
+                                                              std::int32_t,
+                                                              std::uint32_t>::type,
+                                    IndexType>::type type;
+};
+
+//! the type used to store a subdomain id
+typedef std::uint32_t SubdomainType;
+
+//! the type used to store the index of a face in its element (i.e. intersection.indexInInside())
+typedef std::int8_t FaceType;
+
+#else // DUNE_GRID_MULTISCALE_COMPACT_INDICES
+
+template <class IndexType>
+struct Index
+{
+  typedef IndexType type;
+};
+
+typedef std::size_t SubdomainType;
+
+typedef int FaceType;
+
+#endif // DUNE_GRID_MULTISCALE_COMPACT_INDICES
+
+//! narrows value to its storage type, throws if it does not fit
+template <class StorageType, class ValueType>
+StorageType store(const ValueType& value)
+{
+  return boost::numeric_cast<StorageType>(value);
+}
+
+} // namespace Storage
+} // namespace Part
+} // namespace grid
+} // namespace Dune
+
+#endif // DUNE_GRID_PART_STORAGE_HH
@@ -0,0 +1,192 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/functions/expression.hh>
+
+#include <dune/grid/multiscale/provider/cache.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class ProviderCache
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::MsGridProviderCache< GridType > CacheType;
+  typedef grid::Multiscale::Providers::Cube< GridType > CubeType;
+
+  ProviderCache()
+    : type_(CubeType::static_id())
+  {
+    for (const std::string num_partitions : {"[1 2]", "[2 2]", "[4 2]"}) {
+      auto config = CubeType::default_config();
+      config["num_partitions"] = num_partitions;
+      configs_.push_back(config);
+    }
+    char directory[] = "cache_XXXXXX";
+    if (::mkdtemp(directory) != nullptr)
+      directory_ = directory;
+  }
+
+  ~ProviderCache()
+  {
+    if (directory_.empty())
+      return;
+    for (const auto& config : configs_) {
+      const std::string path = snapshot_path(config);
+      std::remove((path + ".labels").c_str());
+      std::remove((path + ".key").c_str());
+    }
+    ::rmdir(directory_.c_str());
+  }
+
+  std::string snapshot_path(const Stuff::Common::Configuration& config) const
+  {
+    return directory_ + "/" + CacheType::snapshot_name(CacheType::canonical_key(type_, config));
+  }
+
+  const std::string type_;
+  std::vector< Stuff::Common::Configuration > configs_;
+  std::string directory_;
+}; // class ProviderCache
+
+
+TEST_F(ProviderCache, canonical_key)
+{
+  auto config = configs_[1];
+  config["num_partitions"] = " [2  2] ";
+  EXPECT_EQ(CacheType::canonical_key(type_, configs_[1]), CacheType::canonical_key(type_, config));
+  EXPECT_EQ(CacheType::canonical_key(type_, CubeType::default_config()),
+            CacheType::canonical_key(type_, Stuff::Common::Configuration()));
+  EXPECT_NE(CacheType::canonical_key(type_, configs_[0]), CacheType::canonical_key(type_, configs_[1]));
+}
+
+TEST_F(ProviderCache, evicts_the_least_recently_used)
+{
+  CacheType cache(2);
+  const auto first = cache.create(type_, configs_[0]);
+  const auto second = cache.create(type_, configs_[1]);
+  EXPECT_EQ(size_t(2), cache.misses());
+  EXPECT_EQ(size_t(2), cache.size());
+  // the first is used again, so the second is the least recently used one
+  EXPECT_EQ(first, cache.create(type_, configs_[0]));
+  EXPECT_EQ(size_t(1), cache.hits());
+  const auto third = cache.create(type_, configs_[2]);
+  EXPECT_EQ(size_t(3), cache.misses());
+  EXPECT_EQ(size_t(2), cache.size());
+  EXPECT_EQ(first, cache.create(type_, configs_[0]));
+  EXPECT_EQ(third, cache.create(type_, configs_[2]));
+  EXPECT_EQ(size_t(3), cache.hits());
+  // the second was dropped and is created again
+  EXPECT_NE(second, cache.create(type_, configs_[1]));
+  EXPECT_EQ(size_t(4), cache.misses());
+  EXPECT_EQ(size_t(2), cache.size());
+  EXPECT_EQ(size_t(0), cache.snapshot_hits());
+  cache.clear();
+  EXPECT_EQ(size_t(0), cache.size());
+}
+
+TEST_F(ProviderCache, without_capacity)
+{
+  CacheType cache(0);
+  const auto first = cache.create(type_, configs_[0]);
+  EXPECT_NE(first, cache.create(type_, configs_[0]));
+  EXPECT_EQ(size_t(0), cache.size());
+  EXPECT_EQ(size_t(0), cache.hits());
+  EXPECT_EQ(size_t(2), cache.misses());
+}
+
+TEST_F(ProviderCache, recreates_from_snapshots)
+{
+  ASSERT_FALSE(directory_.empty());
+  std::vector< std::shared_ptr< const CacheType::InterfaceType > > created;
+  {
+    CacheType cache(8, directory_);
+    for (const auto& config : configs_)
+      created.push_back(cache.create(type_, config));
+    EXPECT_EQ(configs_.size(), cache.misses());
+    EXPECT_EQ(size_t(0), cache.snapshot_hits());
+  }
+  // a later run finds the snapshots instead of partitioning again
+  CacheType cache(8, directory_);
+  for (size_t cc = 0; cc < configs_.size(); ++cc) {
+    const auto provider = cache.create(type_, configs_[cc]);
+    const auto& ms_grid = *provider->ms_grid();
+    const auto& expected = *created[cc]->ms_grid();
+    ASSERT_EQ(expected.size(), ms_grid.size());
+    const auto globalGridPart = ms_grid.globalGridPart();
+    for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it)
+      EXPECT_EQ(expected.subdomainOf(*it), ms_grid.subdomainOf(*it));
+  }
+  EXPECT_EQ(configs_.size(), cache.snapshot_hits());
+  EXPECT_EQ(size_t(0), cache.misses());
+  // and memory before the snapshots
+  cache.create(type_, configs_[0]);
+  EXPECT_EQ(size_t(1), cache.hits());
+  EXPECT_EQ(configs_.size(), cache.snapshot_hits());
+}
+
+TEST_F(ProviderCache, ignores_corrupt_snapshots)
+{
+  ASSERT_FALSE(directory_.empty());
+  CacheType(8, directory_).create(type_, configs_[1]);
+  {
+    std::ofstream labels(snapshot_path(configs_[1]) + ".labels", std::ios::trunc);
+    labels << "garbage";
+  }
+  CacheType cache(8, directory_);
+  EXPECT_EQ(size_t(4), cache.create(type_, configs_[1])->ms_grid()->size());
+  EXPECT_EQ(size_t(0), cache.snapshot_hits());
+  EXPECT_EQ(size_t(1), cache.misses());
+  // the snapshot was replaced
+  CacheType later(8, directory_);
+  EXPECT_EQ(size_t(4), later.create(type_, configs_[1])->ms_grid()->size());
+  EXPECT_EQ(size_t(1), later.snapshot_hits());
+}
+
+TEST_F(ProviderCache, recreates_disconnected_subdomains)
+{
+  ASSERT_FALSE(directory_.empty());
+  typedef grid::Multiscale::Providers::Functionbased< GridType > FunctionbasedType;
+  typedef Stuff::Functions::Expression< typename FunctionbasedType::EntityType, double, 2, double, 1 > ExpressionType;
+  // the two left and the two right columns of 8 x 8 elements are one subdomain
+  auto config = FunctionbasedType::default_config();
+  config["thresholds"] = "[0.0625]";
+  config["connected"] = "false";
+  config["function.type"] = ExpressionType::static_id();
+  config["function.variable"] = "x";
+  config["function.expression"] = "(x[0] - 0.5) * (x[0] - 0.5)";
+  config["function.order"] = "2";
+  const std::string type = FunctionbasedType::static_id();
+  EXPECT_EQ(size_t(2), CacheType(8, directory_).create(type, config)->ms_grid()->size());
+  CacheType cache(8, directory_);
+  const auto provider = cache.create(type, config);
+  EXPECT_EQ(size_t(1), cache.snapshot_hits());
+  EXPECT_EQ(size_t(0), cache.misses());
+  EXPECT_EQ(size_t(2), provider->ms_grid()->size());
+  // the snapshot is read by a LabelFile provider
+  EXPECT_TRUE(dynamic_cast< const FunctionbasedType* >(provider.get()) == nullptr);
+  EXPECT_TRUE(dynamic_cast< const grid::Multiscale::Providers::LabelFile< GridType >* >(provider.get()) != nullptr);
+  const std::string path = directory_ + "/" + CacheType::snapshot_name(CacheType::canonical_key(type, config));
+  std::remove((path + ".labels").c_str());
+  std::remove((path + ".key").c_str());
+}
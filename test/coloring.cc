@@ -0,0 +1,94 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <map>
+#include <vector>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class Coloring
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  static const unsigned int dimDomain = GridType::dimension;
+
+  Coloring()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  /**
+   *  Checks that the color classes partition the elements and that no two elements sharing a codim subentity (found
+   *  by walking the local grid part and using the global index set) have the same color.
+   */
+  template< int codim >
+  void check(const size_t minColors) const
+  {
+    const auto globalGridPart = ms_grid_->globalGridPart();
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+      const auto localGridPart = ms_grid_->localGridPart(ss);
+      const auto& indexSet = localGridPart.indexSet();
+      const auto& coloring = localGridPart.template coloring< codim >();
+      const size_t numElements = indexSet.size(0);
+      // the color classes
+      std::vector< size_t > seen(numElements, 0);
+      for (size_t cc = 0; cc < coloring.numColors(); ++cc) {
+        EXPECT_GT(coloring.size(cc), size_t(0)) << "color " << cc << " is empty";
+        EXPECT_EQ(coloring.size(cc), size_t(coloring.end(cc) - coloring.begin(cc)));
+        for (auto it = coloring.begin(cc); it != coloring.end(cc); ++it) {
+          ASSERT_LT(size_t(*it), numElements);
+          ++seen[*it];
+          EXPECT_EQ(cc, size_t(coloring.color(*it)));
+          if (it != coloring.begin(cc))
+            EXPECT_LT(*(it - 1), *it) << "color " << cc << " is not sorted";
+        }
+      }
+      EXPECT_EQ(std::vector< size_t >(numElements, 1), seen) << "subdomain " << ss;
+      EXPECT_GE(coloring.numColors(), minColors);
+      // the elements of each subentity
+      std::map< size_t, std::vector< size_t > > elements;
+      for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it) {
+        const auto& element = *it;
+        const auto& referenceElement = ReferenceElements< double, dimDomain >::general(element.type());
+        for (int ii = 0; ii < referenceElement.size(codim); ++ii)
+          elements[globalGridPart.indexSet().subIndex(element, ii, codim)].push_back(indexSet.index(element));
+      }
+      for (const auto& subEntityAndElements : elements)
+        for (const size_t first : subEntityAndElements.second)
+          for (const size_t second : subEntityAndElements.second)
+            if (first != second)
+              EXPECT_NE(coloring.color(first), coloring.color(second))
+                  << "subdomain " << ss << ", elements " << first << " and " << second << " share a subentity";
+    }
+  } // ... check(...)
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class Coloring
+
+
+TEST_F(Coloring, vertex_neighbors_differ)
+{
+  // four quadrilaterals share each inner vertex
+  check< dimDomain >(4);
+}
+
+TEST_F(Coloring, face_neighbors_differ)
+{
+  check< 1 >(2);
+}
@@ -0,0 +1,199 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/grid/common/datahandleif.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+#include <dune/grid/multiscale/communication.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+typedef typename ProviderType::MsGridType MsGridType;
+typedef typename MsGridType::LocalGridPartType LocalGridPartType;
+
+
+/**
+ *  Holds one value per entity of the given codim of an (oversampled) local grid part: the global index plus one on the
+ *  entities of the local grid part without oversampling and -1 on the others, which are to be received.
+ */
+class ValueHandle
+  : public CommDataHandleIF< ValueHandle, double >
+{
+public:
+  ValueHandle(const MsGridType& ms_grid, const size_t subdomain, const int codim = 0)
+    : grid_part_(ms_grid.localGridPart(subdomain, true))
+    , codim_(codim)
+  {
+    const auto localGridPart = ms_grid.localGridPart(subdomain);
+    const auto& globalIndexSet = ms_grid.globalGridPart().indexSet();
+    values_.resize(grid_part_.indexSet().size(0), -1.0);
+    for (auto it = grid_part_.template begin< 0 >(); it != grid_part_.template end< 0 >(); ++it)
+      if (localGridPart.indexSet().contains(*it))
+        values_[grid_part_.indexSet().index(*it)] = globalIndexSet.index(*it) + 1.0;
+  }
+
+  bool contains(int /*dim*/, int codim) const { return codim == codim_; }
+
+  bool fixedsize(int /*dim*/, int /*codim*/) const { return true; }
+
+  template< class EntityType >
+  size_t size(const EntityType& /*entity*/) const { return 1; }
+
+  template< class MessageBufferType, class EntityType >
+  void gather(MessageBufferType& buffer, const EntityType& entity) const
+  {
+    buffer.write(values_[grid_part_.indexSet().index(entity)]);
+  }
+
+  template< class MessageBufferType, class EntityType >
+  void scatter(MessageBufferType& buffer, const EntityType& entity, size_t count)
+  {
+    EXPECT_EQ(size_t(1), count);
+    buffer.read(values_[grid_part_.indexSet().index(entity)]);
+  }
+
+  //! all entities should have received the value of their owner
+  void check(const MsGridType& ms_grid) const
+  {
+    const auto& globalIndexSet = ms_grid.globalGridPart().indexSet();
+    for (auto it = grid_part_.template begin< 0 >(); it != grid_part_.template end< 0 >(); ++it)
+      EXPECT_EQ(globalIndexSet.index(*it) + 1.0, values_[grid_part_.indexSet().index(*it)]);
+  }
+
+private:
+  const LocalGridPartType grid_part_;
+  const int codim_;
+  std::vector< double > values_;
+}; // class ValueHandle
+
+
+class MsGridCommunication
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Communication< LocalGridPartType > CommunicationType;
+
+  MsGridCommunication()
+  {
+    auto config = ProviderType::default_config();
+    config["num_partitions"] = "[2 2]";
+    config["oversampling_layers"] = "1";
+    ms_grid_ = ProviderType::create(config)->ms_grid();
+  }
+
+  std::vector< ValueHandle > handles(const int codimOfLastSubdomain = 0) const
+  {
+    std::vector< ValueHandle > result;
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss)
+      result.emplace_back(*ms_grid_, ss, (ss + 1 == ms_grid_->size()) ? codimOfLastSubdomain : 0);
+    return result;
+  }
+
+  //! a communication on the grid parts of ms_grid_, which gives up quickly
+  std::shared_ptr< const CommunicationType > impatient_communication() const
+  {
+    typedef std::vector< std::shared_ptr< const LocalGridPartType > > LocalGridPartsType;
+    auto localGridParts = std::make_shared< LocalGridPartsType >();
+    auto oversampledGridParts = std::make_shared< LocalGridPartsType >();
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+      localGridParts->push_back(std::make_shared< const LocalGridPartType >(ms_grid_->localGridPart(ss)));
+      oversampledGridParts->push_back(std::make_shared< const LocalGridPartType >(ms_grid_->localGridPart(ss, true)));
+    }
+    return std::make_shared< const CommunicationType >(
+        localGridParts, oversampledGridParts, std::chrono::milliseconds(100));
+  }
+
+  //! calls functor(ss) for each subdomain from its own thread, returns the number of calls which threw
+  template< class FunctorType >
+  size_t concurrently(FunctorType functor) const
+  {
+    size_t failures = 0;
+    std::mutex mutex;
+    std::vector< std::thread > threads;
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss)
+      threads.emplace_back([&, ss]() {
+        try {
+          functor(ss);
+        } catch (Dune::InvalidStateException&) {
+          std::lock_guard< std::mutex > lock(mutex);
+          ++failures;
+        }
+      });
+    for (auto& thread : threads)
+      thread.join();
+    return failures;
+  } // ... concurrently(...)
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class MsGridCommunication
+
+
+TEST_F(MsGridCommunication, all_subdomains_at_once)
+{
+  auto dataHandles = handles();
+  ms_grid_->communicate(dataHandles, InteriorBorder_All_Interface, ForwardCommunication);
+  for (const auto& handle : dataHandles)
+    handle.check(*ms_grid_);
+}
+
+TEST_F(MsGridCommunication, collectively_by_the_local_grid_parts)
+{
+  auto dataHandles = handles();
+  EXPECT_EQ(size_t(0), concurrently([&](const size_t ss) {
+    ms_grid_->localGridPart(ss, true).communicate(dataHandles[ss], InteriorBorder_All_Interface, ForwardCommunication);
+  }));
+  for (const auto& handle : dataHandles)
+    handle.check(*ms_grid_);
+}
+
+TEST_F(MsGridCommunication, detects_a_sequential_call)
+{
+  const auto communication = impatient_communication();
+  auto dataHandles = handles();
+  EXPECT_THROW(communication->communicate(0, dataHandles[0], InteriorBorder_All_Interface, ForwardCommunication),
+               Dune::InvalidStateException);
+}
+
+TEST_F(MsGridCommunication, detects_a_missing_subdomain)
+{
+  const auto communication = impatient_communication();
+  auto dataHandles = handles();
+  const size_t failures = concurrently([&](const size_t ss) {
+    if (ss > 0)
+      communication->communicate(ss, dataHandles[ss], InteriorBorder_All_Interface, ForwardCommunication);
+  });
+  EXPECT_EQ(ms_grid_->size() - 1, failures);
+}
+
+TEST_F(MsGridCommunication, detects_disagreeing_data_handles)
+{
+  const auto communication = impatient_communication();
+  auto dataHandles = handles(GridType::dimension);
+  const size_t failures = concurrently([&](const size_t ss) {
+    communication->communicate(ss, dataHandles[ss], InteriorBorder_All_Interface, ForwardCommunication);
+  });
+  EXPECT_EQ(ms_grid_->size(), failures);
+  // and communicates again afterwards
+  dataHandles = handles();
+  EXPECT_EQ(size_t(0), concurrently([&](const size_t ss) {
+    communication->communicate(ss, dataHandles[ss], InteriorBorder_All_Interface, ForwardCommunication);
+  }));
+  for (const auto& handle : dataHandles)
+    handle.check(*ms_grid_);
+}
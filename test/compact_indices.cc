@@ -0,0 +1,15 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+// runs the tests of the provider, the local index sets and the face table with compactly stored indices, see
+// dune/grid/part/storage.hh
+#define DUNE_GRID_MULTISCALE_COMPACT_INDICES 1
+
+#include "provider.cc"
+#include "indexset.cc"
+#include "facetable.cc"
+
+static_assert(std::is_same< grid::Part::Storage::SubdomainType, std::uint32_t >::value,
+              "the subdomains are not stored compactly!");
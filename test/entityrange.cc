@@ -0,0 +1,146 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <vector>
+#include <iterator>
+#include <type_traits>
+
+#include <dune/common/version.hh>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class EntityRange
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+
+  EntityRange()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 4)
+  template< class EntityType >
+  static const EntityType& entity(const EntityType& entity)
+  {
+    return entity;
+  }
+#else
+  //! range[ii] is an EntityPointer before dune-grid 2.4
+  template< class EntityPointerType >
+  static const typename EntityPointerType::Entity& entity(const EntityPointerType& entityPointer)
+  {
+    return *entityPointer;
+  }
+#endif
+
+  //! checks that the range of each subdomain holds the entities of begin< codim >() and end< codim >() by local index
+  template< int codim >
+  void check_order() const
+  {
+    const auto& globalIndexSet = ms_grid_->globalGridPart().indexSet();
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+      const auto localGridPart = ms_grid_->localGridPart(ss);
+      const auto& indexSet = localGridPart.indexSet();
+      const auto& range = localGridPart.template entities< codim >();
+      ASSERT_EQ(size_t(indexSet.size(codim)), range.size());
+      EXPECT_FALSE(range.empty());
+      // the range is shared by all copies of the grid part
+      EXPECT_EQ(&range, &ms_grid_->localGridPart(ss).template entities< codim >());
+      std::vector< size_t > seen(range.size(), 0);
+      for (auto it = localGridPart.template begin< codim >(); it != localGridPart.template end< codim >(); ++it) {
+        const size_t ii = indexSet.index(*it);
+        ASSERT_LT(ii, range.size());
+        ++seen[ii];
+        EXPECT_EQ(globalIndexSet.index(*it), globalIndexSet.index(entity(range[ii])));
+      }
+      EXPECT_EQ(std::vector< size_t >(range.size(), 1), seen) << "subdomain " << ss;
+      // and so does iterating the range
+      size_t ii = 0;
+      for (auto it = range.begin(); it != range.end(); ++it, ++ii) {
+        EXPECT_EQ(ii, it.index());
+        EXPECT_EQ(ii, size_t(indexSet.index(entity(*it))));
+      }
+      EXPECT_EQ(range.size(), ii);
+    }
+  } // ... check_order(...)
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class EntityRange
+
+
+TEST_F(EntityRange, orders_the_elements_by_local_index)
+{
+  check_order< 0 >();
+}
+
+TEST_F(EntityRange, orders_the_vertices_by_local_index)
+{
+  check_order< GridType::dimension >();
+}
+
+TEST_F(EntityRange, is_random_access)
+{
+  const auto localGridPart = ms_grid_->localGridPart(0);
+  const auto& indexSet = localGridPart.indexSet();
+  const auto& range = localGridPart.template entities< 0 >();
+  typedef typename std::decay< decltype(range) >::type::Iterator IteratorType;
+  static_assert(std::is_same< typename std::iterator_traits< IteratorType >::iterator_category,
+                              std::random_access_iterator_tag >::value,
+                "the entity range iterator is not random access!");
+  const std::ptrdiff_t size = range.size();
+  ASSERT_GE(size, 4);
+  const IteratorType begin = range.begin();
+  const IteratorType end = range.end();
+  EXPECT_EQ(size, end - begin);
+  EXPECT_EQ(-size, begin - end);
+  EXPECT_EQ(size, std::distance(begin, end));
+  // operator[], operator* and operator-> agree with range[]
+  for (std::ptrdiff_t nn = 0; nn < size; ++nn) {
+    EXPECT_EQ(size_t(nn), size_t(indexSet.index(entity(begin[nn]))));
+    EXPECT_EQ(size_t(nn), size_t(indexSet.index(entity(*(begin + nn)))));
+    EXPECT_EQ(entity(range[nn]).level(), (begin + nn)->level());
+    EXPECT_EQ(size_t(nn), (end - (size - nn)).index());
+  }
+  // arithmetic
+  IteratorType it = begin;
+  it += 3;
+  EXPECT_EQ(size_t(3), it.index());
+  EXPECT_TRUE(it == 3 + begin);
+  EXPECT_TRUE(it == begin + 3);
+  it -= 2;
+  EXPECT_EQ(size_t(1), it.index());
+  EXPECT_EQ(size_t(1), (it++).index());
+  EXPECT_EQ(size_t(2), it.index());
+  EXPECT_EQ(size_t(3), (++it).index());
+  EXPECT_EQ(size_t(3), (it--).index());
+  EXPECT_EQ(size_t(1), (--it).index());
+  EXPECT_EQ(size_t(0), (it - 1).index());
+  std::advance(it, size - 1);
+  EXPECT_TRUE(it == end);
+  // comparison
+  EXPECT_TRUE(begin < it);
+  EXPECT_TRUE(begin <= it);
+  EXPECT_TRUE(it > begin);
+  EXPECT_TRUE(it >= begin);
+  EXPECT_TRUE(it <= it);
+  EXPECT_TRUE(it >= it);
+  EXPECT_FALSE(it < it);
+  EXPECT_FALSE(it > it);
+  EXPECT_TRUE(begin != it);
+  EXPECT_FALSE(begin == it);
+}
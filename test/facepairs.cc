@@ -0,0 +1,111 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <tuple>
+#include <vector>
+#include <algorithm>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+//! inside local index, inside face, outside local index, outside face, volume and center of the intersection
+typedef std::tuple< size_t, int, size_t, int, double, FieldVector< double, 2 > > ReferencePairType;
+
+
+class FacePairs
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+
+  FacePairs()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  //! the intersections of the elements of subdomain with those of neighbor, from the global grid part
+  std::vector< ReferencePairType > reference_pairs(const size_t subdomain, const size_t neighbor) const
+  {
+    const auto globalGridPart = ms_grid_->globalGridPart();
+    const auto inside = ms_grid_->localGridPart(subdomain);
+    const auto outside = ms_grid_->localGridPart(neighbor);
+    std::vector< ReferencePairType > pairs;
+    for (auto it = inside.template begin< 0 >(); it != inside.template end< 0 >(); ++it) {
+      const auto& element = *it;
+      for (auto iit = globalGridPart.ibegin(element); iit != globalGridPart.iend(element); ++iit) {
+        const auto& intersection = *iit;
+        if (!intersection.neighbor())
+          continue;
+        const auto neighborPtr = intersection.outside();
+        if (ms_grid_->subdomainOf(*neighborPtr) != neighbor)
+          continue;
+        const auto geometry = intersection.geometry();
+        pairs.push_back(ReferencePairType(inside.indexSet().index(element),
+                                          intersection.indexInInside(),
+                                          outside.indexSet().index(*neighborPtr),
+                                          intersection.indexInOutside(),
+                                          geometry.volume(),
+                                          geometry.center()));
+      }
+    }
+    std::sort(pairs.begin(),
+              pairs.end(),
+              [](const ReferencePairType& a, const ReferencePairType& b) {
+                return std::tie(std::get< 0 >(a), std::get< 1 >(a), std::get< 2 >(a), std::get< 3 >(a))
+                       < std::tie(std::get< 0 >(b), std::get< 1 >(b), std::get< 2 >(b), std::get< 3 >(b));
+              });
+    return pairs;
+  } // ... reference_pairs(...)
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class FacePairs
+
+
+TEST_F(FacePairs, match_the_coupling_intersections)
+{
+  size_t couplings = 0;
+  for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+    for (const size_t nn : ms_grid_->neighborsOf(ss)) {
+      ++couplings;
+      const auto couplingGridPart = ms_grid_->couplingGridPart(ss, nn);
+      const auto& facePairs = couplingGridPart.facePairs();
+      const auto& geometries = couplingGridPart.facePairGeometries();
+      const auto reference = reference_pairs(ss, nn);
+      ASSERT_FALSE(reference.empty());
+      ASSERT_EQ(reference.size(), facePairs.size()) << "coupling " << ss << ", " << nn;
+      ASSERT_EQ(reference.size(), geometries.size()) << "coupling " << ss << ", " << nn;
+      for (size_t pp = 0; pp < reference.size(); ++pp) {
+        EXPECT_EQ(std::get< 0 >(reference[pp]), size_t(facePairs[pp].insideLocal));
+        EXPECT_EQ(std::get< 1 >(reference[pp]), facePairs[pp].insideFace);
+        EXPECT_EQ(std::get< 2 >(reference[pp]), size_t(facePairs[pp].outsideLocal));
+        EXPECT_EQ(std::get< 3 >(reference[pp]), facePairs[pp].outsideFace);
+        EXPECT_DOUBLE_EQ(std::get< 4 >(reference[pp]), geometries.volumes()[pp]);
+        for (size_t dd = 0; dd < 2; ++dd)
+          EXPECT_DOUBLE_EQ(std::get< 5 >(reference[pp])[dd], geometries.centers(dd)[pp]);
+      }
+      // the coupling of the neighbor sees the same intersections from the other side
+      const auto otherCouplingGridPart = ms_grid_->couplingGridPart(nn, ss);
+      const auto& otherPairs = otherCouplingGridPart.facePairs();
+      ASSERT_EQ(facePairs.size(), otherPairs.size());
+      for (const auto& facePair : facePairs) {
+        const auto matches = std::count_if(otherPairs.begin(), otherPairs.end(), [&](decltype(facePair) other) {
+          return other.insideLocal == facePair.outsideLocal && other.insideFace == facePair.outsideFace
+                 && other.outsideLocal == facePair.insideLocal && other.outsideFace == facePair.insideFace;
+        });
+        EXPECT_EQ(1, matches);
+      }
+    }
+  }
+  EXPECT_GT(couplings, size_t(0));
+}
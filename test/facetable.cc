@@ -0,0 +1,86 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <vector>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class FaceTable
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename MsGridType::FaceTableType FaceTableType;
+
+  FaceTable()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class FaceTable
+
+
+TEST_F(FaceTable, kinds_match_the_intersections)
+{
+  ASSERT_TRUE(ms_grid_->hasFaceTable());
+  const auto& faceTable = ms_grid_->faceTable();
+  const auto globalGridPart = ms_grid_->globalGridPart();
+  EXPECT_EQ(size_t(globalGridPart.indexSet().size(0)), faceTable.size());
+  std::vector< size_t > counts(FaceTableType::mixed + 1, 0);
+  std::vector< bool > visited(faceTable.size(), false);
+  const size_t maxFaces = FaceTableType::maxFaces;
+  for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it) {
+    const auto& element = *it;
+    const size_t row = faceTable.element(element);
+    ASSERT_LT(row, faceTable.size());
+    EXPECT_FALSE(visited[row]) << "row " << row << " is used twice";
+    visited[row] = true;
+    const size_t subdomain = ms_grid_->subdomainOf(element);
+    EXPECT_EQ(subdomain, faceTable.subdomain(row));
+    std::vector< bool > seen(maxFaces, false);
+    for (auto iit = globalGridPart.ibegin(element); iit != globalGridPart.iend(element); ++iit) {
+      const auto& intersection = *iit;
+      const size_t face = intersection.indexInInside();
+      ASSERT_LT(face, maxFaces);
+      seen[face] = true;
+      const auto kind = faceTable.kind(row, face);
+      ++counts[kind];
+      if (intersection.boundary()) {
+        ASSERT_EQ(FaceTableType::boundary, kind) << "row " << row << ", face " << face;
+        EXPECT_EQ(intersection.boundaryId(), faceTable.boundaryId(row, face));
+      } else if (intersection.neighbor()) {
+        const auto neighborPtr = intersection.outside();
+        const size_t neighborSubdomain = ms_grid_->subdomainOf(*neighborPtr);
+        if (neighborSubdomain == subdomain)
+          EXPECT_EQ(FaceTableType::interior, kind) << "row " << row << ", face " << face;
+        else {
+          ASSERT_EQ(FaceTableType::coupling, kind) << "row " << row << ", face " << face;
+          EXPECT_EQ(neighborSubdomain, faceTable.neighbor(row, face));
+          EXPECT_EQ(size_t(1), size_t(ms_grid_->neighborsOf(subdomain).count(neighborSubdomain)));
+        }
+      }
+    }
+    for (size_t face = 0; face < maxFaces; ++face)
+      if (!seen[face])
+        EXPECT_EQ(FaceTableType::none, faceTable.kind(row, face)) << "row " << row << ", face " << face;
+  }
+  // a structured grid is conforming, and the default cube has all kinds of faces
+  EXPECT_EQ(size_t(0), counts[FaceTableType::mixed]);
+  EXPECT_GT(counts[FaceTableType::interior], size_t(0));
+  EXPECT_GT(counts[FaceTableType::coupling], size_t(0));
+  EXPECT_GT(counts[FaceTableType::boundary], size_t(0));
+}
@@ -0,0 +1,140 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <set>
+#include <vector>
+#include <memory>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+#include <dune/stuff/functions/expression.hh>
+
+#include <dune/grid/multiscale/provider/functionbased.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+/**
+ *  The function (x - 1/2)^2 on the unit square with 16 x 16 elements, the values of which are exact at the element
+ *  centers. The thresholds 2^-10 (exactly the value of the two middle columns of elements) and 1/16 yield three bands:
+ *  band 0 below 2^-10 is empty, band 1 holds the eight middle columns and band 2 the four outer columns on either side.
+ */
+class Functionbased
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Functionbased< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename ProviderType::DomainType DomainType;
+  typedef typename ProviderType::EntityType EntityType;
+  typedef Stuff::Functions::Expression< EntityType, double, 2, double, 1 > ExpressionType;
+
+  Functionbased()
+    : function_(std::make_shared< ExpressionType >("x", "(x[0] - 0.5) * (x[0] - 0.5)", 2))
+    , thresholds_({0.0625, 0.0009765625})
+  {}
+
+  static std::shared_ptr< const GridType > create_grid()
+  {
+    return Stuff::Grid::Providers::Cube< GridType >(
+               DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(2, 16)).grid_ptr();
+  }
+
+  //! the band of the element with the given center, see the class documentation
+  static size_t band(const DomainType& center)
+  {
+    return (center[0] < 0.25 || center[0] > 0.75) ? 2 : 1;
+  }
+
+  /**
+   *  Checks that the elements of each subdomain are in the same band and that the subdomains of the elements left and
+   *  right of the middle columns are the same (if !connected) or not.
+   */
+  static void check(const MsGridType& ms_grid, const bool connected)
+  {
+    std::vector< std::set< size_t > > bands(ms_grid.size());
+    std::set< size_t > left;
+    std::set< size_t > right;
+    const auto globalGridPart = ms_grid.globalGridPart();
+    for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it) {
+      const auto center = it->geometry().center();
+      const size_t subdomain = ms_grid.subdomainOf(*it);
+      ASSERT_LT(subdomain, ms_grid.size());
+      bands[subdomain].insert(band(center));
+      if (band(center) == 2)
+        (center[0] < 0.5 ? left : right).insert(subdomain);
+    }
+    for (size_t ss = 0; ss < ms_grid.size(); ++ss)
+      EXPECT_EQ(size_t(1), bands[ss].size()) << "subdomain " << ss;
+    ASSERT_EQ(size_t(1), left.size());
+    ASSERT_EQ(size_t(1), right.size());
+    EXPECT_EQ(connected, *left.begin() != *right.begin());
+  } // ... check(...)
+
+  const std::shared_ptr< const ExpressionType > function_;
+  const std::vector< double > thresholds_;
+}; // class Functionbased
+
+
+TEST_F(Functionbased, threshold_bands)
+{
+  using namespace grid::Multiscale::Partitioner;
+  // values on a threshold belong to the band above it, the thresholds need not be sorted
+  EXPECT_EQ(std::vector< size_t >({0, 1, 1, 2, 2}), threshold_bands({0.0, 1.0, 1.5, 2.0, 3.0}, {2.0, 1.0}));
+  EXPECT_EQ(std::vector< size_t >({1, 0, 1, 2}), compact_labels({3, 1, 3, 7}));
+}
+
+TEST_F(Functionbased, evaluate_at_centers)
+{
+  const auto grid = create_grid();
+  const typename MsGridType::GlobalGridPartType globalGridPart(const_cast< GridType& >(*grid));
+  const auto values = grid::Multiscale::Partitioner::evaluate_at_centers(globalGridPart, *function_);
+  ASSERT_EQ(size_t(globalGridPart.indexSet().size(0)), values.size());
+  size_t ii = 0;
+  for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it, ++ii) {
+    const auto center = it->geometry().center();
+    EXPECT_DOUBLE_EQ((center[0] - 0.5) * (center[0] - 0.5), values[ii]);
+  }
+}
+
+TEST_F(Functionbased, connected_regions)
+{
+  const ProviderType provider(create_grid(), function_, thresholds_, true);
+  // the middle columns and the outer columns on either side
+  EXPECT_EQ(size_t(3), provider.ms_grid()->size());
+  check(*provider.ms_grid(), true);
+}
+
+TEST_F(Functionbased, bands)
+{
+  const ProviderType provider(create_grid(), function_, thresholds_, false);
+  // the empty band is skipped
+  EXPECT_EQ(size_t(2), provider.ms_grid()->size());
+  check(*provider.ms_grid(), false);
+}
+
+TEST_F(Functionbased, create)
+{
+  auto config = ProviderType::default_config();
+  config["num_elements"] = "[16 16 16]";
+  config["thresholds"] = "[0.0625 0.0009765625]";
+  config["connected"] = "false";
+  config["function.type"] = ExpressionType::static_id();
+  config["function.variable"] = "x";
+  config["function.expression"] = "(x[0] - 0.5) * (x[0] - 0.5)";
+  config["function.order"] = "2";
+  const auto provider = ProviderType::create(config);
+  EXPECT_EQ(size_t(2), provider->ms_grid()->size());
+  check(*provider->ms_grid(), false);
+  config["connected"] = "true";
+  EXPECT_EQ(size_t(3), ProviderType::create(config)->ms_grid()->size());
+}
@@ -0,0 +1,108 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <vector>
+#include <cstdint>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class GeometryCache
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename MsGridType::LocalGridPartType LocalGridPartType;
+  typedef typename LocalGridPartType::GeometryCacheType GeometryCacheType;
+  static const unsigned int dimDomain = GridType::dimension;
+  static const unsigned int dimWorld = GridType::dimensionworld;
+
+  GeometryCache()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  static bool aligned(const double* ptr)
+  {
+    return reinterpret_cast< std::uintptr_t >(ptr) % 64 == 0;
+  }
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class GeometryCache
+
+
+TEST_F(GeometryCache, agrees_with_the_geometries)
+{
+  for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+    const auto localGridPart = ms_grid_->localGridPart(ss);
+    const auto& indexSet = localGridPart.indexSet();
+    const auto& cache = localGridPart.geometryCache();
+    ASSERT_TRUE(cache.available());
+    EXPECT_TRUE(cache.affine());
+    ASSERT_EQ(size_t(indexSet.size(0)), cache.size());
+    EXPECT_GE(cache.stride(), cache.size());
+    EXPECT_TRUE(aligned(cache.volumes()));
+    EXPECT_TRUE(aligned(cache.centers(dimWorld - 1)));
+    // the cache is shared by all copies of the grid part
+    EXPECT_EQ(&cache, &ms_grid_->localGridPart(ss).geometryCache());
+    for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it) {
+      const auto& entity = *it;
+      const size_t ee = indexSet.index(entity);
+      const auto geometry = entity.geometry();
+      const auto& refElement = ReferenceElements< double, dimDomain >::general(entity.type());
+      const auto localCenter = refElement.position(0, 0);
+      ASSERT_EQ(size_t(geometry.corners()), cache.numCorners(ee));
+      for (int ii = 0; ii < geometry.corners(); ++ii)
+        for (size_t dd = 0; dd < dimWorld; ++dd)
+          EXPECT_DOUBLE_EQ(geometry.corner(ii)[dd], cache.corners(ii, dd)[ee]);
+      const auto jacobianInvT = geometry.jacobianInverseTransposed(localCenter);
+      for (size_t rr = 0; rr < dimWorld; ++rr)
+        for (size_t cc = 0; cc < dimDomain; ++cc)
+          EXPECT_DOUBLE_EQ(jacobianInvT[rr][cc], cache.jacobianInverseTransposed(rr, cc)[ee]);
+      EXPECT_DOUBLE_EQ(geometry.integrationElement(localCenter), cache.integrationElements()[ee]);
+      EXPECT_DOUBLE_EQ(geometry.volume(), cache.volumes()[ee]);
+      for (size_t dd = 0; dd < dimWorld; ++dd)
+        EXPECT_DOUBLE_EQ(geometry.center()[dd], cache.centers(dd)[ee]);
+      // each face is met by one intersection on this conforming grid
+      ASSERT_EQ(size_t(refElement.size(1)), cache.numFaces(ee));
+      std::vector< size_t > seen(cache.numFaces(ee), 0);
+      for (auto iit = localGridPart.ibegin(entity); iit != localGridPart.iend(entity); ++iit) {
+        const auto& intersection = *iit;
+        const size_t face = intersection.indexInInside();
+        ASSERT_LT(face, seen.size());
+        ++seen[face];
+        EXPECT_NEAR(intersection.geometry().volume(), cache.faceVolumes(face)[ee], 1e-12);
+        const auto normal = intersection.centerUnitOuterNormal();
+        for (size_t dd = 0; dd < dimWorld; ++dd)
+          EXPECT_NEAR(normal[dd], cache.unitOuterNormals(face, dd)[ee], 1e-12);
+      }
+      EXPECT_EQ(std::vector< size_t >(cache.numFaces(ee), 1), seen) << "subdomain " << ss << ", element " << ee;
+    }
+  }
+}
+
+TEST_F(GeometryCache, respects_the_memory_budget)
+{
+  const auto localGridPart = ms_grid_->localGridPart(0);
+  const GeometryCacheType tooSmall(localGridPart, 1);
+  EXPECT_FALSE(tooSmall.available());
+  EXPECT_EQ(size_t(localGridPart.indexSet().size(0)), tooSmall.size());
+  EXPECT_GT(tooSmall.memory(), size_t(1));
+  const GeometryCacheType justRight(localGridPart, tooSmall.memory());
+  EXPECT_TRUE(justRight.available());
+  EXPECT_EQ(tooSmall.memory(), justRight.memory());
+}
@@ -0,0 +1,101 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <memory>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class Handles
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename MsGridType::SubdomainHandle SubdomainHandleType;
+  typedef typename MsGridType::CouplingHandle CouplingHandleType;
+
+  Handles()
+  {
+    auto config = ProviderType::default_config();
+    config["num_partitions"] = "[3 2]";
+    config["oversampling_layers"] = "1";
+    ms_grid_ = ProviderType::create(config)->ms_grid();
+  }
+
+  //! grid parts which share their index set data are copies of each other
+  template< class GridPartType, class OtherGridPartType >
+  static bool same(const GridPartType& gridPart, const OtherGridPartType& otherGridPart)
+  {
+    return gridPart.indexSet().data() == otherGridPart.indexSet().data();
+  }
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class Handles
+
+
+TEST_F(Handles, match_the_accessors)
+{
+  const auto& ms_grid = *ms_grid_;
+  for (size_t ss = 0; ss < ms_grid.size(); ++ss) {
+    const SubdomainHandleType subdomain = ms_grid.subdomain(ss);
+    ASSERT_TRUE(subdomain.valid());
+    EXPECT_EQ(ss, subdomain.index());
+    // the grid parts are returned by reference, without copying
+    EXPECT_EQ(&subdomain.localGridPart(), &ms_grid.subdomain(ss).localGridPart());
+    EXPECT_EQ(&subdomain.localGridPart(true), &ms_grid.subdomain(ss).localGridPart(true));
+    EXPECT_TRUE(same(ms_grid.localGridPart(ss), subdomain.localGridPart()));
+    EXPECT_TRUE(same(ms_grid.localGridPart(ss, true), subdomain.localGridPart(true)));
+    EXPECT_FALSE(same(subdomain.localGridPart(), subdomain.localGridPart(true)));
+    ASSERT_EQ(ms_grid.boundary(ss), subdomain.boundary());
+    if (subdomain.boundary())
+      EXPECT_TRUE(same(ms_grid.boundaryGridPart(ss), subdomain.boundaryGridPart()));
+    EXPECT_EQ(&ms_grid.neighborsOf(ss), &subdomain.neighbors());
+    EXPECT_FALSE(subdomain.neighbors().empty());
+    for (const size_t nn : subdomain.neighbors()) {
+      const CouplingHandleType coupling = subdomain.coupling(nn);
+      ASSERT_TRUE(coupling.valid());
+      EXPECT_EQ(ss, coupling.inside().index());
+      EXPECT_EQ(nn, coupling.outside().index());
+      EXPECT_EQ(&coupling.couplingGridPart(), &ms_grid.coupling(ss, nn).couplingGridPart());
+      EXPECT_TRUE(same(ms_grid.couplingGridPart(ss, nn), coupling.couplingGridPart()));
+      EXPECT_FALSE(same(ms_grid.couplingGridPart(nn, ss), coupling.couplingGridPart()));
+    }
+    EXPECT_THROW(subdomain.coupling(ss).couplingGridPart(), Dune::InvalidStateException);
+  }
+}
+
+TEST_F(Handles, default_constructed)
+{
+  SubdomainHandleType subdomain;
+  EXPECT_FALSE(subdomain.valid());
+  CouplingHandleType coupling;
+  EXPECT_FALSE(coupling.valid());
+  // they may be copied and assigned to
+  const SubdomainHandleType copy(subdomain);
+  EXPECT_FALSE(copy.valid());
+  const size_t last = ms_grid_->size() - 1;
+  subdomain = ms_grid_->subdomain(last);
+  ASSERT_TRUE(subdomain.valid());
+  EXPECT_EQ(last, subdomain.index());
+  EXPECT_TRUE(same(ms_grid_->localGridPart(last), subdomain.localGridPart()));
+  const size_t neighbor = *subdomain.neighbors().begin();
+  coupling = subdomain.coupling(neighbor);
+  ASSERT_TRUE(coupling.valid());
+  EXPECT_EQ(neighbor, coupling.outside().index());
+  // and only consist of a pointer and indices
+  EXPECT_EQ(sizeof(void*) + sizeof(size_t), sizeof(SubdomainHandleType));
+  EXPECT_EQ(sizeof(void*) + 2 * sizeof(size_t), sizeof(CouplingHandleType));
+}
@@ -0,0 +1,137 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <vector>
+#include <memory>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/hierarchy.hh>
+#include <dune/grid/multiscale/partitioner/geometric.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class Hierarchy
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Hierarchy< GridType > HierarchyType;
+  typedef FieldVector< double, GridType::dimension > DomainType;
+
+  Hierarchy()
+    : grid_(Stuff::Grid::Providers::Cube< GridType >(
+          DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(2, 16)).grid_ptr())
+  {}
+
+  /**
+   *  Checks that the labels, the multiscale grid and the coarse elements of each level agree, that each level covers
+   *  the unit square and that parents and children of neighboring levels match.
+   */
+  static void check(const HierarchyType& hierarchy)
+  {
+    const auto& globalGridPart = *hierarchy.globalGridPart();
+    const size_t numElements = globalGridPart.indexSet().size(0);
+    for (size_t ll = 0; ll < hierarchy.levels(); ++ll) {
+      const auto& labels = hierarchy.labels(ll);
+      const auto& coarseElements = hierarchy.coarseElements(ll);
+      const auto& ms_grid = *hierarchy.msGrid(ll);
+      ASSERT_EQ(numElements, labels.size());
+      ASSERT_EQ(hierarchy.size(ll), coarseElements.size());
+      ASSERT_EQ(hierarchy.size(ll), ms_grid.size());
+      // the labels are the subdomains of the multiscale grid
+      size_t index = 0;
+      for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it, ++index)
+        EXPECT_EQ(labels[index], ms_grid.subdomainOf(*it)) << "level " << ll << ", element " << index;
+      // the coarse elements cover the domain
+      double volume = 0;
+      size_t elements = 0;
+      for (size_t ss = 0; ss < coarseElements.size(); ++ss) {
+        EXPECT_GT(coarseElements[ss].numElements, size_t(0)) << "level " << ll << ", subdomain " << ss;
+        EXPECT_EQ(size_t(ms_grid.localGridPart(ss).indexSet().size(0)), coarseElements[ss].numElements);
+        volume += coarseElements[ss].volume;
+        elements += coarseElements[ss].numElements;
+      }
+      EXPECT_NEAR(1.0, volume, 1e-12) << "level " << ll;
+      EXPECT_EQ(numElements, elements) << "level " << ll;
+      if (ll == 0) {
+        EXPECT_THROW(hierarchy.children(ll, 0), Dune::RangeError);
+        continue;
+      }
+      // the children of level ll are the subdomains of level ll - 1 with parent ss
+      const auto& fineLabels = hierarchy.labels(ll - 1);
+      const auto& fineElements = hierarchy.coarseElements(ll - 1);
+      for (size_t ee = 0; ee < numElements; ++ee)
+        EXPECT_EQ(labels[ee], hierarchy.parent(ll - 1, fineLabels[ee]));
+      std::vector< size_t > seen(hierarchy.size(ll - 1), 0);
+      for (size_t ss = 0; ss < coarseElements.size(); ++ss) {
+        const auto& children = hierarchy.children(ll, ss);
+        EXPECT_FALSE(children.empty()) << "level " << ll << ", subdomain " << ss;
+        size_t childElements = 0;
+        double childVolume = 0;
+        DomainType center(0.0);
+        for (const size_t cc : children) {
+          ASSERT_LT(cc, seen.size());
+          ++seen[cc];
+          EXPECT_EQ(ss, hierarchy.parent(ll - 1, cc));
+          childElements += fineElements[cc].numElements;
+          childVolume += fineElements[cc].volume;
+          for (int dd = 0; dd < GridType::dimensionworld; ++dd)
+            center[dd] += fineElements[cc].volume * fineElements[cc].center[dd];
+        }
+        EXPECT_EQ(childElements, coarseElements[ss].numElements);
+        EXPECT_NEAR(childVolume, coarseElements[ss].volume, 1e-12);
+        for (int dd = 0; dd < GridType::dimensionworld; ++dd)
+          EXPECT_NEAR(center[dd] / childVolume, coarseElements[ss].center[dd], 1e-12);
+      }
+      EXPECT_EQ(std::vector< size_t >(hierarchy.size(ll - 1), 1), seen) << "level " << ll;
+    }
+    EXPECT_THROW(hierarchy.parent(hierarchy.levels() - 1, 0), Dune::RangeError);
+    EXPECT_THROW(hierarchy.labels(hierarchy.levels()), Dune::RangeError);
+  } // ... check(...)
+
+  std::shared_ptr< const GridType > grid_;
+}; // class Hierarchy
+
+
+TEST_F(Hierarchy, create)
+{
+  const std::vector< size_t > numSubdomains = {16, 4, 1};
+  const auto hierarchy = HierarchyType::create(grid_, numSubdomains);
+  ASSERT_EQ(numSubdomains.size(), hierarchy->levels());
+  for (size_t ll = 0; ll < numSubdomains.size(); ++ll)
+    EXPECT_EQ(numSubdomains[ll], hierarchy->size(ll));
+  check(*hierarchy);
+}
+
+TEST_F(Hierarchy, from_labels_and_parents)
+{
+  // the quadrants of the unit square, the lower and upper half and the whole square
+  std::vector< size_t > labels;
+  const HierarchyType::GlobalGridPartType globalGridPart(const_cast< GridType& >(*grid_));
+  for (const auto& center : grid::Multiscale::Partitioner::element_centers(globalGridPart))
+    labels.push_back((center[0] < 0.5 ? 0 : 1) + (center[1] < 0.5 ? 0 : 2));
+  const HierarchyType hierarchy(grid_, labels, {{0, 0, 1, 1}, {0, 0}});
+  ASSERT_EQ(size_t(3), hierarchy.levels());
+  EXPECT_EQ(size_t(4), hierarchy.size(0));
+  EXPECT_EQ(size_t(2), hierarchy.size(1));
+  EXPECT_EQ(size_t(1), hierarchy.size(2));
+  EXPECT_EQ(std::vector< size_t >({0, 1}), hierarchy.children(1, 0));
+  EXPECT_EQ(std::vector< size_t >({0, 1}), hierarchy.children(2, 0));
+  for (size_t ss = 0; ss < 4; ++ss)
+    EXPECT_NEAR(0.25, hierarchy.coarseElements(0)[ss].volume, 1e-12);
+  check(hierarchy);
+  // every subdomain needs a parent
+  const std::vector< std::vector< size_t > > tooFewParents(1, std::vector< size_t >(3, 0));
+  EXPECT_THROW(HierarchyType(grid_, labels, tooFewParents), Dune::InvalidStateException);
+}
@@ -0,0 +1,200 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <map>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <type_traits>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+#include <dune/grid/multiscale/provider/labeled.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class LocalIndexSet
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename ProviderType::DomainType DomainType;
+  static const unsigned int dimDomain = GridType::dimension;
+
+  /**
+   *  Few large and many small tensor product subdomains (with computed lookups for the elements and vertices) and an
+   *  L-shaped subdomain next to a square one, numbered in the order of the walk (with dense or sparse lookups).
+   */
+  LocalIndexSet()
+  {
+    auto config = ProviderType::default_config();
+    for (const std::string num_partitions : {"[2 2]", "[8 4]"}) {
+      config["num_partitions"] = num_partitions;
+      ms_grids_.push_back(ProviderType::create(config)->ms_grid());
+    }
+    const auto grid = Stuff::Grid::Providers::Cube< GridType >(
+                          DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(dimDomain, 8)).grid_ptr();
+    const typename MsGridType::GlobalGridPartType globalGridPart(const_cast< GridType& >(*grid));
+    std::vector< size_t > labels;
+    for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it) {
+      const auto center = it->geometry().center();
+      labels.push_back((center[0] < 0.5 && center[1] < 0.5) ? 0 : 1);
+    }
+    ms_grids_.push_back(grid::Multiscale::Providers::Labeled< GridType >(grid, labels).ms_grid());
+  }
+
+  /**
+   *  The index maps the local index sets are built from (geometry type -> global index -> local index) serve as the
+   *  map based reference for the lookups.
+   */
+  static void check_lookups(const MsGridType& ms_grid)
+  {
+    const auto globalGridPart = ms_grid.globalGridPart();
+    const auto& globalIndexSet = globalGridPart.indexSet();
+    for (size_t ss = 0; ss < ms_grid.size(); ++ss) {
+      const auto localGridPart = ms_grid.localGridPart(ss);
+      const auto& indexSet = localGridPart.indexSet();
+      const auto& data = *indexSet.data();
+      const auto& indexMaps = *data.indexContainer();
+      for (const auto& geometryTypeAndMap : indexMaps) {
+        const auto& geometryType = geometryTypeAndMap.first;
+        const auto& indexMap = geometryTypeAndMap.second;
+        const auto& lookup = data.lookup(geometryType);
+        const unsigned int codim = dimDomain - geometryType.dim();
+        EXPECT_EQ(indexMap.size(), size_t(lookup.size()));
+        EXPECT_EQ(indexMap.size(), size_t(indexSet.size(geometryType)));
+        for (size_t gg = 0; gg < size_t(globalIndexSet.size(geometryType)); ++gg) {
+          const auto it = indexMap.find(gg);
+          if (it == indexMap.end())
+            EXPECT_FALSE(lookup.contains(gg)) << "subdomain " << ss << ", " << geometryType << ", global index " << gg;
+          else
+            EXPECT_EQ(size_t(it->second), size_t(lookup.find(gg)))
+                << "subdomain " << ss << ", " << geometryType << ", global index " << gg;
+        }
+        const auto& globalIndices = indexSet.globalIndices(codim);
+        ASSERT_EQ(indexMap.size(), globalIndices.size());
+        for (const auto& globalAndLocal : indexMap)
+          EXPECT_EQ(size_t(globalAndLocal.first), size_t(globalIndices[globalAndLocal.second]));
+      }
+    }
+  } // ... check_lookups(...)
+
+  static void check_sub_indices(const MsGridType& ms_grid)
+  {
+    const auto globalGridPart = ms_grid.globalGridPart();
+    const auto& globalIndexSet = globalGridPart.indexSet();
+    for (size_t ss = 0; ss < ms_grid.size(); ++ss) {
+      const auto localGridPart = ms_grid.localGridPart(ss);
+      const auto& indexSet = localGridPart.indexSet();
+      typedef typename std::decay< decltype(indexSet) >::type::IndexType IndexType;
+      const auto& indexMaps = *indexSet.data()->indexContainer();
+      size_t elements = 0;
+      for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it) {
+        const auto& element = *it;
+        EXPECT_EQ(ms_grid.subdomainOf(element) == ss, indexSet.contains(element));
+        if (!indexSet.contains(element))
+          continue;
+        ++elements;
+        const auto& referenceElement = ReferenceElements< double, dimDomain >::general(element.type());
+        for (unsigned int codim = 0; codim <= dimDomain; ++codim) {
+          std::array< IndexType, 8 > indices;
+          const size_t count = indexSet.subIndices(element, codim, indices);
+          ASSERT_EQ(size_t(referenceElement.size(codim)), count);
+          for (int ii = 0; ii < referenceElement.size(codim); ++ii) {
+            const auto& indexMap = indexMaps.at(referenceElement.type(ii, codim));
+            const auto expected = indexMap.at(globalIndexSet.subIndex(element, ii, codim));
+            EXPECT_EQ(size_t(expected), size_t(indexSet.subIndex(element, ii, codim)))
+                << "subdomain " << ss << ", codim " << codim << ", subentity " << ii;
+            EXPECT_EQ(size_t(expected), size_t(indices[ii]))
+                << "subdomain " << ss << ", codim " << codim << ", subentity " << ii;
+          }
+        }
+      }
+      EXPECT_EQ(size_t(indexSet.size(0)), elements);
+    }
+  } // ... check_sub_indices(...)
+
+  std::vector< std::shared_ptr< const MsGridType > > ms_grids_;
+}; // class LocalIndexSet
+
+
+TEST_F(LocalIndexSet, lookups_match_the_index_maps)
+{
+  for (const auto& ms_grid : ms_grids_)
+    check_lookups(*ms_grid);
+}
+
+TEST_F(LocalIndexSet, sub_indices_match_the_index_maps)
+{
+  for (const auto& ms_grid : ms_grids_)
+    check_sub_indices(*ms_grid);
+}
+
+TEST_F(LocalIndexSet, tensor_product_subdomains_have_computed_lookups)
+{
+  for (size_t gg = 0; gg < 2; ++gg) {
+    const auto& ms_grid = *ms_grids_[gg];
+    for (size_t ss = 0; ss < ms_grid.size(); ++ss) {
+      const auto& data = *ms_grid.localGridPart(ss).indexSet().data();
+      EXPECT_TRUE(data.lookup(0u).strided()) << "subdomain " << ss;
+      EXPECT_TRUE(data.lookup(dimDomain).strided()) << "subdomain " << ss;
+    }
+  }
+  // the L-shaped subdomain is no box
+  const auto& data = *ms_grids_[2]->localGridPart(1).indexSet().data();
+  EXPECT_FALSE(data.lookup(0u).strided());
+}
+
+TEST(IndexLookup, strided_layout)
+{
+  typedef grid::Part::IndexSet::Local::IndexLookup< unsigned int > LookupType;
+  typedef std::map< unsigned int, unsigned int > IndexMapType;
+  // a 3 x 4 x 2 box in a 10 x 10 x 10 lattice, with local indices starting at 7
+  IndexMapType box;
+  unsigned int localIndex = 7;
+  for (unsigned int zz = 1; zz < 3; ++zz)
+    for (unsigned int yy = 3; yy < 7; ++yy)
+      for (unsigned int xx = 2; xx < 5; ++xx)
+        box[xx + 10 * yy + 100 * zz] = localIndex++;
+  // the same box without one of its entities (renumbered)
+  IndexMapType holey;
+  localIndex = 0;
+  for (const auto& globalAndLocal : box)
+    if (globalAndLocal.first != 143)
+      holey[globalAndLocal.first] = localIndex++;
+  // local indices not ascending in the global ones
+  IndexMapType swapped = box;
+  std::swap(swapped[132], swapped[133]);
+  const std::vector< std::pair< IndexMapType, bool > > cases = {
+      {box, true}, {IndexMapType({{42, 0}}), true}, {holey, false}, {swapped, false}};
+  for (const auto& indexMapAndStrided : cases) {
+    const IndexMapType& indexMap = indexMapAndStrided.first;
+    const LookupType lookup(indexMap);
+    EXPECT_EQ(indexMapAndStrided.second, lookup.strided());
+    EXPECT_EQ(indexMap.size(), size_t(lookup.size()));
+    for (unsigned int gg = 0; gg < 1000; ++gg) {
+      const auto it = indexMap.find(gg);
+      if (it == indexMap.end())
+        EXPECT_FALSE(lookup.contains(gg)) << "global index " << gg;
+      else
+        EXPECT_EQ(it->second, lookup.find(gg)) << "global index " << gg;
+    }
+  }
+}
@@ -0,0 +1,135 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iterator>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/provider/labeled.hh>
+#include <dune/grid/multiscale/provider/labelfile.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/multilevel.hh>
+#include <dune/grid/multiscale/partitioner/labelfile.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class LabelFile
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Labeled< GridType > LabeledType;
+  typedef typename LabeledType::MsGridType MsGridType;
+  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+  typedef typename LabeledType::DomainType DomainType;
+
+  LabelFile()
+    : grid_(create_grid(16))
+    , global_grid_part_(const_cast< GridType& >(*grid_))
+    , labels_(grid::Multiscale::Partitioner::multilevel_partition(
+          grid::Multiscale::Partitioner::dual_graph(global_grid_part_), 5))
+    , filename_(std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".labels")
+  {}
+
+  ~LabelFile()
+  {
+    std::remove(filename_.c_str());
+  }
+
+  static std::shared_ptr< const GridType > create_grid(const unsigned int num_elements)
+  {
+    return Stuff::Grid::Providers::Cube< GridType >(
+               DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(2, num_elements)).grid_ptr();
+  }
+
+  std::vector< char > read_bytes() const
+  {
+    std::ifstream in(filename_, std::ios::binary);
+    return std::vector< char >(std::istreambuf_iterator< char >(in), std::istreambuf_iterator< char >());
+  }
+
+  void write_bytes(const std::vector< char >& bytes) const
+  {
+    std::ofstream out(filename_, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), std::streamsize(bytes.size()));
+  }
+
+  std::shared_ptr< const GridType > grid_;
+  GlobalGridPartType global_grid_part_;
+  std::vector< size_t > labels_;
+  std::string filename_;
+}; // class LabelFile
+
+
+TEST_F(LabelFile, round_trip)
+{
+  using namespace grid::Multiscale::Partitioner;
+  for (const auto ordering : {LabelOrdering::index, LabelOrdering::center_hash}) {
+    write_labels(filename_, global_grid_part_, labels_, ordering);
+    EXPECT_EQ(labels_, read_labels(filename_, global_grid_part_));
+  }
+}
+
+TEST_F(LabelFile, provider_round_trip)
+{
+  const LabeledType labeled(grid_, labels_);
+  grid::Multiscale::Partitioner::write_labels(filename_, *labeled.ms_grid());
+  const grid::Multiscale::Providers::LabelFile< GridType > provider(grid_, filename_);
+  const auto& ms_grid = *provider.ms_grid();
+  ASSERT_EQ(labeled.ms_grid()->size(), ms_grid.size());
+  const auto globalGridPart = ms_grid.globalGridPart();
+  for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it)
+    EXPECT_EQ(labeled.ms_grid()->subdomainOf(*it), ms_grid.subdomainOf(*it));
+}
+
+TEST_F(LabelFile, rejects_a_corrupt_checksum)
+{
+  using namespace grid::Multiscale::Partitioner;
+  for (const auto ordering : {LabelOrdering::index, LabelOrdering::center_hash}) {
+    write_labels(filename_, global_grid_part_, labels_, ordering);
+    auto bytes = read_bytes();
+    bytes.back() ^= 1;
+    write_bytes(bytes);
+    EXPECT_THROW(read_labels(filename_, global_grid_part_), Dune::IOError);
+  }
+}
+
+TEST_F(LabelFile, rejects_a_wrong_size)
+{
+  using namespace grid::Multiscale::Partitioner;
+  write_labels(filename_, global_grid_part_, labels_);
+  const auto bytes = read_bytes();
+  // truncated
+  write_bytes(std::vector< char >(bytes.begin(), bytes.end() - 1));
+  EXPECT_THROW(read_labels(filename_, global_grid_part_), Dune::IOError);
+  // trailing garbage
+  auto longer = bytes;
+  longer.push_back(0);
+  write_bytes(longer);
+  EXPECT_THROW(read_labels(filename_, global_grid_part_), Dune::IOError);
+  // not even a header
+  write_bytes(std::vector< char >(bytes.begin(), bytes.begin() + sizeof(LabelFileHeader) - 1));
+  EXPECT_THROW(read_labels(filename_, global_grid_part_), Dune::IOError);
+  // another grid
+  write_bytes(bytes);
+  const auto otherGrid = create_grid(8);
+  const GlobalGridPartType otherGridPart(const_cast< GridType& >(*otherGrid));
+  EXPECT_THROW(read_labels(filename_, otherGridPart), Dune::IOError);
+  // and the labels have to match the grid part when writing
+  EXPECT_THROW(write_labels(filename_, otherGridPart, labels_), Dune::InvalidStateException);
+}
@@ -0,0 +1,166 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/provider/labelimage.hh>
+#include <dune/grid/multiscale/partitioner/labelimage.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+/**
+ *  A 4 x 4 image on the unit square and a grid of 2 x 2 elements, each of which covers 2 x 2 voxels. The center of
+ *  each element is the lower left corner of its upper right voxel, which is thus sampled at the center, while the
+ *  majority vote of 2 x 2 sub samples sees all four voxels of the element:
+ *
+ *    element   voxels       center   majority
+ *    (0, 0)    5, 5, 5, 1   1        5
+ *    (1, 0)    5, 5, 5, 2   2        5
+ *    (0, 1)    7, 8, 8, 7   7        7 (the smaller one on ties)
+ *    (1, 1)    0, 9, 9, 9   9        9
+ */
+class LabelImage
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::LabelImage< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+  typedef typename ProviderType::DomainType DomainType;
+  typedef grid::Multiscale::Partitioner::LabelImage ImageType;
+
+  LabelImage()
+    : grid_(Stuff::Grid::Providers::Cube< GridType >(
+          DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(2, 2)).grid_ptr())
+    , filename_(std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".raw")
+  {
+    // x running fastest
+    write_bytes({5, 5, 5, 5,
+                 5, 1, 5, 2,
+                 7, 8, 0, 9,
+                 8, 7, 9, 9});
+  }
+
+  ~LabelImage()
+  {
+    std::remove(filename_.c_str());
+  }
+
+  void write_bytes(const std::vector< char >& bytes) const
+  {
+    std::ofstream out(filename_, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), std::streamsize(bytes.size()));
+  }
+
+  static FieldVector< double, 2 > point(const double x, const double y)
+  {
+    FieldVector< double, 2 > result;
+    result[0] = x;
+    result[1] = y;
+    return result;
+  }
+
+  //! the native value of two bytes
+  static std::uint64_t value(const char first, const char second)
+  {
+    const char bytes[2] = {first, second};
+    std::uint16_t result = 0;
+    std::memcpy(&result, bytes, sizeof(result));
+    return result;
+  }
+
+  //! the labels of the element with the given center, see the class documentation
+  static std::uint64_t center_label(const DomainType& center)
+  {
+    const std::uint64_t labels[2][2] = {{1, 2}, {7, 9}};
+    return labels[center[1] < 0.5 ? 0 : 1][center[0] < 0.5 ? 0 : 1];
+  }
+
+  static std::uint64_t majority_label(const DomainType& center)
+  {
+    const std::uint64_t labels[2][2] = {{5, 5}, {7, 9}};
+    return labels[center[1] < 0.5 ? 0 : 1][center[0] < 0.5 ? 0 : 1];
+  }
+
+  std::shared_ptr< const GridType > grid_;
+  std::string filename_;
+}; // class LabelImage
+
+
+TEST_F(LabelImage, voxels)
+{
+  const ImageType img(filename_, {4, 4}, FieldVector< double, 3 >(0.0), FieldVector< double, 3 >(1.0));
+  EXPECT_EQ(std::uint64_t(5), img(point(0.1, 0.1)));
+  EXPECT_EQ(std::uint64_t(1), img(point(0.25, 0.25)));
+  EXPECT_EQ(std::uint64_t(0), img(point(0.6, 0.6)));
+  // points outside are clamped to the image
+  EXPECT_EQ(std::uint64_t(5), img(point(-1.0, -1.0)));
+  EXPECT_EQ(std::uint64_t(9), img(point(2.0, 2.0)));
+  EXPECT_EQ(std::uint64_t(8), img(point(-1.0, 2.0)));
+  // the size of the file has to match
+  EXPECT_THROW(ImageType(filename_, {4, 5}, FieldVector< double, 3 >(0.0), FieldVector< double, 3 >(1.0)),
+               Dune::IOError);
+  EXPECT_THROW(ImageType(filename_, {2, 2}, FieldVector< double, 3 >(0.0), FieldVector< double, 3 >(1.0), 3),
+               Dune::RangeError);
+  // two byte voxels after a header of four bytes
+  write_bytes({'h', 'e', 'a', 'd', 1, 0, 0, 1});
+  const ImageType wide(filename_, {2}, FieldVector< double, 3 >(0.0), FieldVector< double, 3 >(1.0), 2, 4);
+  EXPECT_EQ(value(1, 0), wide(FieldVector< double, 1 >(0.25)));
+  EXPECT_EQ(value(0, 1), wide(FieldVector< double, 1 >(0.75)));
+}
+
+TEST_F(LabelImage, sample_label_image)
+{
+  const ImageType img(filename_, {4, 4}, FieldVector< double, 3 >(0.0), FieldVector< double, 3 >(1.0));
+  const GlobalGridPartType globalGridPart(const_cast< GridType& >(*grid_));
+  for (const size_t num_threads : {1, 2}) {
+    const auto centers = grid::Multiscale::Partitioner::sample_label_image(img, globalGridPart, 1, num_threads);
+    const auto majorities = grid::Multiscale::Partitioner::sample_label_image(img, globalGridPart, 2, num_threads);
+    ASSERT_EQ(size_t(4), centers.size());
+    ASSERT_EQ(size_t(4), majorities.size());
+    size_t ee = 0;
+    for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it, ++ee) {
+      const auto center = it->geometry().center();
+      EXPECT_EQ(center_label(center), centers[ee]) << "element " << ee;
+      EXPECT_EQ(majority_label(center), majorities[ee]) << "element " << ee;
+    }
+  }
+  EXPECT_THROW(grid::Multiscale::Partitioner::sample_label_image(img, globalGridPart, 0), Dune::RangeError);
+}
+
+TEST_F(LabelImage, provider)
+{
+  // four different labels at the centers
+  const ProviderType centers(grid_, filename_, {4, 4}, {0.0, 0.0}, {1.0, 1.0});
+  EXPECT_EQ(size_t(4), centers.ms_grid()->size());
+  // the lower elements share their majority
+  const ProviderType majorities(grid_, filename_, {4, 4}, {0.0, 0.0}, {1.0, 1.0}, 1, 0, 2);
+  const auto& ms_grid = *majorities.ms_grid();
+  ASSERT_EQ(size_t(3), ms_grid.size());
+  const auto globalGridPart = ms_grid.globalGridPart();
+  std::vector< size_t > lower;
+  for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it)
+    if (it->geometry().center()[1] < 0.5)
+      lower.push_back(ms_grid.subdomainOf(*it));
+  ASSERT_EQ(size_t(2), lower.size());
+  EXPECT_EQ(lower[0], lower[1]);
+}
@@ -0,0 +1,396 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/stuff/grid/provider/cube.hh>
+
+#include <dune/grid/multiscale/provider/labeled.hh>
+#include <dune/grid/multiscale/provider/cube.hh>
+#include <dune/grid/multiscale/provider/multilevel.hh>
+#include <dune/grid/multiscale/provider/geometric.hh>
+#include <dune/grid/multiscale/partitioner/graph.hh>
+#include <dune/grid/multiscale/partitioner/multilevel.hh>
+#include <dune/grid/multiscale/partitioner/geometric.hh>
+#include <dune/grid/multiscale/partitioner/refinement.hh>
+#include <dune/grid/multiscale/partitioner/labelimage.hh>
+#include <dune/grid/multiscale/partitioner/balance.hh>
+#include <dune/grid/multiscale/balancer.hh>
+#include <dune/grid/multiscale/partitioner/quality.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class Partitioner
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Labeled< GridType > LabeledType;
+  typedef typename LabeledType::MsGridType MsGridType;
+  typedef typename MsGridType::GlobalGridPartType GlobalGridPartType;
+  typedef typename LabeledType::DomainType DomainType;
+
+  Partitioner()
+    : grid_(Stuff::Grid::Providers::Cube< GridType >(
+          DomainType(0.0), DomainType(1.0), std::vector< unsigned int >(2, 16)).grid_ptr())
+    , global_grid_part_(const_cast< GridType& >(*grid_))
+    , graph_(grid::Multiscale::Partitioner::dual_graph(global_grid_part_))
+  {}
+
+  /**
+   *  Two parts split at x = 0.5 on even rows of elements and at x = 0.5625 on odd ones: both are connected, but the
+   *  interface is jagged.
+   */
+  std::vector< size_t > jagged_labels() const
+  {
+    std::vector< size_t > labels;
+    for (const auto& center : grid::Multiscale::Partitioner::element_centers(global_grid_part_)) {
+      const bool odd_row = size_t(std::floor(center[1] * 16)) % 2 == 1;
+      labels.push_back(center[0] < (odd_row ? 0.5625 : 0.5) ? 0 : 1);
+    }
+    return labels;
+  } // ... jagged_labels(...)
+
+  //! elements left of x = threshold in part 0, the others in part 1
+  std::vector< size_t > split_labels(const double threshold) const
+  {
+    std::vector< size_t > labels;
+    for (const auto& center : grid::Multiscale::Partitioner::element_centers(global_grid_part_))
+      labels.push_back(center[0] < threshold ? 0 : 1);
+    return labels;
+  }
+
+  /**
+   *  A background part with islands of 1 element, 2 x 2 and 3 x 3 elements, and an island of 1 element next to an
+   *  island of 2 elements.
+   */
+  std::vector< size_t > island_labels() const
+  {
+    std::vector< size_t > labels;
+    for (const auto& center : grid::Multiscale::Partitioner::element_centers(global_grid_part_)) {
+      const size_t ii = size_t(std::floor(center[0] * 16));
+      const size_t jj = size_t(std::floor(center[1] * 16));
+      if (ii == 2 && jj == 2)
+        labels.push_back(1);
+      else if (ii >= 6 && ii < 8 && jj >= 6 && jj < 8)
+        labels.push_back(2);
+      else if (ii >= 10 && ii < 13 && jj >= 10 && jj < 13)
+        labels.push_back(3);
+      else if (ii == 2 && jj == 12)
+        labels.push_back(4);
+      else if (ii >= 3 && ii < 5 && jj == 12)
+        labels.push_back(5);
+      else
+        labels.push_back(0);
+    }
+    return labels;
+  } // ... island_labels(...)
+
+  //! one weight per element, three times as heavy on the right half of the domain
+  std::vector< double > skewed_weights() const
+  {
+    std::vector< double > weights;
+    for (const auto& center : grid::Multiscale::Partitioner::element_centers(global_grid_part_))
+      weights.push_back(center[0] < 0.5 ? 1.0 : 3.0);
+    return weights;
+  }
+
+  /**
+   *  Checks that labels has one label in [0, numParts) per element, that no part is empty and that the heaviest part
+   *  is at most (1 + imbalance) times the average part, up to slack times the weight of the heaviest element.
+   */
+  void check_parts(const std::vector< size_t >& labels, const size_t numParts, const std::vector< double >& weights,
+                   const double imbalance, const double slack = 1) const
+  {
+    ASSERT_EQ(graph_.size(), labels.size());
+    std::vector< double > partWeights(numParts, 0.0);
+    double total = 0;
+    double heaviest = 0;
+    for (size_t ee = 0; ee < labels.size(); ++ee) {
+      ASSERT_LT(labels[ee], numParts);
+      const double weight = weights.empty() ? 1.0 : weights[ee];
+      partWeights[labels[ee]] += weight;
+      total += weight;
+      heaviest = std::max(heaviest, weight);
+    }
+    for (size_t pp = 0; pp < numParts; ++pp)
+      EXPECT_GT(partWeights[pp], 0.0) << "part " << pp << " of " << numParts << " is empty";
+    EXPECT_LE(*std::max_element(partWeights.begin(), partWeights.end()),
+              (1.0 + imbalance) * total / double(numParts) + slack * heaviest + 1e-12)
+        << numParts << " parts";
+  } // ... check_parts(...)
+
+  std::shared_ptr< const GridType > grid_;
+  GlobalGridPartType global_grid_part_;
+  grid::Multiscale::Partitioner::Graph graph_;
+}; // class Partitioner
+
+
+TEST_F(Partitioner, refine_partition)
+{
+  using namespace grid::Multiscale::Partitioner;
+  std::vector< size_t > labels = jagged_labels();
+  const double cut = edge_cut(graph_, labels);
+  const auto statistics = refine_partition(graph_, labels, 2, 0.1);
+  EXPECT_EQ(cut, statistics.cutBefore);
+  EXPECT_EQ(edge_cut(graph_, labels), statistics.cutAfter);
+  EXPECT_LT(statistics.cutAfter, statistics.cutBefore);
+  EXPECT_GT(statistics.moves, size_t(0));
+  EXPECT_FALSE(statistics.restored);
+  EXPECT_LE(imbalance(graph_, labels, 2), 1.1 + 1e-12);
+  EXPECT_EQ(std::vector< size_t >(2, 1), components(graph_, labels, 2));
+}
+
+TEST_F(Partitioner, labeled_refine)
+{
+  const LabeledType unrefined(grid_, jagged_labels());
+  const LabeledType refined(grid_, jagged_labels(), 0, true, 0.1);
+  EXPECT_EQ(size_t(0), unrefined.refinement_statistics().moves);
+  const auto& statistics = refined.refinement_statistics();
+  EXPECT_LE(statistics.cutAfter, statistics.cutBefore);
+  EXPECT_EQ(size_t(2), refined.ms_grid()->size());
+  const auto unrefinedQuality = grid::Multiscale::Partitioner::quality(*unrefined.ms_grid());
+  const auto refinedQuality = grid::Multiscale::Partitioner::quality(*refined.ms_grid());
+  EXPECT_LE(refinedQuality.edgeCut, unrefinedQuality.edgeCut);
+}
+
+TEST_F(Partitioner, quality_of_a_split)
+{
+  using namespace grid::Multiscale::Partitioner;
+  // the left and the right half of the 16 x 16 elements share 16 faces, each half spans 0.5 x 1
+  const LabeledType provider(grid_, split_labels(0.5));
+  ASSERT_TRUE(provider.ms_grid()->hasFaceTable());
+  const auto centers = element_centers(global_grid_part_);
+  const std::vector< double > volumes(graph_.size(), 1.0 / 256.0);
+  // from the graph and from the face table
+  for (const auto& result : {quality(graph_, split_labels(0.5), 2, centers, volumes), quality(*provider.ms_grid())}) {
+    EXPECT_EQ(size_t(2), result.numParts);
+    EXPECT_EQ(size_t(256), result.numElements);
+    EXPECT_DOUBLE_EQ(16.0, result.edgeCut);
+    EXPECT_DOUBLE_EQ(16.0, result.maxInterface);
+    EXPECT_DOUBLE_EQ(16.0, result.averageInterface);
+    EXPECT_DOUBLE_EQ(1.0, result.imbalance);
+    EXPECT_EQ(size_t(1), result.maxNeighbors);
+    EXPECT_DOUBLE_EQ(1.0, result.averageNeighbors);
+    EXPECT_DOUBLE_EQ(2.0, result.maxAspectRatio);
+    EXPECT_DOUBLE_EQ(2.0, result.averageAspectRatio);
+    // one layer adds a column of 16 elements to each half
+    EXPECT_DOUBLE_EQ(0.125, result.oversamplingOverhead);
+  }
+}
+
+TEST_F(Partitioner, cube_refine)
+{
+  typedef grid::Multiscale::Providers::Cube< GridType > CubeType;
+  auto config = CubeType::default_config();
+  config["num_elements"] = "[16 16]";
+  config["num_partitions"] = "[2 2]";
+  config["refine"] = "true";
+  const auto provider = CubeType::create(config);
+  // the cube partition is optimal already
+  const auto& statistics = provider->refinement_statistics();
+  EXPECT_LE(statistics.cutAfter, statistics.cutBefore);
+  EXPECT_EQ(size_t(4), provider->ms_grid()->size());
+}
+
+TEST_F(Partitioner, multilevel_partition)
+{
+  using namespace grid::Multiscale::Partitioner;
+  const auto weights = skewed_weights();
+  const auto weightedGraph = dual_graph(global_grid_part_, weights);
+  for (const size_t numParts : {1, 2, 3, 5, 8, 16}) {
+    // each level of the recursive bisection may miss its target by up to one element
+    const double levels = std::max(1.0, std::ceil(std::log2(double(numParts))));
+    check_parts(multilevel_partition(graph_, numParts, 0.03), numParts, std::vector< double >(), 0.03, levels);
+    check_parts(multilevel_partition(weightedGraph, numParts, 0.03), numParts, weights, 0.03, levels);
+  }
+  // deterministic for a given seed
+  EXPECT_EQ(multilevel_partition(graph_, 5, 0.03, 7), multilevel_partition(graph_, 5, 0.03, 7));
+}
+
+TEST_F(Partitioner, ensure_side_sizes)
+{
+  using namespace grid::Multiscale::Partitioner;
+  // a side which is too small grows along the edges of the graph, from scratch or from its own vertices (the right
+  // column, which taking the first vertices would disconnect)
+  std::vector< size_t > right = split_labels(0.9375);
+  for (auto& label : right)
+    label = 1 - label;
+  for (const auto& side : {split_labels(0.0), right}) {
+    std::vector< size_t > grown = side;
+    const size_t minSizes[2] = {40, 100};
+    internal::ensure_side_sizes(graph_, grown, minSizes);
+    EXPECT_EQ(size_t(40), size_t(std::count(grown.begin(), grown.end(), size_t(0))));
+    EXPECT_EQ(std::vector< size_t >({1, 1}), components(graph_, grown, 2));
+  }
+  // unless the other side would get too small
+  std::vector< size_t > side = split_labels(0.0625);
+  const size_t minSizes[2] = {40, 240};
+  internal::ensure_side_sizes(graph_, side, minSizes);
+  EXPECT_EQ(size_t(16), size_t(std::count(side.begin(), side.end(), size_t(0))));
+}
+
+TEST_F(Partitioner, multilevel_provider)
+{
+  typedef grid::Multiscale::Providers::Multilevel< GridType > ProviderType;
+  for (const size_t numParts : {2, 7}) {
+    const ProviderType provider(grid_, numParts);
+    EXPECT_EQ(numParts, provider.ms_grid()->size());
+    const auto quality = grid::Multiscale::Partitioner::quality(*provider.ms_grid());
+    EXPECT_EQ(numParts, quality.numParts);
+    const double levels = std::ceil(std::log2(double(numParts)));
+    EXPECT_LE(quality.imbalance, 1.03 + levels * double(numParts) / double(graph_.size()) + 1e-12);
+  }
+}
+
+TEST_F(Partitioner, geometric_partition)
+{
+  using namespace grid::Multiscale::Partitioner;
+  const auto centers = element_centers(global_grid_part_);
+  const auto weights = skewed_weights();
+  for (const size_t numParts : {1, 2, 3, 5, 7, 8, 16}) {
+    // balanced up to the weight of one element
+    const auto bisection = recursive_coordinate_bisection(centers, numParts);
+    check_parts(bisection, numParts, std::vector< double >(), 0.0);
+    check_parts(recursive_coordinate_bisection(centers, numParts, weights), numParts, weights, 0.0);
+    const auto hilbert = hilbert_partition(centers, numParts);
+    check_parts(hilbert, numParts, std::vector< double >(), 0.0);
+    check_parts(hilbert_partition(centers, numParts, weights), numParts, weights, 0.0);
+    // independent of the number of threads
+    EXPECT_EQ(bisection, recursive_coordinate_bisection(centers, numParts, std::vector< double >(), 3));
+    EXPECT_EQ(hilbert, hilbert_partition(centers, numParts, std::vector< double >(), 3));
+  }
+}
+
+TEST_F(Partitioner, geometric_providers)
+{
+  typedef grid::Multiscale::Providers::CoordinateBisection< GridType > BisectionType;
+  typedef grid::Multiscale::Providers::Hilbert< GridType > HilbertType;
+  const BisectionType bisection(grid_, 5);
+  const HilbertType hilbert(grid_, 5);
+  for (const auto& ms_grid : {bisection.ms_grid(), hilbert.ms_grid()}) {
+    EXPECT_EQ(size_t(5), ms_grid->size());
+    const auto quality = grid::Multiscale::Partitioner::quality(*ms_grid);
+    EXPECT_LE(quality.imbalance, 1.0 + 5.0 / double(graph_.size()) + 1e-12);
+  }
+}
+
+TEST_F(Partitioner, merge_small_parts)
+{
+  using namespace grid::Multiscale::Partitioner;
+  const auto labels = island_labels();
+  EXPECT_EQ(std::vector< size_t >(6, 1), components(graph_, labels, 6));
+  // large enough parts are kept
+  EXPECT_EQ(labels, merge_small_parts(graph_, labels, 1));
+  // only the 3 x 3 island survives, the others (and the pair of islands together) are merged into the background
+  const auto merged = merge_small_parts(graph_, labels, 5);
+  std::vector< size_t > expected(labels.size());
+  for (size_t ee = 0; ee < labels.size(); ++ee) // numbered by their first element
+    expected[ee] = ((labels[ee] == 3) != (labels[0] == 3)) ? 1 : 0;
+  EXPECT_EQ(expected, merged);
+  EXPECT_EQ(std::vector< size_t >(2, 1), components(graph_, merged, 2));
+  // all parts are merged into one, which stays connected
+  const auto single = merge_small_parts(graph_, labels, graph_.size());
+  EXPECT_EQ(std::vector< size_t >(labels.size(), 0), single);
+}
+
+TEST_F(Partitioner, connected_regions)
+{
+  using namespace grid::Multiscale::Partitioner;
+  const auto labels = island_labels();
+  const auto regions = connected_regions(graph_, std::vector< std::uint64_t >(labels.begin(), labels.end()));
+  // each island is one region, so regions and labels induce the same partition
+  EXPECT_EQ(size_t(6), *std::max_element(regions.begin(), regions.end()) + 1);
+  for (size_t ee = 0; ee < labels.size(); ++ee)
+    for (size_t ff = 0; ff < labels.size(); ++ff)
+      ASSERT_EQ(labels[ee] == labels[ff], regions[ee] == regions[ff]) << "elements " << ee << " and " << ff;
+}
+
+TEST_F(Partitioner, rebalance_partition)
+{
+  using namespace grid::Multiscale::Partitioner;
+  // three quarters of the elements in part 0
+  const auto unbalanced = split_labels(0.75);
+  std::vector< size_t > labels = unbalanced;
+  const auto statistics = rebalance_partition(graph_, labels, 2, 0.05);
+  EXPECT_DOUBLE_EQ(1.5, statistics.imbalanceBefore);
+  EXPECT_LT(statistics.imbalanceAfter, statistics.imbalanceBefore);
+  EXPECT_LE(statistics.imbalanceAfter, 1.05 + 1e-12);
+  EXPECT_DOUBLE_EQ(imbalance(graph_, labels, 2), statistics.imbalanceAfter);
+  EXPECT_EQ(edge_cut(graph_, labels), statistics.cutAfter);
+  EXPECT_GT(statistics.moves, size_t(0));
+  EXPECT_EQ(std::vector< size_t >(2, 1), components(graph_, labels, 2));
+  // a limited number of moves still improves the balance
+  labels = unbalanced;
+  const auto limited = rebalance_partition(graph_, labels, 2, 0.05, 10);
+  EXPECT_EQ(size_t(10), limited.moves);
+  EXPECT_LT(limited.imbalanceAfter, limited.imbalanceBefore);
+  EXPECT_GT(limited.imbalanceAfter, statistics.imbalanceAfter);
+  // a balanced partition is left alone
+  labels = split_labels(0.5);
+  EXPECT_EQ(size_t(0), rebalance_partition(graph_, labels, 2, 0.05).moves);
+  EXPECT_EQ(split_labels(0.5), labels);
+}
+
+TEST_F(Partitioner, load_balancer)
+{
+  typedef grid::Multiscale::LoadBalancer< GridType > BalancerType;
+  const LabeledType labeled(grid_, split_labels(0.5));
+  BalancerType balancer(labeled.ms_grid(), 0.05, 1.0);
+  // the elements of the left half (subdomain 0) take three times as long as the others
+  const auto record = [&]() {
+    for (size_t ss = 0; ss < 2; ++ss) {
+      const auto localGridPart = balancer.ms_grid()->localGridPart(ss);
+      double cost = 0;
+      for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it)
+        cost += (it->geometry().center()[0] < 0.5) ? 3.0 : 1.0;
+      balancer.record(ss, cost);
+    }
+  };
+  record();
+  const auto report = balancer.rebalance();
+  EXPECT_DOUBLE_EQ(1.5, report.measuredImbalance);
+  EXPECT_LT(report.expectedImbalance, report.measuredImbalance);
+  EXPECT_GT(report.moves, size_t(0));
+  EXPECT_NE(labeled.ms_grid(), balancer.ms_grid());
+  EXPECT_EQ(size_t(2), balancer.ms_grid()->size());
+  EXPECT_LT(balancer.ms_grid()->localGridPart(0).indexSet().size(0),
+            balancer.ms_grid()->localGridPart(1).indexSet().size(0));
+  // the next measurement shows the improvement
+  record();
+  balancer.rebalance();
+  ASSERT_EQ(size_t(2), balancer.reports().size());
+  EXPECT_DOUBLE_EQ(balancer.reports()[1].measuredImbalance, balancer.reports()[0].achievedImbalance);
+  EXPECT_LT(balancer.reports()[0].achievedImbalance, balancer.reports()[0].measuredImbalance);
+  EXPECT_LE(balancer.reports()[0].achievedImbalance, report.expectedImbalance + 1e-12);
+  EXPECT_THROW(balancer.rebalance(), Dune::InvalidStateException);
+}
+
+TEST_F(Partitioner, load_balancer_keeps_the_boundary_id)
+{
+  typedef grid::Multiscale::LoadBalancer< GridType > BalancerType;
+  grid::Multiscale::Factory::Default< GridType > factory(grid_, 3);
+  factory.prepare();
+  factory.add(split_labels(0.75));
+  factory.finalize(0, grid::Multiscale::Factory::NeighborRecursionLevel< GridType >::compute(), true);
+  BalancerType balancer(factory.createMsGrid(), 0.05, 1.0);
+  EXPECT_EQ(3, balancer.ms_grid()->boundaryId());
+  balancer.record(0, 3.0);
+  balancer.record(1, 1.0);
+  EXPECT_GT(balancer.rebalance().moves, size_t(0));
+  EXPECT_EQ(3, balancer.ms_grid()->boundaryId());
+}
@@ -0,0 +1,88 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <set>
+#include <iomanip>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/common/timer.hh>
+
+#include <dune/stuff/common/configuration.hh>
+
+#include <dune/grid/multiscale/provider.hh>
+#include <dune/grid/multiscale/partitioner/quality.hh>
+
+
+using namespace Dune;
+
+
+/**
+ *  Creates each registered provider with its default configuration on a finer grid and prints the partition quality
+ *  of the result, one row per provider. The providers which need input files (label files and images) are skipped,
+ *  all others have to succeed and yield a sane decomposition.
+ */
+template< class GridType >
+void compare_providers(const std::string num_elements, const size_t num_layers)
+{
+  typedef grid::Multiscale::MsGridProviders< GridType > ProvidersType;
+  static const unsigned int dimDomain = GridType::dimension;
+  const std::set< std::string > file_based = {grid::Multiscale::Providers::LabelFile< GridType >::static_id(),
+                                              grid::Multiscale::Providers::LabelImage< GridType >::static_id()};
+  auto& out = DSC_LOG_INFO;
+  out << std::left << std::setw(40) << "provider" << std::right
+      << std::setw(8) << "parts" << std::setw(10) << "time [s]" << std::setw(10) << "cut"
+      << std::setw(10) << "max if" << std::setw(10) << "avg if" << std::setw(10) << "imbal"
+      << std::setw(8) << "max nb" << std::setw(8) << "avg nb" << std::setw(10) << "max ar"
+      << std::setw(10) << "avg ar" << std::setw(10) << "overs" << std::endl;
+  for (const auto& type : ProvidersType::available()) {
+    out << std::left << std::setw(40) << type << std::right << std::flush;
+    if (file_based.count(type) > 0) {
+      out << "  skipped (needs an input file)" << std::endl;
+      continue;
+    }
+    Stuff::Common::Configuration config = ProvidersType::default_config(type);
+    config["num_elements"] = num_elements;
+    // the number of subdomains the provider was asked for (0 if it decides itself)
+    size_t num_partitions = 0;
+    if (type == grid::Multiscale::Providers::Cube< GridType >::static_id()) {
+      num_partitions = 1;
+      for (const size_t partitions : config.get< std::vector< size_t > >("num_partitions", dimDomain))
+        num_partitions *= partitions;
+    } else if (config.hasKey("num_partitions"))
+      num_partitions = config.get< size_t >("num_partitions");
+    Timer timer;
+    const auto provider = ProvidersType::create(type, config);
+    const double elapsed = timer.elapsed();
+    const auto quality = grid::Multiscale::Partitioner::quality(*provider, num_layers);
+    out << std::setw(8) << quality.numParts << std::setw(10) << std::setprecision(3) << elapsed
+        << std::setw(10) << quality.edgeCut << std::setw(10) << quality.maxInterface
+        << std::setw(10) << quality.averageInterface << std::setw(10) << quality.imbalance
+        << std::setw(8) << quality.maxNeighbors << std::setw(8) << quality.averageNeighbors
+        << std::setw(10) << quality.maxAspectRatio << std::setw(10) << quality.averageAspectRatio
+        << std::setw(10) << quality.oversamplingOverhead << std::endl;
+    if (num_partitions > 0)
+      EXPECT_EQ(num_partitions, quality.numParts) << type;
+    EXPECT_GE(quality.numParts, size_t(1)) << type;
+    EXPECT_GE(quality.imbalance, 1.0) << type;
+    if (quality.numParts >= 2)
+      EXPECT_GT(quality.edgeCut, 0.0) << type;
+  }
+} // ... compare_providers(...)
+
+
+TEST(PartitionerComparison, sgrid_2d)
+{
+  compare_providers< SGrid< 2, 2 > >("[128 128]", 1);
+}
+
+TEST(PartitionerComparison, sgrid_3d)
+{
+  compare_providers< SGrid< 3, 3 > >("[24 24 24]", 1);
+}
@@ -0,0 +1,156 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <set>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+#include <dune/grid/multiscale/sparsity.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+typedef std::set< std::pair< size_t, size_t > > ReferencePatternType;
+
+
+ReferencePatternType to_set(const grid::Multiscale::SparsityPattern& pattern)
+{
+  ReferencePatternType result;
+  EXPECT_EQ(pattern.rows + 1, pattern.offsets.size());
+  for (size_t rr = 0; rr < pattern.rows; ++rr)
+    for (size_t ii = pattern.offsets[rr]; ii < pattern.offsets[rr + 1]; ++ii) {
+      if (ii > pattern.offsets[rr])
+        EXPECT_LT(pattern.columns[ii - 1], pattern.columns[ii]) << "row " << rr << " is not sorted";
+      result.insert(std::make_pair(rr, pattern.columns[ii]));
+    }
+  return result;
+} // ... to_set(...)
+
+
+class Sparsity
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  static const unsigned int dimDomain = GridType::dimension;
+
+  Sparsity()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  //! couples the codim entities of each of the given elements (all if elements is empty) of the local grid part
+  template< class LocalGridPartType >
+  static void add_element_couplings(const LocalGridPartType& localGridPart, const unsigned int codim,
+                                    const std::vector< size_t >& elements, ReferencePatternType& reference)
+  {
+    for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it) {
+      const auto& element = *it;
+      const size_t index = localGridPart.indexSet().index(element);
+      if (!elements.empty() && std::find(elements.begin(), elements.end(), index) == elements.end())
+        continue;
+      std::set< size_t > entities;
+      const auto& referenceElement = ReferenceElements< double, dimDomain >::general(element.type());
+      for (int ii = 0; ii < referenceElement.size(codim); ++ii)
+        entities.insert(localGridPart.indexSet().subIndex(element, ii, codim));
+      for (const size_t row : entities)
+        for (const size_t col : entities)
+          reference.insert(std::make_pair(row, col));
+    }
+  } // ... add_element_couplings(...)
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class Sparsity
+
+
+TEST_F(Sparsity, local_continuous)
+{
+  const grid::Multiscale::DofLayout layout(dimDomain, 1, false);
+  for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+    const auto localGridPart = ms_grid_->localGridPart(ss);
+    ReferencePatternType reference;
+    add_element_couplings(localGridPart, dimDomain, std::vector< size_t >(), reference);
+    const auto pattern = grid::Multiscale::local_sparsity_pattern(localGridPart, layout);
+    EXPECT_EQ(size_t(localGridPart.indexSet().size(dimDomain)), pattern.rows);
+    EXPECT_EQ(reference, to_set(pattern)) << "subdomain " << ss;
+  }
+}
+
+TEST_F(Sparsity, local_discontinuous)
+{
+  const grid::Multiscale::DofLayout layout(0, 1, true);
+  for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+    const auto localGridPart = ms_grid_->localGridPart(ss);
+    const auto& indexSet = localGridPart.indexSet();
+    ReferencePatternType reference;
+    for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it) {
+      const auto& element = *it;
+      const size_t index = indexSet.index(element);
+      reference.insert(std::make_pair(index, index));
+      for (auto iit = localGridPart.ibegin(element); iit != localGridPart.iend(element); ++iit) {
+        const auto& intersection = *iit;
+        if (intersection.neighbor()) {
+          const auto neighborPtr = intersection.outside();
+          if (indexSet.contains(*neighborPtr))
+            reference.insert(std::make_pair(index, size_t(indexSet.index(*neighborPtr))));
+        }
+      }
+    }
+    EXPECT_EQ(reference, to_set(grid::Multiscale::local_sparsity_pattern(localGridPart, layout))) << "subdomain " << ss;
+  }
+}
+
+TEST_F(Sparsity, boundary)
+{
+  ASSERT_TRUE(ms_grid_->hasFaceTable());
+  const auto globalGridPart = ms_grid_->globalGridPart();
+  size_t boundarySubdomains = 0;
+  for (const unsigned int codim : {0u, dimDomain}) {
+    const grid::Multiscale::DofLayout layout(codim, 2);
+    const auto patterns = ms_grid_->boundarySparsityPatterns(layout);
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss) {
+      const auto localGridPart = ms_grid_->localGridPart(ss);
+      // the local elements with a face on the domain boundary
+      std::vector< size_t > elements;
+      for (auto it = localGridPart.template begin< 0 >(); it != localGridPart.template end< 0 >(); ++it)
+        for (auto iit = globalGridPart.ibegin(*it); iit != globalGridPart.iend(*it); ++iit)
+          if (iit->boundary()) {
+            elements.push_back(localGridPart.indexSet().index(*it));
+            break;
+          }
+      EXPECT_EQ(!elements.empty(), ms_grid_->boundary(ss)) << "subdomain " << ss;
+      if (elements.empty())
+        continue;
+      ++boundarySubdomains;
+      ReferencePatternType blocks;
+      add_element_couplings(localGridPart, codim, elements, blocks);
+      ReferencePatternType reference;
+      for (const auto& entry : blocks)
+        for (size_t kk = 0; kk < 2; ++kk)
+          for (size_t ll = 0; ll < 2; ++ll)
+            reference.insert(std::make_pair(entry.first * 2 + kk, entry.second * 2 + ll));
+      const auto fromFaceTable =
+          grid::Multiscale::boundary_sparsity_pattern(localGridPart, ms_grid_->faceTable(), layout);
+      const auto fromBoundaryGridPart =
+          grid::Multiscale::boundary_sparsity_pattern(ms_grid_->boundaryGridPart(ss), layout);
+      EXPECT_EQ(reference, to_set(fromFaceTable)) << "subdomain " << ss << ", codim " << codim;
+      EXPECT_EQ(reference, to_set(fromBoundaryGridPart)) << "subdomain " << ss << ", codim " << codim;
+      ASSERT_EQ(size_t(1), patterns.count(ss));
+      EXPECT_EQ(reference, to_set(patterns.at(ss))) << "subdomain " << ss << ", codim " << codim;
+    }
+  }
+  EXPECT_GT(boundarySubdomains, size_t(0));
+}
@@ -0,0 +1,89 @@
+// This file is part of the dune-grid-multiscale project:
+//   http://users.dune-project.org/projects/dune-grid-multiscale
+// Copyright holders: Felix Albrecht
+// License: BSD 2-Clause License (http://opensource.org/licenses/BSD-2-Clause)
+
+#include <dune/stuff/test/main.hxx> // <- has to come first
+
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include <dune/stuff/common/disable_warnings.hh>
+# include <dune/grid/sgrid.hh>
+#include <dune/stuff/common/reenable_warnings.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/multiscale/provider/cube.hh>
+#include <dune/grid/multiscale/transfer.hh>
+
+
+using namespace Dune;
+typedef SGrid< 2, 2 > GridType;
+
+
+class Transfer
+  : public ::testing::Test
+{
+protected:
+  typedef grid::Multiscale::Providers::Cube< GridType > ProviderType;
+  typedef typename ProviderType::MsGridType MsGridType;
+  static const unsigned int dimDomain = GridType::dimension;
+
+  Transfer()
+    : ms_grid_(ProviderType::create()->ms_grid())
+  {}
+
+  std::shared_ptr< const MsGridType > ms_grid_;
+}; // class Transfer
+
+
+TEST_F(Transfer, gather_scatter_is_identity_on_elements)
+{
+  const auto globalGridPart = ms_grid_->globalGridPart();
+  const size_t numElements = globalGridPart.indexSet().size(0);
+  for (const size_t blockSize : {size_t(1), size_t(3)}) {
+    std::vector< double > global(numElements * blockSize);
+    for (size_t ii = 0; ii < global.size(); ++ii)
+      global[ii] = 1.0 + ii;
+    std::vector< std::vector< double > > locals(ms_grid_->size());
+    for (size_t ss = 0; ss < ms_grid_->size(); ++ss)
+      locals[ss].resize(ms_grid_->localGridPart(ss).indexSet().size(0) * blockSize);
+    grid::Multiscale::gather_all(*ms_grid_, 0, global, locals, blockSize);
+    std::vector< double > result(global.size(), 0.0);
+    grid::Multiscale::scatter_all(*ms_grid_, 0, locals, result, blockSize);
+    EXPECT_EQ(global, result) << "blockSize " << blockSize;
+    // twice, to use the inverse index map attached by the first call
+    std::fill(result.begin(), result.end(), 0.0);
+    grid::Multiscale::scatter_all(*ms_grid_, 0, locals, result, blockSize, false, 2);
+    EXPECT_EQ(global, result) << "blockSize " << blockSize;
+  }
+}
+
+TEST_F(Transfer, scatter_add_sums_the_overlaps)
+{
+  const auto globalGridPart = ms_grid_->globalGridPart();
+  const auto& globalIndexSet = globalGridPart.indexSet();
+  // the subdomains containing each vertex
+  std::vector< std::set< size_t > > subdomains(globalIndexSet.size(dimDomain));
+  for (auto it = globalGridPart.template begin< 0 >(); it != globalGridPart.template end< 0 >(); ++it) {
+    const auto& element = *it;
+    const size_t subdomain = ms_grid_->subdomainOf(element);
+    const auto& referenceElement = ReferenceElements< double, dimDomain >::general(element.type());
+    for (int ii = 0; ii < referenceElement.size(dimDomain); ++ii)
+      subdomains[globalIndexSet.subIndex(element, ii, dimDomain)].insert(subdomain);
+  }
+  std::vector< std::vector< double > > locals(ms_grid_->size());
+  for (size_t ss = 0; ss < ms_grid_->size(); ++ss)
+    locals[ss].assign(ms_grid_->localGridPart(ss).indexSet().size(dimDomain), 1.0);
+  std::vector< double > result(subdomains.size(), 0.0);
+  grid::Multiscale::scatter_add_all(*ms_grid_, dimDomain, locals, result);
+  size_t shared = 0;
+  for (size_t vv = 0; vv < subdomains.size(); ++vv) {
+    EXPECT_EQ(double(subdomains[vv].size()), result[vv]) << "vertex " << vv;
+    if (subdomains[vv].size() > 1)
+      ++shared;
+  }
+  EXPECT_GT(shared, size_t(0));
+}